@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <libRay/Material/Color.hpp>
+#include <libRay/Math/MathUtils.hpp>
+#include <libRay/Math/Vector.hpp>
+#include <libRay/AOVBuffer.hpp>
+#include <libRay/Camera.hpp>
+#include <libRay/JSONRecords.hpp>
+#include <libRay/PixelCost.hpp>
+#include <libRay/RayTracer.hpp>
+#include <libRay/Scene.hpp>
+#include <libRay/Scenes.hpp>
+#include <libRay/Utilites.hpp>
+
+// Everything that changes the work of a run is fixed, so results of different
+// builds compare.
+constexpr std::size_t const width = 640;
+constexpr std::size_t const height = 360;
+constexpr std::uint64_t const seed = 0;
+constexpr std::uint32_t const samplesPerPixel = 4;
+constexpr std::uint8_t const maxReflectionBounces = 4;
+
+// Times shorter than this are too noisy to flag.
+constexpr double const minimumComparedSeconds = 0.01;
+
+struct Options final
+{
+	// Empty runs every benchmark scene, unless there's a synthetic one.
+	std::vector<std::string> scenes;
+
+	// Also render a generated scene, see Scenes::ParseSyntheticConfiguration.
+	std::optional<LibRay::Scenes::SyntheticConfiguration> synthetic;
+
+	// Empty runs on 1 thread and on every hardware thread.
+	std::vector<std::uint32_t> threadCounts;
+
+	// The trace time is the median of this many renders.
+	std::uint32_t repeats = 3;
+
+	std::string outputFile = "benchmark.json";
+
+	// Compare against a file written by an earlier run, when not empty.
+	std::string baselineFile;
+
+	// How much slower than the baseline a result may be, 0.1 is 10%.
+	double tolerance = 0.1;
+};
+
+struct Result final
+{
+	std::string scene;
+	std::uint32_t threads = 0;
+
+	double loadSeconds = 0.;
+	double buildSeconds = 0.;
+
+	// The median and the fastest of the repeats.
+	double traceSeconds = 0.;
+	double fastestTraceSeconds = 0.;
+
+	// Primary, reflection, refraction, and shadow rays of one render.
+	std::uint64_t rays = 0;
+
+	double MegaraysPerSecond() const
+	{
+		return traceSeconds > 0. ? double(rays) / traceSeconds * 1e-6 : 0.;
+	}
+};
+
+static void PrintUsage(std::string const &executable)
+{
+	std::printf(
+		"Usage: %s [options]\n"
+		"Renders the benchmark scenes at %zux%zu, %u samples per pixel, and\n"
+		"seed %" PRIu64 ", and writes the timings as JSON.\n"
+		"  --scenes <list>        Comma separated scenes to run, default all:\n"
+		"                         spheres, mesh, glass, lights, textures\n"
+		"  --synthetic <config>   Also render a generated scene, configured like\n"
+		"                         spheres=100000,lights=64,glass=0.2, with\n"
+		"                         spheres, boxes, triangles, meshInstances,\n"
+		"                         meshTriangles, lights, clusters, glass, mirror,\n"
+		"                         extent, and distribution=uniform, clustered,\n"
+		"                         or sphereflake\n"
+		"  --threads <list>       Comma separated thread counts, default 1 and\n"
+		"                         every hardware thread\n"
+		"  --repeat <count>       Renders per scene and thread count, the median\n"
+		"                         is reported, default 3\n"
+		"  --output <file>        Where to write the results, default\n"
+		"                         benchmark.json\n"
+		"  --compare <file>       Flag results slower than in this earlier output,\n"
+		"                         and exit with an error when there are any\n"
+		"  --tolerance <fraction> How much slower a result may be, default 0.1\n"
+		"  --help                 Show this\n",
+		executable.c_str(),
+		width,
+		height,
+		samplesPerPixel,
+		seed);
+	std::fflush(stdout);
+}
+
+static std::optional<Options> ParseOptions(std::vector<std::string> const &arguments)
+{
+	Options options;
+
+	std::string const executable =
+		arguments.empty() ? std::string("Benchmark") : arguments[0];
+
+	for(std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		std::string const &argument = arguments[i];
+
+		auto const value = [&]() -> std::string const &
+		{
+			if(i + 1 >= arguments.size())
+			{
+				throw std::invalid_argument(
+					"Missing value for option <" + argument + ">");
+			}
+
+			return arguments[++i];
+		};
+
+		try
+		{
+			if(argument == "--scenes")
+				options.scenes = SplitList(value());
+			else if(argument == "--synthetic")
+				options.synthetic = LibRay::Scenes::ParseSyntheticConfiguration(value());
+			else if(argument == "--threads")
+			{
+				options.threadCounts.clear();
+				for(std::string const &count: SplitList(value()))
+				{
+					unsigned long const threads = std::stoul(count);
+					if(threads == 0)
+						throw std::invalid_argument("Thread counts start at 1");
+
+					options.threadCounts.push_back(std::uint32_t(threads));
+				}
+			}
+			else if(argument == "--repeat")
+			{
+				options.repeats = std::uint32_t(std::stoul(value()));
+				if(options.repeats == 0)
+					throw std::invalid_argument("Repeat at least once");
+			}
+			else if(argument == "--output")
+				options.outputFile = value();
+			else if(argument == "--compare")
+				options.baselineFile = value();
+			else if(argument == "--tolerance")
+				options.tolerance = std::stod(value());
+			else if(argument == "--help")
+			{
+				PrintUsage(executable);
+				return std::nullopt;
+			}
+			else
+				throw std::invalid_argument("Unknown option <" + argument + ">");
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			PrintUsage(executable);
+			return std::nullopt;
+		}
+	}
+
+	if(options.threadCounts.empty())
+	{
+		std::uint32_t const hardwareThreads =
+			std::max(std::thread::hardware_concurrency(), 1u);
+
+		options.threadCounts.push_back(1);
+		if(hardwareThreads > 1)
+			options.threadCounts.push_back(hardwareThreads);
+	}
+
+	return options;
+}
+
+static LibRay::RayTracerConfiguration MakeConfiguration(std::uint32_t threads)
+{
+	return LibRay::RayTracerConfiguration(
+		maxReflectionBounces,
+		threads,
+		samplesPerPixel,
+		LibRay::Sampling::SamplerType::Sobol);
+}
+
+// Counts the rays of a render through the Rays AOV. The counts are the same
+// for every thread count, and this render warms up the caches for the timed
+// ones.
+static std::uint64_t CountRays(LibRay::Scene const &scene, std::uint32_t threads)
+{
+	using namespace LibRay;
+
+	RayTracer const rayTracer(scene, MakeConfiguration(threads));
+
+	AOVBuffer aovs(scene.Camera().ScreenSize(), {AOV::Rays});
+	rayTracer.TraceWithAOVs(aovs);
+
+	std::size_t const pixelCount = aovs.Size().x * aovs.Size().y;
+
+	std::uint64_t rays = 0;
+	for(std::size_t type = 0; type < rayTypeCount; ++type)
+	{
+		Observer<float const> const plane = aovs.Plane(AOV::Rays, type);
+
+		for(std::size_t i = 0; i < pixelCount; ++i)
+			rays += std::uint64_t(plane[i]);
+	}
+
+	return rays;
+}
+
+static std::vector<Result> RunScene(
+	LibRay::Scenes::StandardScene const &standardScene,
+	Options const &options)
+{
+	using namespace LibRay;
+	using namespace LibRay::Math;
+
+	Scene const scene(
+		Camera(
+			standardScene.camera,
+			Vector2st(width, height),
+			Math::Radians(90.f),
+			1.f,
+			500.f),
+		seed,
+		Materials::Color::White(),
+		0.01f,
+		standardScene.load);
+
+	std::uint64_t const rays = CountRays(scene, options.threadCounts.front());
+
+	std::vector<Result> results;
+
+	for(std::uint32_t const threads: options.threadCounts)
+	{
+		RayTracer const rayTracer(scene, MakeConfiguration(threads));
+
+		std::vector<double> seconds;
+		for(std::uint32_t i = 0; i < options.repeats; ++i)
+		{
+			Stopwatch watch;
+			watch.Start();
+
+			rayTracer.Trace();
+
+			watch.Stop();
+			seconds.push_back(watch.Seconds());
+		}
+
+		std::sort(seconds.begin(), seconds.end());
+
+		Result result;
+		result.scene = standardScene.name;
+		result.threads = threads;
+		result.loadSeconds = scene.LoadSeconds();
+		result.buildSeconds = scene.BuildSeconds();
+		result.traceSeconds = seconds[seconds.size() / 2];
+		result.fastestTraceSeconds = seconds.front();
+		result.rays = rays;
+
+		std::printf(
+			"%-10s %3u threads: load %.3fs, build %.3fs, trace %.3fs, %.2f Mrays/s\n",
+			result.scene.c_str(),
+			result.threads,
+			result.loadSeconds,
+			result.buildSeconds,
+			result.traceSeconds,
+			result.MegaraysPerSecond());
+		std::fflush(stdout);
+
+		results.push_back(std::move(result));
+	}
+
+	return results;
+}
+
+static std::string ToJSON(std::vector<Result> const &results, Options const &options)
+{
+	std::ostringstream json;
+	json.precision(9);
+
+	json << "{\n"
+		<< "\t\"width\": " << width << ",\n"
+		<< "\t\"height\": " << height << ",\n"
+		<< "\t\"seed\": " << seed << ",\n"
+		<< "\t\"samplesPerPixel\": " << samplesPerPixel << ",\n"
+		<< "\t\"maxReflectionBounces\": " << unsigned(maxReflectionBounces) << ",\n"
+		<< "\t\"repeats\": " << options.repeats << ",\n"
+		<< "\t\"results\":\n\t[\n";
+
+	for(std::size_t i = 0; i < results.size(); ++i)
+	{
+		Result const &result = results[i];
+
+		json << "\t\t{"
+			<< "\"scene\": \"" << result.scene << "\", "
+			<< "\"threads\": " << result.threads << ", "
+			<< "\"loadSeconds\": " << result.loadSeconds << ", "
+			<< "\"buildSeconds\": " << result.buildSeconds << ", "
+			<< "\"traceSeconds\": " << result.traceSeconds << ", "
+			<< "\"fastestTraceSeconds\": " << result.fastestTraceSeconds << ", "
+			<< "\"rays\": " << result.rays << ", "
+			<< "\"megaraysPerSecond\": " << result.MegaraysPerSecond()
+			<< (i + 1 < results.size() ? "},\n" : "}\n");
+	}
+
+	json << "\t]\n}\n";
+
+	return json.str();
+}
+
+// Prints how every result compares to the baseline, returns how many are
+// slower than the tolerance allows.
+static std::size_t Compare(
+	std::vector<Result> const &results,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	std::vector<JSONRecord> const baseline =
+		ReadJSONRecords(options.baselineFile, "results");
+
+	std::size_t regressions = 0;
+
+	for(Result const &result: results)
+	{
+		auto const match = std::find_if(
+			baseline.begin(),
+			baseline.end(),
+			[&result](JSONRecord const &old)
+			{
+				auto const scene = old.find("scene");
+
+				return scene != old.end()
+					&& scene->second == result.scene
+					&& RecordNumber(old, "threads") == double(result.threads);
+			});
+
+		if(match == baseline.end())
+		{
+			std::printf(
+				"%-10s %3u threads: not in the baseline\n",
+				result.scene.c_str(),
+				result.threads);
+			continue;
+		}
+
+		// A different ray count means the scene or the renderer changed what
+		// it traces, so the times measure different work.
+		if(std::uint64_t(RecordNumber(*match, "rays")) != result.rays)
+		{
+			std::printf(
+				"%-10s %3u threads: traced %" PRIu64 " rays instead of %.0f, "
+				"the work changed\n",
+				result.scene.c_str(),
+				result.threads,
+				result.rays,
+				RecordNumber(*match, "rays"));
+		}
+
+		auto const check = [&](char const *name, double seconds, char const *key)
+		{
+			double const oldSeconds = RecordNumber(*match, key);
+			if(oldSeconds < minimumComparedSeconds || seconds < minimumComparedSeconds)
+				return;
+
+			double const change = seconds / oldSeconds - 1.;
+			bool const regressed = change > options.tolerance;
+
+			std::printf(
+				"%-10s %3u threads: %s %.3fs, was %.3fs, %+.1f%%%s\n",
+				result.scene.c_str(),
+				result.threads,
+				name,
+				seconds,
+				oldSeconds,
+				change * 100.,
+				regressed ? "  REGRESSION" : "");
+
+			if(regressed)
+				++regressions;
+		};
+
+		check("build", result.buildSeconds, "buildSeconds");
+		check("trace", result.traceSeconds, "traceSeconds");
+	}
+
+	std::fflush(stdout);
+
+	return regressions;
+}
+
+int main(int argc, char **argv)
+{
+	using namespace LibRay;
+
+	std::vector<std::string> arguments(argv, argv + argc);
+
+	std::optional<Options> const options = ParseOptions(arguments);
+	if(!options)
+		return EXIT_FAILURE;
+
+	std::vector<Scenes::StandardScene> scenes = Scenes::BenchmarkScenes();
+
+	if(options->synthetic && options->scenes.empty())
+		scenes.clear();
+	else if(!options->scenes.empty())
+	{
+		try
+		{
+			scenes = Scenes::PickScenes(scenes, options->scenes);
+		}
+		catch(std::invalid_argument const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(options->synthetic)
+		scenes.push_back(Scenes::Synthetic(*options->synthetic));
+
+	try
+	{
+		std::vector<Result> results;
+		for(Scenes::StandardScene const &scene: scenes)
+		{
+			std::vector<Result> sceneResults = RunScene(scene, *options);
+
+			results.insert(
+				results.end(),
+				std::make_move_iterator(sceneResults.begin()),
+				std::make_move_iterator(sceneResults.end()));
+		}
+
+		std::ofstream file(options->outputFile);
+		if(!(file << ToJSON(results, *options)))
+			throw std::runtime_error("Failed to write <" + options->outputFile + ">");
+
+		std::printf("Wrote <%s>\n", options->outputFile.c_str());
+		std::fflush(stdout);
+
+		if(!options->baselineFile.empty())
+		{
+			std::size_t const regressions = Compare(results, *options);
+			if(regressions > 0)
+			{
+				std::printf(
+					"%zu results are more than %.0f%% slower than the baseline\n",
+					regressions,
+					options->tolerance * 100.);
+				std::fflush(stdout);
+
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,803 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libRay/Containers/BoundingBox.hpp>
+#include <libRay/Material/Color.hpp>
+#include <libRay/Material/Material.hpp>
+#include <libRay/Material/MaterialStore.hpp>
+#include <libRay/Material/Texture.hpp>
+#include <libRay/Math/MathUtils.hpp>
+#include <libRay/Math/Ray.hpp>
+#include <libRay/Math/Vector.hpp>
+#include <libRay/Shaders/BlinnPhongBump.hpp>
+#include <libRay/Shapes/Model/Model.hpp>
+#include <libRay/Shapes/Model/ModelTriangle.hpp>
+#include <libRay/Shapes/Box.hpp>
+#include <libRay/Shapes/Plane.hpp>
+#include <libRay/Shapes/Sphere.hpp>
+#include <libRay/Intersection.hpp>
+#include <libRay/JSONRecords.hpp>
+#include <libRay/Light.hpp>
+#include <libRay/RayTracer.hpp>
+#include <libRay/Transform.hpp>
+
+using namespace LibRay;
+using namespace LibRay::Materials;
+using namespace LibRay::Math;
+using namespace LibRay::Shapes;
+
+// Every kernel cycles through this many inputs, few enough to stay in the
+// caches, so the kernels are timed and not the memory.
+constexpr std::size_t const inputCount = 4096;
+
+struct Options final
+{
+	// Only runs the kernels with this in their name, when not empty.
+	std::string filter;
+
+	std::uint64_t seed = 1;
+
+	// Timed samples per kernel, the confidence interval narrows with more.
+	std::uint32_t samples = 30;
+
+	// Every sample runs a kernel at least this long.
+	double sampleSeconds = 0.01;
+
+	std::string outputFile = "microbenchmark.json";
+
+	// Compare against a file written by an earlier run, when not empty.
+	std::string baselineFile;
+
+	// How much slower than the baseline a kernel may be, 0.05 is 5%.
+	double tolerance = 0.05;
+};
+
+// Runs a kernel over count inputs, starting after the ones of the previous
+// call, and returns something that depends on every result so the work
+// can't be optimized away.
+using KernelFunction = std::function<std::uint64_t(std::size_t count)>;
+
+struct Kernel final
+{
+	std::string name;
+	KernelFunction run;
+};
+
+struct Measurement final
+{
+	std::string name;
+	std::uint64_t operations = 0;
+
+	// Nanoseconds per operation, over the samples.
+	double mean = 0.;
+	double median = 0.;
+	double minimum = 0.;
+
+	// Half the width of the 95% confidence interval of the mean.
+	double confidence = 0.;
+
+	double OperationsPerSecond() const
+	{
+		return mean > 0. ? 1e9 / mean : 0.;
+	}
+};
+
+// Written to after every sample, keeps the results of the kernels alive.
+static volatile std::uint64_t sink = 0;
+
+static Vector3 RandomVector(std::uint64_t &state, float min, float max)
+{
+	return Vector3(
+		RandomRange(state, min, max),
+		RandomRange(state, min, max),
+		RandomRange(state, min, max));
+}
+
+static Vector3 RandomDirection(std::uint64_t &state)
+{
+	Vector3 direction(0);
+	while(glm::length2(direction) < 1e-4f)
+		direction = RandomVector(state, -1.f, 1.f);
+
+	return glm::normalize(direction);
+}
+
+// Rays from around origin towards target, missing it by up to spread.
+static std::vector<Ray> RaysTowards(
+	std::uint64_t &state,
+	Vector3 const &target,
+	float distance,
+	float spread)
+{
+	std::vector<Ray> rays;
+	rays.reserve(inputCount);
+
+	for(std::size_t i = 0; i < inputCount; ++i)
+	{
+		Vector3 const origin = target + RandomDirection(state) * distance;
+		Vector3 const aim = target + RandomVector(state, -spread, spread);
+
+		rays.emplace_back(origin, glm::normalize(aim - origin));
+	}
+
+	return rays;
+}
+
+static Texture RandomTexture(
+	std::uint64_t &state,
+	std::size_t size,
+	Texture::WrappingMethod wrap = Texture::WrappingMethod::Repeat)
+{
+	std::vector<Color> pixels;
+	pixels.reserve(size * size);
+
+	for(std::size_t i = 0; i < size * size; ++i)
+	{
+		pixels.emplace_back(
+			NextRandom(state),
+			NextRandom(state),
+			NextRandom(state));
+	}
+
+	return Texture(Vector2st(size, size), std::move(pixels), wrap, wrap);
+}
+
+static std::uint64_t Hit(std::optional<Intersection> const &intersection)
+{
+	return intersection ? 1 : 0;
+}
+
+// Adds the kernels of the shapes, intersected through BaseShape::Intersects
+// like the ray tracer does.
+template<typename T>
+static Kernel ShapeKernel(
+	std::string const &name,
+	std::shared_ptr<MaterialStore const> const &materials,
+	Transform const &transform,
+	std::uint64_t &state)
+{
+	auto const shape = std::make_shared<T>(transform, *materials, 0);
+	shape->Transform().RecalculateMatrix();
+
+	auto const rays = std::make_shared<std::vector<Ray>>(
+		RaysTowards(state, transform.Position(), 10.f, 2.f));
+
+	auto next = std::make_shared<std::size_t>(0);
+
+	return {name, [materials, shape, rays, next](std::size_t count)
+	{
+		std::uint64_t hits = 0;
+		std::size_t i = *next;
+
+		for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+			hits += Hit(shape->Intersects((*rays)[i]));
+
+		*next = i;
+		return hits;
+	}};
+}
+
+static std::vector<Kernel> MakeKernels(std::uint64_t seed)
+{
+	std::uint64_t state = seed;
+	std::vector<Kernel> kernels;
+
+	{
+		std::vector<Containers::BoundingBox> boxes;
+		boxes.reserve(inputCount);
+
+		for(std::size_t i = 0; i < inputCount; ++i)
+		{
+			boxes.emplace_back(
+				RandomVector(state, 0.1f, 2.f),
+				RandomVector(state, -2.f, 2.f));
+		}
+
+		auto const inputs = std::make_shared<std::pair<
+			std::vector<Containers::BoundingBox>,
+			std::vector<Ray>>>(
+				std::move(boxes),
+				RaysTowards(state, Vector3(0), 10.f, 3.f));
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({"BoundingBox::Intersects", [inputs, next](std::size_t count)
+		{
+			std::uint64_t hits = 0;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+				hits += inputs->first[i].Intersects(inputs->second[i]) >= 0.f ? 1u : 0u;
+
+			*next = i;
+			return hits;
+		}});
+	}
+
+	auto const materials = std::make_shared<MaterialStore>();
+	auto const shader = std::make_shared<BlinnPhongShaderBump>();
+
+	{
+		Material material(*shader);
+		material.UpdateFloatProperty("phong exponent", 100.f);
+		material.UpdateFloatProperty("bump strength", 0.5f);
+		material.UpdateTextureProperty("diffuse", RandomTexture(state, 256));
+		material.UpdateTextureProperty("bump map", RandomTexture(state, 256));
+		material.UpdateTextureProperty("specular", RandomTexture(state, 256));
+
+		materials->AddMaterial("Bumpy", std::move(material));
+	}
+
+	{
+		// Triangles of about the size of those in the nanosuit, in a model
+		// that owns them, tested on their own in model space.
+		std::vector<ModelTriangle::Vertex> vertices;
+		vertices.reserve(3 * inputCount);
+
+		for(std::size_t i = 0; i < inputCount; ++i)
+		{
+			Vector3 const center = RandomVector(state, -1.f, 1.f);
+			Vector3 const normal = RandomDirection(state);
+
+			for(std::size_t corner = 0; corner < 3; ++corner)
+			{
+				ModelTriangle::Vertex vertex;
+				vertex.position = center + RandomVector(state, -0.05f, 0.05f);
+				vertex.normal = normal;
+				vertex.uv = Vector2(NextRandom(state), NextRandom(state));
+
+				vertices.push_back(vertex);
+			}
+		}
+
+		auto const model = std::make_shared<Model>(
+			vertices,
+			Transform(Vector3(0)),
+			*materials,
+			0);
+		model->Transform().RecalculateMatrix();
+
+		auto const inputs = std::make_shared<std::pair<
+			std::vector<ModelTriangle>,
+			std::vector<Ray>>>();
+
+		for(std::size_t i = 0; i < inputCount; ++i)
+		{
+			std::array<ModelTriangle::Vertex, 3> const corners =
+				{vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]};
+
+			Vector3 const center =
+				(corners[0].position + corners[1].position + corners[2].position)
+				/ 3.f;
+
+			Vector3 const origin = center + RandomDirection(state) * 5.f;
+			Vector3 const aim = center + RandomVector(state, -0.03f, 0.03f);
+
+			inputs->first.emplace_back(model.get(), corners);
+			inputs->second.emplace_back(origin, glm::normalize(aim - origin));
+		}
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({
+			"ModelTriangle::IntersectsInternal",
+			[model, inputs, next](std::size_t count)
+		{
+			std::uint64_t hits = 0;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+				hits += Hit(inputs->first[i].IntersectsInternal(inputs->second[i]));
+
+			*next = i;
+			return hits;
+		}});
+	}
+
+	kernels.push_back(ShapeKernel<Sphere>(
+		"Sphere::Intersects",
+		materials,
+		Transform(Vector3(0), Vector3(0), Vector3(1.5f)),
+		state));
+
+	kernels.push_back(ShapeKernel<Box>(
+		"Box::Intersects",
+		materials,
+		Transform(Vector3(0), Vector3(0.3f, 0.5f, 0.f), Vector3(2.f)),
+		state));
+
+	kernels.push_back(ShapeKernel<Plane>(
+		"Plane::Intersects",
+		materials,
+		Transform(Vector3(0), Vector3(0.1f, 0.f, 0.2f)),
+		state));
+
+	std::array<std::pair<char const *, Texture::WrappingMethod>, 3> const wraps =
+	{{
+		{"Texture::Sample/repeat", Texture::WrappingMethod::Repeat},
+		{"Texture::Sample/mirror-repeat", Texture::WrappingMethod::MirrorRepeat},
+		{"Texture::Sample/clamp", Texture::WrappingMethod::Clamp}
+	}};
+
+	for(auto const &[name, wrap]: wraps)
+	{
+		auto const texture =
+			std::make_shared<Texture>(RandomTexture(state, 1024, wrap));
+
+		// Coordinates outside of [0, 1] too, to go through the wrapping.
+		auto const uvs = std::make_shared<std::vector<Vector2>>();
+		for(std::size_t i = 0; i < inputCount; ++i)
+			uvs->emplace_back(RandomRange(state, -2.f, 3.f), RandomRange(state, -2.f, 3.f));
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({name, [texture, uvs, next](std::size_t count)
+		{
+			float sum = 0.f;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+				sum += texture->Sample((*uvs)[i].x, (*uvs)[i].y).r;
+
+			*next = i;
+			return std::uint64_t(sum);
+		}});
+	}
+
+	{
+		std::vector<std::string> const names =
+		{
+			"phong exponent",
+			"bump strength",
+			"shininess",
+			"roughness",
+			"metalness",
+			"opacity",
+			"emission strength",
+			"clearcoat"
+		};
+
+		auto const material = std::make_shared<Material>(*shader);
+		for(std::size_t i = 0; i < names.size(); ++i)
+			material->UpdateFloatProperty(names[i], float(i));
+
+		auto const lookups = std::make_shared<std::vector<std::string>>();
+		for(std::size_t i = 0; i < inputCount; ++i)
+			lookups->push_back(names[std::size_t(NextRandom(state) * float(names.size()))]);
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({
+			"Material::FloatPropertyByName",
+			[shader, material, lookups, next](std::size_t count)
+		{
+			float sum = 0.f;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+				sum += material->FloatPropertyByName((*lookups)[i]);
+
+			*next = i;
+			return std::uint64_t(sum);
+		}});
+	}
+
+	{
+		// Real hits on a bump mapped sphere, lit by two lights.
+		auto const sphere = std::make_shared<Sphere>(
+			Transform(Vector3(0), Vector3(0), Vector3(1.f)),
+			*materials,
+			0);
+		sphere->Transform().RecalculateMatrix();
+
+		auto const lights = std::make_shared<std::vector<Light>>();
+		lights->emplace_back(Vector3(5.f, 5.f, 5.f), Color::White(), 100.f);
+		lights->emplace_back(Vector3(-5.f, 2.f, 3.f), Color(1.f, 0.8f, 0.6f), 50.f);
+
+		auto const inputs = std::make_shared<std::pair<
+			std::vector<Intersection>,
+			std::vector<Ray>>>();
+
+		while(inputs->first.size() < inputCount)
+		{
+			Vector3 const origin = RandomDirection(state) * 5.f;
+			Ray const ray(
+				origin,
+				glm::normalize(RandomVector(state, -0.7f, 0.7f) - origin));
+
+			std::optional<Intersection> const intersection = sphere->Intersects(ray);
+			if(intersection)
+			{
+				inputs->first.push_back(*intersection);
+				inputs->second.push_back(ray);
+			}
+		}
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({
+			"BlinnPhongShaderBump::Run",
+			[materials, shader, sphere, lights, inputs, next](std::size_t count)
+		{
+			std::vector<Observer<Light const>> const lit =
+				{&(*lights)[0], &(*lights)[1]};
+
+			float sum = 0.f;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+			{
+				Ray const &ray = inputs->second[i];
+
+				Color const color = shader->Run(
+					inputs->first[i],
+					-ray.Direction(),
+					ray,
+					lit,
+					Color::White(),
+					0.01f);
+
+				sum += color.r;
+			}
+
+			*next = i;
+			return std::uint64_t(sum);
+		}});
+	}
+
+	{
+		auto const inputs = std::make_shared<std::vector<Vector3>>();
+		for(std::size_t i = 0; i < inputCount; ++i)
+		{
+			bool const entering = NextRandom(state) < 0.5f;
+
+			inputs->emplace_back(
+				RandomRange(state, -1.f, 1.f),
+				entering ? 1.f : 1.5f,
+				entering ? 1.5f : 1.f);
+		}
+
+		auto next = std::make_shared<std::size_t>(0);
+
+		kernels.push_back({"RayTracer::FresnelFactor", [inputs, next](std::size_t count)
+		{
+			float sum = 0.f;
+			std::size_t i = *next;
+
+			for(std::size_t n = 0; n < count; ++n, i = (i + 1) % inputCount)
+			{
+				Vector3 const &input = (*inputs)[i];
+				sum += RayTracer::FresnelFactor(input.x, input.y, input.z);
+			}
+
+			*next = i;
+			return std::uint64_t(sum);
+		}});
+	}
+
+	return kernels;
+}
+
+// The 97.5th percentile of Student's t-distribution, for a two sided 95%
+// confidence interval from a few samples.
+static double StudentT(std::size_t degreesOfFreedom)
+{
+	constexpr std::array<double, 30> const table =
+	{
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+
+	if(degreesOfFreedom == 0)
+		return 0.;
+
+	if(degreesOfFreedom <= table.size())
+		return table[degreesOfFreedom - 1];
+
+	return 1.960;
+}
+
+static double RunFor(KernelFunction const &run, std::size_t operations)
+{
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point const start = clock::now();
+	sink = sink + run(operations);
+	clock::time_point const end = clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+static Measurement Measure(Kernel const &kernel, Options const &options)
+{
+	// Doubles the operations per sample until a sample takes long enough,
+	// which also warms up the caches and the branch predictors.
+	std::size_t operations = 64;
+	while(RunFor(kernel.run, operations) < options.sampleSeconds)
+		operations *= 2;
+
+	std::vector<double> nanoseconds;
+	nanoseconds.reserve(options.samples);
+
+	for(std::uint32_t i = 0; i < options.samples; ++i)
+	{
+		double const seconds = RunFor(kernel.run, operations);
+		nanoseconds.push_back(seconds * 1e9 / double(operations));
+	}
+
+	Measurement measurement;
+	measurement.name = kernel.name;
+	measurement.operations = std::uint64_t(operations) * options.samples;
+
+	double sum = 0.;
+	for(double const value: nanoseconds)
+		sum += value;
+
+	measurement.mean = sum / double(nanoseconds.size());
+
+	double squares = 0.;
+	for(double const value: nanoseconds)
+		squares += (value - measurement.mean) * (value - measurement.mean);
+
+	std::size_t const degreesOfFreedom = nanoseconds.size() - 1;
+	double const deviation = degreesOfFreedom > 0
+		? std::sqrt(squares / double(degreesOfFreedom))
+		: 0.;
+
+	measurement.confidence = StudentT(degreesOfFreedom)
+		* deviation
+		/ std::sqrt(double(nanoseconds.size()));
+
+	std::sort(nanoseconds.begin(), nanoseconds.end());
+	measurement.median = nanoseconds[nanoseconds.size() / 2];
+	measurement.minimum = nanoseconds.front();
+
+	return measurement;
+}
+
+static std::string ToJSON(
+	std::vector<Measurement> const &measurements,
+	Options const &options)
+{
+	std::ostringstream json;
+	json.precision(9);
+
+	json << "{\n"
+		<< "\t\"seed\": " << options.seed << ",\n"
+		<< "\t\"samples\": " << options.samples << ",\n"
+		<< "\t\"kernels\":\n\t[\n";
+
+	for(std::size_t i = 0; i < measurements.size(); ++i)
+	{
+		Measurement const &measurement = measurements[i];
+
+		json << "\t\t{"
+			<< "\"name\": \"" << measurement.name << "\", "
+			<< "\"operations\": " << measurement.operations << ", "
+			<< "\"nanosecondsPerOperation\": " << measurement.mean << ", "
+			<< "\"confidence95\": " << measurement.confidence << ", "
+			<< "\"median\": " << measurement.median << ", "
+			<< "\"minimum\": " << measurement.minimum << ", "
+			<< "\"operationsPerSecond\": " << measurement.OperationsPerSecond()
+			<< (i + 1 < measurements.size() ? "},\n" : "}\n");
+	}
+
+	json << "\t]\n}\n";
+
+	return json.str();
+}
+
+// Prints how every kernel compares to the baseline, returns how many are
+// slower than the tolerance allows. A kernel is only flagged when the
+// confidence intervals don't overlap either, so noise doesn't fail a change.
+static std::size_t Compare(
+	std::vector<Measurement> const &measurements,
+	Options const &options)
+{
+	std::vector<JSONRecord> const baseline =
+		ReadJSONRecords(options.baselineFile, "kernels");
+
+	std::size_t regressions = 0;
+
+	for(Measurement const &measurement: measurements)
+	{
+		auto const match = std::find_if(
+			baseline.begin(),
+			baseline.end(),
+			[&measurement](JSONRecord const &old)
+			{
+				auto const name = old.find("name");
+				return name != old.end() && name->second == measurement.name;
+			});
+
+		if(match == baseline.end())
+		{
+			std::printf("%-34s not in the baseline\n", measurement.name.c_str());
+			continue;
+		}
+
+		double const oldMean = RecordNumber(*match, "nanosecondsPerOperation");
+		double const oldConfidence = RecordNumber(*match, "confidence95");
+		if(oldMean <= 0.)
+			continue;
+
+		double const change = measurement.mean / oldMean - 1.;
+		bool const regressed = change > options.tolerance
+			&& measurement.mean - measurement.confidence > oldMean + oldConfidence;
+
+		std::printf(
+			"%-34s %9.2f ns, was %9.2f ns, %+.1f%%%s\n",
+			measurement.name.c_str(),
+			measurement.mean,
+			oldMean,
+			change * 100.,
+			regressed ? "  REGRESSION" : "");
+
+		if(regressed)
+			++regressions;
+	}
+
+	std::fflush(stdout);
+
+	return regressions;
+}
+
+static void PrintUsage(std::string const &executable)
+{
+	std::printf(
+		"Usage: %s [options]\n"
+		"Times the hot kernels of libRay over seeded random inputs, and writes\n"
+		"the nanoseconds per operation, with their 95%% confidence interval, as\n"
+		"JSON.\n"
+		"  --filter <text>        Only run the kernels with text in their name\n"
+		"  --seed <number>        Seeds the inputs, default 1\n"
+		"  --samples <count>      Timed samples per kernel, default 30\n"
+		"  --sample-time <ms>     Minimum milliseconds per sample, default 10\n"
+		"  --output <file>        Where to write the results, default\n"
+		"                         microbenchmark.json\n"
+		"  --compare <file>       Flag kernels slower than in this earlier output,\n"
+		"                         and exit with an error when there are any\n"
+		"  --tolerance <fraction> How much slower a kernel may be, default 0.05\n"
+		"  --help                 Show this\n",
+		executable.c_str());
+	std::fflush(stdout);
+}
+
+static std::optional<Options> ParseOptions(std::vector<std::string> const &arguments)
+{
+	Options options;
+
+	std::string const executable =
+		arguments.empty() ? std::string("Microbenchmark") : arguments[0];
+
+	for(std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		std::string const &argument = arguments[i];
+
+		auto const value = [&]() -> std::string const &
+		{
+			if(i + 1 >= arguments.size())
+			{
+				throw std::invalid_argument(
+					"Missing value for option <" + argument + ">");
+			}
+
+			return arguments[++i];
+		};
+
+		try
+		{
+			if(argument == "--filter")
+				options.filter = value();
+			else if(argument == "--seed")
+				options.seed = std::stoull(value());
+			else if(argument == "--samples")
+			{
+				options.samples = std::uint32_t(std::stoul(value()));
+				if(options.samples < 2)
+					throw std::invalid_argument("Take at least 2 samples");
+			}
+			else if(argument == "--sample-time")
+				options.sampleSeconds = std::stod(value()) / 1000.;
+			else if(argument == "--output")
+				options.outputFile = value();
+			else if(argument == "--compare")
+				options.baselineFile = value();
+			else if(argument == "--tolerance")
+				options.tolerance = std::stod(value());
+			else if(argument == "--help")
+			{
+				PrintUsage(executable);
+				return std::nullopt;
+			}
+			else
+				throw std::invalid_argument("Unknown option <" + argument + ">");
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			PrintUsage(executable);
+			return std::nullopt;
+		}
+	}
+
+	return options;
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<std::string> const arguments(argv, argv + argc);
+
+	std::optional<Options> const options = ParseOptions(arguments);
+	if(!options)
+		return EXIT_FAILURE;
+
+	try
+	{
+		std::vector<Measurement> measurements;
+
+		for(Kernel const &kernel: MakeKernels(options->seed))
+		{
+			if(kernel.name.find(options->filter) == std::string::npos)
+				continue;
+
+			Measurement const measurement = Measure(kernel, *options);
+
+			std::printf(
+				"%-34s %9.2f ns/op +- %6.2f (%4.1f%%), %8.2f Mops/s\n",
+				measurement.name.c_str(),
+				measurement.mean,
+				measurement.confidence,
+				100. * measurement.confidence / measurement.mean,
+				measurement.OperationsPerSecond() * 1e-6);
+			std::fflush(stdout);
+
+			measurements.push_back(measurement);
+		}
+
+		std::ofstream file(options->outputFile);
+		if(!(file << ToJSON(measurements, *options)))
+			throw std::runtime_error("Failed to write <" + options->outputFile + ">");
+
+		std::printf("Wrote <%s>\n", options->outputFile.c_str());
+		std::fflush(stdout);
+
+		if(!options->baselineFile.empty())
+		{
+			std::size_t const regressions = Compare(measurements, *options);
+			if(regressions > 0)
+			{
+				std::printf(
+					"%zu kernels are more than %.0f%% slower than the baseline\n",
+					regressions,
+					options->tolerance * 100.);
+				std::fflush(stdout);
+
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
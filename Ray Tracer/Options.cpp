@@ -0,0 +1,358 @@
+#include "Options.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+static LibRay::Threading::TileOrder ParseTileOrder(std::string const &name)
+{
+	using LibRay::Threading::TileOrder;
+
+	if(name == "scanline")
+		return TileOrder::Scanline;
+	else if(name == "hilbert")
+		return TileOrder::Hilbert;
+	else if(name == "spiral")
+		return TileOrder::Spiral;
+
+	throw std::invalid_argument("Unknown tile order <" + name + ">");
+}
+
+static LibRay::Threading::ThreadPlacement ParseThreadPlacement(
+	std::string const &name)
+{
+	using LibRay::Threading::ThreadPlacement;
+
+	if(name == "default")
+		return ThreadPlacement::Default;
+	else if(name == "topology")
+		return ThreadPlacement::Topology;
+
+	throw std::invalid_argument("Unknown thread placement <" + name + ">");
+}
+
+// A comma separated list of AOV names, or all.
+static std::vector<LibRay::AOV> ParseAOVs(std::string const &list)
+{
+	using LibRay::AOV;
+	using LibRay::AOVBuffer;
+
+	std::vector<AOV> aovs;
+
+	if(list == "all")
+	{
+		for(std::size_t i = 0; i < LibRay::aovCount; ++i)
+			aovs.push_back(AOV(i));
+
+		return aovs;
+	}
+
+	std::size_t start = 0;
+	while(start <= list.size())
+	{
+		std::size_t end = list.find(',', start);
+		if(end == std::string::npos)
+			end = list.size();
+
+		std::string const name = list.substr(start, end - start);
+
+		std::size_t i = 0;
+		while(i < LibRay::aovCount && name != AOVBuffer::Name(AOV(i)))
+			++i;
+
+		if(i == LibRay::aovCount)
+			throw std::invalid_argument("Unknown AOV <" + name + ">");
+
+		aovs.push_back(AOV(i));
+		start = end + 1;
+	}
+
+	return aovs;
+}
+
+static std::uint16_t ParsePort(std::string const &value)
+{
+	unsigned long const port = std::stoul(value);
+	if(port == 0 || port > 65535)
+		throw std::invalid_argument("Invalid port <" + value + ">");
+
+	return std::uint16_t(port);
+}
+
+std::optional<Options> ParseOptions(std::vector<std::string> const &arguments)
+{
+	Options options;
+
+	std::string const executable =
+		arguments.empty() ? std::string("RayTracer") : arguments[0];
+
+	for(std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		std::string const &argument = arguments[i];
+
+		auto const value = [&]() -> std::string const &
+		{
+			if(i + 1 >= arguments.size())
+			{
+				throw std::invalid_argument(
+					"Missing value for option <" + argument + ">");
+			}
+
+			return arguments[++i];
+		};
+
+		try
+		{
+			if(argument == "--progressive")
+				options.progressive = true;
+			else if(argument == "--snapshot-interval")
+				options.snapshotInterval = std::stof(value());
+			else if(argument == "--tile-size")
+				options.tileSize = std::uint32_t(std::stoul(value()));
+			else if(argument == "--tile-order")
+				options.tileOrder = ParseTileOrder(value());
+			else if(argument == "--threads")
+				options.threadCount = std::uint32_t(std::stoul(value()));
+			else if(argument == "--thread-placement")
+				options.threadPlacement = ParseThreadPlacement(value());
+			else if(argument == "--coordinator")
+				options.coordinatorPort = ParsePort(value());
+			else if(argument == "--worker")
+			{
+				std::string const &address = value();
+				std::size_t const colon = address.rfind(':');
+				if(colon == std::string::npos || colon == 0)
+				{
+					throw std::invalid_argument(
+						"Expected <host:port>, got <" + address + ">");
+				}
+
+				options.workerHost = address.substr(0, colon);
+				options.workerPort = ParsePort(address.substr(colon + 1));
+			}
+			else if(argument == "--worker-timeout")
+				options.workerTimeout = std::uint32_t(std::stoul(value()));
+			else if(argument == "--fingerprint")
+				options.fingerprint = std::uint64_t(std::stoull(value(), nullptr, 16));
+			else if(argument == "--checkpoint")
+				options.checkpointFile = value();
+			else if(argument == "--checkpoint-interval")
+				options.checkpointInterval = std::uint32_t(std::stoul(value()));
+			else if(argument == "--resume")
+				options.resume = true;
+			else if(argument == "--min-contribution")
+				options.minimumContribution = std::stof(value());
+			else if(argument == "--no-shadow-cache")
+				options.cacheShadowOccluders = false;
+			else if(argument == "--time-budget")
+				options.timeBudget = std::stof(value());
+			else if(argument == "--denoise")
+				options.denoise = true;
+			else if(argument == "--exr")
+				options.writeEXR = true;
+			else if(argument == "--aovs")
+			{
+				options.aovs = ParseAOVs(value());
+				options.writeEXR = true;
+			}
+			else if(argument == "--heatmap")
+			{
+				options.heatmap = true;
+				options.writeEXR = true;
+			}
+			else if(argument == "--statistics")
+				options.statisticsFile = value();
+			else if(argument == "--memory-report")
+				options.memoryReport = true;
+			else if(argument == "--hardware-counters")
+				options.hardwareCounters = true;
+			else if(argument == "--timeline")
+				options.timelineFile = value();
+			else if(argument == "--sequence")
+				options.sequenceFile = value();
+			else if(argument == "--help")
+			{
+				PrintUsage(executable);
+				return std::nullopt;
+			}
+			else
+				throw std::invalid_argument("Unknown option <" + argument + ">");
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "Error: %s\n", e.what());
+			PrintUsage(executable);
+			return std::nullopt;
+		}
+	}
+
+	if(!options.checkpointFile.empty()
+		&& (options.progressive || options.coordinatorPort > 0))
+	{
+		std::fprintf(
+			stderr,
+			"Error: --checkpoint can't be combined with --progressive or "
+			"--coordinator\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if(options.timeBudget > 0.f
+		&& (options.progressive
+			|| options.coordinatorPort > 0
+			|| !options.checkpointFile.empty()))
+	{
+		std::fprintf(
+			stderr,
+			"Error: --time-budget can't be combined with --progressive, "
+			"--coordinator, or --checkpoint\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if(options.denoise
+		&& (options.progressive
+			|| options.coordinatorPort > 0
+			|| !options.workerHost.empty()
+			|| !options.checkpointFile.empty()
+			|| options.timeBudget > 0.f))
+	{
+		std::fprintf(
+			stderr,
+			"Error: --denoise can't be combined with --progressive, "
+			"--coordinator, --worker, --checkpoint, or --time-budget\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if((!options.aovs.empty() || options.heatmap)
+		&& (options.progressive
+			|| options.coordinatorPort > 0
+			|| !options.workerHost.empty()
+			|| !options.checkpointFile.empty()
+			|| options.timeBudget > 0.f))
+	{
+		std::fprintf(
+			stderr,
+			"Error: --aovs and --heatmap can't be combined with "
+			"--progressive, --coordinator, --worker, --checkpoint, or "
+			"--time-budget\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if(!options.sequenceFile.empty()
+		&& (options.progressive
+			|| options.coordinatorPort > 0
+			|| !options.workerHost.empty()
+			|| !options.checkpointFile.empty()))
+	{
+		std::fprintf(
+			stderr,
+			"Error: --sequence can't be combined with --progressive, "
+			"--coordinator, --worker, or --checkpoint\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if(options.fingerprint && options.coordinatorPort == 0)
+	{
+		std::fprintf(stderr, "Error: --fingerprint needs --coordinator\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	if(options.resume && options.checkpointFile.empty())
+	{
+		std::fprintf(stderr, "Error: --resume needs --checkpoint\n");
+		PrintUsage(executable);
+		return std::nullopt;
+	}
+
+	return options;
+}
+
+void PrintUsage(std::string const &executable)
+{
+	std::printf(
+		"Usage: %s [options]\n"
+		"\n"
+		"Options:\n"
+		"  --progressive              Render in passes of increasing sample\n"
+		"                             counts, writing preview images.\n"
+		"  --snapshot-interval <sec>  Minimum time between preview images.\n"
+		"                             (default: 10)\n"
+		"  --tile-size <pixels>       Size of the render tiles. (default: 32)\n"
+		"  --tile-order <order>       Order to render the tiles in, one of\n"
+		"                             scanline, hilbert, or spiral.\n"
+		"                             (default: hilbert)\n"
+		"  --threads <count>          Number of render threads.\n"
+		"                             (default: every hardware thread)\n"
+		"  --thread-placement <mode>  default, or topology to pin the threads\n"
+		"                             to physical cores before SMT siblings\n"
+		"                             and keep work on their NUMA node.\n"
+		"                             (default: default)\n"
+		"  --coordinator <port>       Hand out tiles to worker processes\n"
+		"                             connecting to this port, instead of\n"
+		"                             rendering.\n"
+		"  --worker <host:port>       Render tiles for the coordinator at\n"
+		"                             this address.\n"
+		"  --worker-timeout <sec>     Seconds before the tiles of a silent\n"
+		"                             worker are handed to other workers.\n"
+		"                             (default: 120)\n"
+		"  --fingerprint <hex>        Only accept workers printing this render\n"
+		"                             fingerprint when they connect.\n"
+		"                             (default: the one of the first worker)\n"
+		"  --checkpoint <file>        Save the finished tiles to this file\n"
+		"                             while rendering, and when interrupted.\n"
+		"  --checkpoint-interval <sec>\n"
+		"                             Minimum time between checkpoints.\n"
+		"                             (default: 60)\n"
+		"  --resume                   Only render the tiles missing from the\n"
+		"                             checkpoint file.\n"
+		"  --min-contribution <weight>\n"
+		"                             Reflections and refractions adding\n"
+		"                             less than this to a pixel are traced\n"
+		"                             by chance, 0 traces all of them.\n"
+		"                             (default: 0.01)\n"
+		"  --no-shadow-cache          Trace every shadow ray through the whole\n"
+		"                             scene, instead of testing the last\n"
+		"                             blocking object first.\n"
+		"  --time-budget <sec>        Lower the sample count, and if needed\n"
+		"                             the bounce depth, to finish rendering\n"
+		"                             within this time.\n"
+		"  --denoise                  Filter the noise out of the render,\n"
+		"                             keeping the edges of shapes, normals,\n"
+		"                             and textures.\n"
+		"  --exr                      Also write the render as a float EXR,\n"
+		"                             without tone mapping.\n"
+		"  --aovs <list>              Add these layers to the EXR, a comma\n"
+		"                             separated list of depth, normal,\n"
+		"                             albedo, shape-id, and bounce-count, or\n"
+		"                             all. Implies --exr.\n"
+		"  --heatmap                  Count the BVH nodes, primitive tests,\n"
+		"                             rays, and time every pixel costs, and\n"
+		"                             write a false color image per count.\n"
+		"                             Implies --exr, which gets the counts.\n"
+		"  --statistics <file>        Write the counts of rays, box and shape\n"
+		"                             tests, shader runs, and texture\n"
+		"                             samples, and the Mrays/s, as JSON. Needs\n"
+		"                             libRay built with LIBRAY_STATISTICS.\n"
+		"  --memory-report            Print the memory taken by every texture,\n"
+		"                             material, model, and BVH of the scene.\n"
+		"  --hardware-counters        Count cache misses, branch\n"
+		"                             mispredictions, and instructions per\n"
+		"                             cycle per tile and pass, with\n"
+		"                             perf_event_open on Linux. Reported with\n"
+		"                             the statistics.\n"
+		"  --timeline <file>          Record what every thread spends its\n"
+		"                             time on, loading textures and models,\n"
+		"                             building BVHs, and rendering tiles, as\n"
+		"                             a trace for chrome://tracing.\n"
+		"  --sequence <file>          Render every frame of an animation\n"
+		"                             file, writing a numbered image per\n"
+		"                             frame. With --time-budget, the budget\n"
+		"                             is per frame.\n"
+		"  --help                     Show this message.\n",
+		executable.c_str());
+	std::fflush(stdout);
+}
@@ -0,0 +1,97 @@
+#ifndef b1e9cc0c_d262_4da7_8973_18c4e5aa23a2
+#define b1e9cc0c_d262_4da7_8973_18c4e5aa23a2
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <libRay/Threading/Tile.hpp>
+#include <libRay/Threading/Topology.hpp>
+#include <libRay/AOVBuffer.hpp>
+
+struct Options final
+{
+	// Render in passes, writing a preview image while rendering.
+	bool progressive = false;
+
+	// Minimum amount of seconds between progressive preview images.
+	float snapshotInterval = 10.f;
+
+	std::uint32_t tileSize = 32;
+	LibRay::Threading::TileOrder tileOrder = LibRay::Threading::TileOrder::Hilbert;
+
+	// 0 uses every hardware thread.
+	std::uint32_t threadCount = 0;
+	LibRay::Threading::ThreadPlacement threadPlacement =
+		LibRay::Threading::ThreadPlacement::Default;
+
+	// Hand out tiles to workers connecting to this port, 0 renders locally.
+	std::uint16_t coordinatorPort = 0;
+	std::uint32_t workerTimeout = 120;
+	// Only accept workers with this render fingerprint, otherwise the one of
+	// the first worker.
+	std::optional<std::uint64_t> fingerprint;
+
+	// Render tiles for the coordinator at this address, when not empty.
+	std::string workerHost;
+	std::uint16_t workerPort = 0;
+
+	// Save the finished tiles to this file while rendering, when not empty.
+	std::string checkpointFile;
+	std::uint32_t checkpointInterval = 60;
+	bool resume = false;
+
+	// Rays contributing less to their pixel are ended with Russian roulette.
+	float minimumContribution = 0.01f;
+
+	bool cacheShadowOccluders = true;
+
+	// Lower the quality to finish within this many seconds, when above 0.
+	float timeBudget = 0.f;
+
+	// Filter the noise out of the render, guided by its depth, normals, and
+	// albedo.
+	bool denoise = false;
+
+	// Also write the render without tone mapping to a float EXR, with these
+	// AOVs as extra layers.
+	bool writeEXR = false;
+	std::vector<LibRay::AOV> aovs;
+
+	// Count what every pixel costs to render, and write false color images of
+	// the counts next to the render, and the counts themselves to the EXR.
+	bool heatmap = false;
+
+	// Write the ray and traversal counts as JSON to this file, when not empty.
+	std::string statisticsFile;
+
+	// Print what the textures, models, and hierarchies of the scene take.
+	bool memoryReport = false;
+
+	// Count cache misses, branch mispredictions, and instructions per cycle
+	// with the hardware counters of the processor, while tracing.
+	bool hardwareCounters = false;
+
+	// Record a timeline of loading and rendering per thread to this file, as
+	// Chrome Trace Event JSON, when not empty.
+	std::string timelineFile;
+
+	// Render every frame of this animation file, when not empty.
+	std::string sequenceFile;
+};
+
+static_assert(std::is_copy_constructible_v<Options>);
+static_assert(std::is_copy_assignable_v<Options>);
+static_assert(!std::is_trivially_copyable_v<Options>);
+
+static_assert(std::is_move_constructible_v<Options>);
+static_assert(std::is_move_assignable_v<Options>);
+
+// Returns std::nullopt and prints the usage on invalid arguments.
+std::optional<Options> ParseOptions(std::vector<std::string> const &arguments);
+
+void PrintUsage(std::string const &executable);
+
+#endif // b1e9cc0c_d262_4da7_8973_18c4e5aa23a2
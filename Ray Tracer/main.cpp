@@ -1,13 +1,20 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cinttypes>
+#include <csignal>
 #include <cstdint>
 #include <cstdio>
 #include <ctime>
+#include <future>
 #include <iomanip>
 #include <memory>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #ifdef ENABLE_GLFW
 #ifdef _WIN32
@@ -21,24 +28,98 @@
 
 #include <stb/stb_image_write.h>
 
+#include <libRay/Distributed/Coordinator.hpp>
+#include <libRay/Distributed/RenderWorker.hpp>
 #include <libRay/Math/MathUtils.hpp>
 #include <libRay/Math/Ray.hpp>
 #include <libRay/Math/Vector.hpp>
 #include <libRay/RayTracer.hpp>
 #include <libRay/Scene.hpp>
+#include <libRay/Statistics.hpp>
 #include <libRay/Shapes/Shape.hpp>
+#include <libRay/Animation.hpp>
 #include <libRay/Camera.hpp>
+#include <libRay/AOVBuffer.hpp>
+#include <libRay/Checkpoint.hpp>
+#include <libRay/Denoiser.hpp>
+#include <libRay/EXRWriter.hpp>
+#include <libRay/Heatmap.hpp>
 #include <libRay/Image.hpp>
 #include <libRay/Intersection.hpp>
+#include <libRay/Timeline.hpp>
 #include <libRay/Transform.hpp>
 #include <libRay/Utilites.hpp>
 
+#include "Options.hpp"
+
 // Disable TGA compression, for easy viewing in a hex editor
 extern "C" void DisableTGARLE();
 
 LibRay::Image NormalizeImage(LibRay::Image const &image);
 
-std::pair<bool, std::string> WriteImage(LibRay::Image const &normalizedImage);
+std::uint32_t ThreadCount(Options const &options);
+void PrintTopology(std::uint32_t threadCount);
+
+int RenderDistributed(
+	LibRay::Math::Vector2st const &imageSize,
+	LibRay::RayTracerConfiguration const &config,
+	Options const &options);
+
+LibRay::Image TraceProgressive(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options);
+
+std::optional<LibRay::Image> TraceWithCheckpoints(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options);
+
+LibRay::Image TraceWithTimeBudget(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options);
+
+// Holds the AOVs asked for, and the ones the denoiser and heatmaps need.
+LibRay::AOVBuffer MakeAOVBuffer(
+	LibRay::Scene const &scene,
+	Options const &options);
+
+// Fills aovs while tracing, and denoises the render when asked to.
+LibRay::Image TraceWithAOVs(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options,
+	LibRay::AOVBuffer &aovs);
+
+int RenderSequence(
+	LibRay::RayTracer const &rayTracer,
+	LibRay::Scene &scene,
+	Options const &options);
+
+std::string OutputFileName(std::string const &suffix = std::string());
+
+std::pair<bool, std::string> WriteImage(
+	LibRay::Image const &normalizedImage,
+	std::string const &output = OutputFileName());
+
+// The EXR next to the png written by WriteImage.
+std::string EXRFileName(std::string const &pngFileName);
+
+bool WriteFloatImage(
+	LibRay::Image const &image,
+	Observer<LibRay::AOVBuffer const> aovs,
+	std::string const &output);
+
+// Prints what rendering counted, and writes it to --statistics.
+bool ReportStatistics(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options);
+
+// Stops recording the timeline, and writes it to --timeline.
+bool WriteTimeline(Options const &options);
+
+// Writes a false color png per component of the costs in aovs, named after
+// the png of the render.
+bool WriteHeatmaps(
+	LibRay::AOVBuffer const &aovs,
+	std::string const &pngFileName);
 
 #ifdef ENABLE_GLFW
 void KeyCallback(
@@ -61,16 +142,62 @@ void ShowDebugWindow(
 #endif // ENABLE_GLFW
 
 #if defined(_WIN32) && defined(UNICODE)
-extern "C" int wmain();
+extern "C" int wmain(int argc, wchar_t **argv);
 
-extern "C" int wmain()
+extern "C" int wmain(int argc, wchar_t **argv)
 #else
-int main()
+int main(int argc, char **argv)
 #endif
 {
 	using namespace LibRay;
 	using namespace LibRay::Math;
 
+	std::vector<std::string> arguments;
+	arguments.reserve(std::size_t(argc));
+
+	for(int i = 0; i < argc; ++i)
+	{
+#if defined(_WIN32) && defined(UNICODE)
+		std::wstring const argument(argv[i]);
+		std::string narrowArgument;
+		narrowArgument.reserve(argument.size());
+
+		for(wchar_t const c: argument)
+			narrowArgument.push_back(char(c));
+
+		arguments.push_back(std::move(narrowArgument));
+#else
+		arguments.emplace_back(argv[i]);
+#endif
+	}
+
+	std::optional<Options> const options = ParseOptions(arguments);
+	if(!options)
+		return EXIT_FAILURE;
+
+	if(!options->timelineFile.empty())
+	{
+		Timeline::NameThread("Main");
+		Timeline::Start();
+	}
+
+	RayTracerConfiguration config(
+		4,
+		ThreadCount(*options),
+#ifdef DEBUG
+		1);
+#else
+		16,
+		Sampling::SamplerType::Sobol);
+#endif
+
+	config.tileSize = options->tileSize;
+	config.tileOrder = options->tileOrder;
+	config.threadPlacement = options->threadPlacement;
+	config.minimumContribution = options->minimumContribution;
+	config.cacheShadowOccluders = options->cacheShadowOccluders;
+	config.hardwareCounters = options->hardwareCounters;
+
 	Camera camera(
 		Transform(Vector3(0, 5, 7), Vector3(-Math::PI * 0.15f, 0, 0)),
 		Vector2st(1280, 720),
@@ -78,6 +205,10 @@ int main()
 		1.f,
 		500.f);
 
+	// The coordinator only hands out tiles, so it doesn't load the scene.
+	if(options->coordinatorPort > 0)
+		return RenderDistributed(camera.ScreenSize(), config, *options);
+
 	std::unique_ptr<Scene> scene;
 	try
 	{
@@ -93,23 +224,79 @@ int main()
 		return EXIT_FAILURE;
 	}
 
-	RayTracerConfiguration config(
-		4,
-#ifdef DEBUG
-		1,
-		RayTracerConfiguration::AntiAliasingMode::AA1);
-#else
-		std::uint8_t(std::thread::hardware_concurrency()),
-		RayTracerConfiguration::AntiAliasingMode::AA16);
-#endif
+	if(options->memoryReport)
+	{
+		std::printf("%s", scene->Memory().Report().c_str());
+		std::fflush(stdout);
+	}
+
+	if(config.threadPlacement == Threading::ThreadPlacement::Topology)
+		PrintTopology(config.threadCount);
+
+	if(!options->workerHost.empty())
+	{
+		try
+		{
+			Distributed::RenderWorker const worker(*scene, std::move(config));
+
+			bool const shutDown = worker.Serve(
+				options->workerHost,
+				options->workerPort,
+				std::chrono::seconds(60));
+
+			return shutDown ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "Caught exception: %s\n", e.what());
+			return EXIT_FAILURE;
+		}
+	}
 
 	RayTracer rayTracer(*scene, std::move(config));
 
+	if(!options->sequenceFile.empty())
+	{
+		int const result = RenderSequence(rayTracer, *scene, *options);
+		if(!WriteTimeline(*options))
+			return EXIT_FAILURE;
+
+		return result;
+	}
+
 	Image output(0, 0);
+	std::optional<AOVBuffer> aovs;
 
 	try
 	{
-		output = rayTracer.Trace();
+		if(options->progressive)
+			output = TraceProgressive(rayTracer, *options);
+		else if(!options->checkpointFile.empty())
+		{
+			std::optional<Image> finished =
+				TraceWithCheckpoints(rayTracer, *options);
+
+			if(!finished)
+			{
+				std::printf(
+					"Interrupted, continue with --checkpoint %s --resume\n",
+					options->checkpointFile.c_str());
+				std::fflush(stdout);
+
+				return EXIT_FAILURE;
+			}
+
+			output = std::move(*finished);
+		}
+		else if(options->timeBudget > 0.f)
+			output = TraceWithTimeBudget(rayTracer, *options);
+		else if(options->denoise || !options->aovs.empty() || options->heatmap)
+		{
+			aovs.emplace(MakeAOVBuffer(*scene, *options));
+			output = TraceWithAOVs(rayTracer, *options, *aovs);
+		}
+		else
+			output = rayTracer.Trace();
 	}
 	catch(std::exception const &e)
 	{
@@ -117,12 +304,41 @@ int main()
 		return EXIT_FAILURE;
 	}
 
+	RayTracer::CacheStatistics const shadowCache =
+		rayTracer.ShadowCacheStatistics();
+
+	if(shadowCache.lookups > 0)
+	{
+		std::printf(
+			"Shadow occluder cache hits: %" PRIu64 " of %" PRIu64
+			" lookups (%.1f%%)\n",
+			shadowCache.hits,
+			shadowCache.lookups,
+			100. * double(shadowCache.hits) / double(shadowCache.lookups));
+		std::fflush(stdout);
+	}
+
+	if(!ReportStatistics(rayTracer, *options))
+		return EXIT_FAILURE;
+
+	if(!WriteTimeline(*options))
+		return EXIT_FAILURE;
+
 	Image const normalizedOutput = NormalizeImage(output);
 
 	auto const result = WriteImage(normalizedOutput);
 	if(!result.first)
 		return EXIT_FAILURE;
 
+	if(options->writeEXR
+		&& !WriteFloatImage(output, aovs ? &*aovs : nullptr, EXRFileName(result.second)))
+	{
+		return EXIT_FAILURE;
+	}
+
+	if(options->heatmap && !WriteHeatmaps(*aovs, result.second))
+		return EXIT_FAILURE;
+
 #ifdef ENABLE_GLFW
 	try
 	{
@@ -140,6 +356,350 @@ int main()
 	return EXIT_SUCCESS;
 }
 
+std::uint32_t ThreadCount(Options const &options)
+{
+	if(options.threadCount > 0)
+		return options.threadCount;
+
+#ifdef DEBUG
+	return 1;
+#else
+	return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+}
+
+void PrintTopology(std::uint32_t threadCount)
+{
+	using namespace LibRay::Threading;
+
+	Topology const topology = Topology::Detect();
+	if(!topology.IsKnown())
+	{
+		std::fprintf(
+			stderr,
+			"Processor topology unknown, threads will not be pinned\n");
+		return;
+	}
+
+	std::vector<LogicalProcessor> const &processors = topology.Processors();
+	std::size_t const coreCount = std::size_t(std::count_if(
+		processors.cbegin(),
+		processors.cend(),
+		[](LogicalProcessor const &processor)
+		{
+			return processor.sibling == 0;
+		}));
+
+	std::printf(
+		"Pinning %u threads to %zu hardware threads on %zu cores and %u NUMA nodes\n",
+		threadCount,
+		processors.size(),
+		coreCount,
+		topology.NodeCount());
+	std::fflush(stdout);
+}
+
+int RenderDistributed(
+	LibRay::Math::Vector2st const &imageSize,
+	LibRay::RayTracerConfiguration const &config,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	Distributed::CoordinatorConfiguration coordinatorConfig(
+		options.coordinatorPort,
+		config.samplesPerPixel);
+
+	coordinatorConfig.tileSize = config.tileSize;
+	coordinatorConfig.tileOrder = config.tileOrder;
+	coordinatorConfig.workerTimeout = std::chrono::seconds(options.workerTimeout);
+	coordinatorConfig.fingerprint = options.fingerprint;
+
+	try
+	{
+		Distributed::Coordinator coordinator(imageSize, coordinatorConfig);
+
+		Stopwatch watch;
+		watch.Start();
+
+		Image const output = coordinator.Render();
+
+		watch.Stop();
+
+		std::printf("Took %s to render the scene\n", watch.Value().c_str());
+		std::fflush(stdout);
+
+		auto const result = WriteImage(NormalizeImage(output));
+		if(!result.first)
+			return EXIT_FAILURE;
+
+		if(options.writeEXR
+			&& !WriteFloatImage(output, nullptr, EXRFileName(result.second)))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+LibRay::Image TraceProgressive(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options)
+{
+	using namespace LibRay;
+	using clock = std::chrono::steady_clock;
+
+	std::string const previewName = OutputFileName("-preview");
+	clock::time_point lastSnapshot = clock::now();
+
+	auto const onProgress =
+		[&](Image const &snapshot, RayTracer::Progress const &progress) -> bool
+	{
+		std::printf(
+			"Pass %u done, %u of %u samples per pixel\n",
+			progress.pass,
+			progress.sampleCount,
+			progress.targetSampleCount);
+		std::fflush(stdout);
+
+		if(progress.sampleCount == progress.targetSampleCount)
+			return true;
+
+		std::chrono::duration<float> const sinceSnapshot =
+			clock::now() - lastSnapshot;
+
+		// Always write the first pass, as the earliest possible preview.
+		if(progress.pass == 0 || sinceSnapshot.count() >= options.snapshotInterval)
+		{
+			WriteImage(NormalizeImage(snapshot), previewName);
+			lastSnapshot = clock::now();
+		}
+
+		return true;
+	};
+
+	return rayTracer.TraceProgressive(onProgress);
+}
+
+static std::atomic_bool stopRequested(false);
+
+extern "C" void RequestStop(int) noexcept;
+
+extern "C" void RequestStop(int) noexcept
+{
+	stopRequested = true;
+}
+
+std::optional<LibRay::Image> TraceWithCheckpoints(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	// Preempted nodes get a signal before they are killed, save what's done.
+	std::signal(SIGINT, RequestStop);
+	std::signal(SIGTERM, RequestStop);
+
+	CheckpointConfiguration checkpoint(options.checkpointFile);
+	checkpoint.interval = std::chrono::seconds(options.checkpointInterval);
+	checkpoint.resume = options.resume;
+	checkpoint.stopRequested = &stopRequested;
+
+	Stopwatch watch;
+	watch.Start();
+
+	std::optional<Image> output = rayTracer.TraceWithCheckpoints(checkpoint);
+
+	watch.Stop();
+
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+
+	if(output)
+	{
+		std::printf("Took %s to render the scene\n", watch.Value().c_str());
+		std::fflush(stdout);
+	}
+
+	return output;
+}
+
+LibRay::Image TraceWithTimeBudget(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	RayTracer::TimeBudgetResult result = rayTracer.TraceWithTimeBudget(
+		std::chrono::duration<float>(options.timeBudget));
+
+	RayTracerConfiguration const &config = rayTracer.Configuration();
+
+	std::printf(
+		"Took %.2fs of a %.2fs budget, using %u of %u samples per pixel and %u "
+		"of %u bounces\n",
+		double(result.seconds),
+		double(options.timeBudget),
+		result.samplesPerPixel,
+		config.samplesPerPixel,
+		unsigned(result.maxReflectionBounces),
+		unsigned(config.maxReflectionBounces));
+	std::fflush(stdout);
+
+	return std::move(result.image);
+}
+
+LibRay::AOVBuffer MakeAOVBuffer(
+	LibRay::Scene const &scene,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	std::vector<AOV> aovs = options.aovs;
+	if(options.denoise)
+	{
+		std::vector<AOV> const features = Denoiser::Features();
+		aovs.insert(aovs.end(), features.begin(), features.end());
+	}
+
+	if(options.heatmap)
+	{
+		for(std::size_t i = 0; i < aovCount; ++i)
+		{
+			if(AOVBuffer::IsCost(AOV(i)))
+				aovs.push_back(AOV(i));
+		}
+	}
+
+	return AOVBuffer(scene.Camera().ScreenSize(), aovs);
+}
+
+LibRay::Image TraceWithAOVs(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options,
+	LibRay::AOVBuffer &aovs)
+{
+	using namespace LibRay;
+
+	Image noisy = rayTracer.TraceWithAOVs(aovs);
+	if(!options.denoise)
+		return noisy;
+
+	Stopwatch watch;
+	watch.Start();
+
+	Denoiser const denoiser(
+		DenoiserConfiguration(),
+		rayTracer.SharedTaskProcessor());
+
+	Image denoised = denoiser.Denoise(noisy, aovs);
+
+	watch.Stop();
+
+	std::printf("Took %s to denoise the render\n", watch.Value().c_str());
+	std::fflush(stdout);
+
+	return denoised;
+}
+
+int RenderSequence(
+	LibRay::RayTracer const &rayTracer,
+	LibRay::Scene &scene,
+	Options const &options)
+{
+	using namespace LibRay;
+	using clock = std::chrono::steady_clock;
+
+	try
+	{
+		Animation const animation = Animation::Load(options.sequenceFile);
+
+		// Rendered-*date*-*frame*.png, with the same date for every frame.
+		std::string const sequenceName = OutputFileName();
+		std::string const prefix =
+			sequenceName.substr(0, sequenceName.size() - std::string(".png").size());
+
+		clock::time_point const start = clock::now();
+
+		// Tone map and write every frame while the next one is traced, so only
+		// one finished frame waits at a time.
+		std::future<bool> written;
+
+		for(std::size_t frame = 0; frame < animation.frameCount; ++frame)
+		{
+			animation.Apply(scene, frame);
+
+			Image image(0, 0);
+			std::optional<AOVBuffer> aovs;
+
+			if(options.timeBudget > 0.f)
+				image = TraceWithTimeBudget(rayTracer, options);
+			else if(options.denoise || !options.aovs.empty() || options.heatmap)
+			{
+				aovs.emplace(MakeAOVBuffer(scene, options));
+				image = TraceWithAOVs(rayTracer, options, *aovs);
+			}
+			else
+				image = rayTracer.Trace();
+
+			if(written.valid() && !written.get())
+				return EXIT_FAILURE;
+
+			char number[32];
+			std::snprintf(number, sizeof(number), "-%04zu.png", frame);
+
+			written = std::async(
+				std::launch::async,
+				[
+					image = std::move(image),
+					aovs = std::move(aovs),
+					output = prefix + number,
+					writeEXR = options.writeEXR,
+					heatmap = options.heatmap]()
+				{
+					if(!WriteImage(NormalizeImage(image), output).first)
+						return false;
+
+					if(writeEXR
+						&& !WriteFloatImage(image, aovs ? &*aovs : nullptr, EXRFileName(output)))
+					{
+						return false;
+					}
+
+					return !heatmap || WriteHeatmaps(*aovs, output);
+				});
+		}
+
+		if(written.valid() && !written.get())
+			return EXIT_FAILURE;
+
+		std::chrono::duration<double> const seconds = clock::now() - start;
+
+		std::printf(
+			"Rendered %zu frames in %.2fs, %.2fs per frame\n",
+			animation.frameCount,
+			seconds.count(),
+			seconds.count() / double(animation.frameCount));
+		std::fflush(stdout);
+
+		if(!ReportStatistics(rayTracer, options))
+			return EXIT_FAILURE;
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
 LibRay::Image NormalizeImage(LibRay::Image const &image)
 {
 	using namespace LibRay;
@@ -179,7 +739,31 @@ LibRay::Image NormalizeImage(LibRay::Image const &image)
 	return normalizedImage;
 }
 
-std::pair<bool, std::string> WriteImage(LibRay::Image const &normalizedImage)
+std::string OutputFileName(std::string const &suffix)
+{
+	// Generate a filename in the form of
+	// Rendered-*year*-*month*-*day*-*hour*-*minute*-*seconds**suffix*.png
+	using clock = std::chrono::system_clock;
+
+	std::time_t now = clock::to_time_t(clock::now());
+	std::tm buf;
+
+#if defined(_WIN32)
+	localtime_s(&buf, &now);
+#else
+	localtime_r(&now, &buf);
+#endif
+
+	std::stringstream stream;
+	stream << "Rendered-" << std::put_time(&buf, "%Y-%m-%d-%H-%M-%S")
+		<< suffix << ".png";
+
+	return stream.str();
+}
+
+std::pair<bool, std::string> WriteImage(
+	LibRay::Image const &normalizedImage,
+	std::string const &output)
 {
 	// Convert the floats to RGBA data 0..255
 	std::vector<std::uint32_t> ABGRData;
@@ -203,23 +787,6 @@ std::pair<bool, std::string> WriteImage(LibRay::Image const &normalizedImage)
 			return pixel;
 		});
 
-	// Generate a filename in the form of
-	// Rendered-*year*-*month*-*day*-*hour*-*minute*-*seconds*.tga
-	using clock = std::chrono::system_clock;
-
-	std::time_t now = clock::to_time_t(clock::now());
-	std::tm buf;
-
-#if defined(_WIN32)
-	localtime_s(&buf, &now);
-#else
-	localtime_r(&now, &buf);
-#endif
-
-	std::stringstream stream;
-	stream << "Rendered-" << std::put_time(&buf, "%Y-%m-%d-%H-%M-%S") << ".png";
-	std::string output = stream.str();
-
 	if(!stbi_write_png(
 			output.c_str(),
 			int(normalizedImage.sizeX),
@@ -235,6 +802,137 @@ std::pair<bool, std::string> WriteImage(LibRay::Image const &normalizedImage)
 	return {true, output};
 }
 
+std::string EXRFileName(std::string const &pngFileName)
+{
+	return pngFileName.substr(0, pngFileName.size() - std::string(".png").size())
+		+ ".exr";
+}
+
+bool WriteFloatImage(
+	LibRay::Image const &image,
+	Observer<LibRay::AOVBuffer const> aovs,
+	std::string const &output)
+{
+	try
+	{
+		LibRay::WriteEXR(output, image, aovs);
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return false;
+	}
+
+	return true;
+}
+
+bool ReportStatistics(
+	LibRay::RayTracer const &rayTracer,
+	Options const &options)
+{
+	LibRay::RenderStatistics const statistics = rayTracer.Statistics();
+
+	if(statistics.enabled || options.hardwareCounters)
+	{
+		std::printf("%s", statistics.Report().c_str());
+		std::fflush(stdout);
+	}
+
+	if(options.statisticsFile.empty())
+		return true;
+
+	if(!statistics.enabled)
+	{
+		std::fprintf(
+			stderr,
+			"Warning: libRay was built without LIBRAY_STATISTICS, the counts "
+			"in <%s> are 0\n",
+			options.statisticsFile.c_str());
+	}
+
+	std::unique_ptr<std::FILE, int (*)(std::FILE *)> const file(
+		std::fopen(options.statisticsFile.c_str(), "w"),
+		&std::fclose);
+
+	std::string const json = statistics.ToJSON() + "\n";
+
+	if(!file || std::fputs(json.c_str(), file.get()) < 0)
+	{
+		std::fprintf(
+			stderr,
+			"Failed to write to <%s>.\n",
+			options.statisticsFile.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool WriteTimeline(Options const &options)
+{
+	if(options.timelineFile.empty())
+		return true;
+
+	LibRay::Timeline::Stop();
+
+	try
+	{
+		LibRay::Timeline::Write(options.timelineFile);
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return false;
+	}
+
+	std::printf("Wrote the timeline to <%s>\n", options.timelineFile.c_str());
+	std::fflush(stdout);
+
+	return true;
+}
+
+bool WriteHeatmaps(
+	LibRay::AOVBuffer const &aovs,
+	std::string const &pngFileName)
+{
+	using namespace LibRay;
+
+	std::string const prefix =
+		pngFileName.substr(0, pngFileName.size() - std::string(".png").size());
+
+	for(AOV const aov: aovs.AOVs())
+	{
+		if(!AOVBuffer::IsCost(aov))
+			continue;
+
+		std::size_t const componentCount = AOVBuffer::ComponentCount(aov);
+
+		for(std::size_t c = 0; c < componentCount; ++c)
+		{
+			// Rendered-*date*-rays-shadow.png, or Rendered-*date*-time.png.
+			std::string output = prefix + "-" + AOVBuffer::Name(aov);
+			if(componentCount > 1)
+				output += std::string("-") + AOVBuffer::ComponentName(aov, c);
+
+			output += ".png";
+
+			Observer<float const> const values = aovs.Plane(aov, c);
+
+			if(!WriteImage(MakeHeatmap(values, aovs.Size()), output).first)
+				return false;
+
+			std::printf(
+				"Wrote heatmap <%s>, red is %g\n",
+				output.c_str(),
+				double(HeatmapScale(values, aovs.Size().x * aovs.Size().y)));
+		}
+	}
+
+	std::fflush(stdout);
+
+	return true;
+}
+
 #ifdef ENABLE_GLFW
 void KeyCallback(
 	Observer<GLFWwindow> window,
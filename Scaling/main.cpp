@@ -0,0 +1,682 @@
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <libRay/Material/Color.hpp>
+#include <libRay/Math/MathUtils.hpp>
+#include <libRay/Math/Vector.hpp>
+#include <libRay/AOVBuffer.hpp>
+#include <libRay/Camera.hpp>
+#include <libRay/Denoiser.hpp>
+#include <libRay/RayTracer.hpp>
+#include <libRay/Scene.hpp>
+#include <libRay/Scenes.hpp>
+#include <libRay/Utilites.hpp>
+
+// Like the benchmark, so the renders are the same work on every machine.
+constexpr std::uint64_t const seed = 0;
+constexpr std::uint8_t const maxReflectionBounces = 4;
+
+// The phases of a render that are timed, in the order they run.
+enum class Phase
+{
+	Load,
+	Build,
+	Trace,
+	PostProcess,
+	Total
+};
+
+constexpr std::size_t const phaseCount = 5;
+
+constexpr std::array<char const *, phaseCount> const phaseNames =
+{
+	"load",
+	"build",
+	"trace",
+	"postprocess",
+	"total"
+};
+
+struct Options final
+{
+	// Empty runs every benchmark scene, unless there's a synthetic one.
+	std::vector<std::string> scenes;
+
+	// Also render a generated scene, see Scenes::ParseSyntheticConfiguration.
+	std::optional<LibRay::Scenes::SyntheticConfiguration> synthetic;
+
+	// Empty runs every count from 1 to the hardware threads.
+	std::vector<std::uint32_t> threadCounts;
+
+	std::vector<LibRay::Math::Vector2st> resolutions =
+	{
+		{320, 180},
+		{640, 360}
+	};
+
+	std::vector<std::uint32_t> samplesPerPixel = {1, 4};
+
+	// Every time is the median of this many runs.
+	std::uint32_t repeats = 3;
+
+	std::string outputFile = "scaling.json";
+	std::string csvFile = "scaling.csv";
+};
+
+// The seconds of every phase of one configuration.
+struct Result final
+{
+	std::string scene;
+	LibRay::Math::Vector2st resolution;
+	std::uint32_t samplesPerPixel = 0;
+	std::uint32_t threads = 0;
+
+	std::array<double, phaseCount> seconds{};
+};
+
+// How a phase scales from the fewest threads run to threads.
+struct Scaling final
+{
+	double speedup = 0.;
+	double efficiency = 0.;
+
+	// Karp-Flatt, the serial fraction Amdahl's law needs to explain the
+	// speedup. Only defined with more threads than the baseline.
+	std::optional<double> serialFraction;
+};
+
+// A series is every thread count of one scene, resolution, sample count, and
+// phase.
+struct SeriesFit final
+{
+	std::string scene;
+	LibRay::Math::Vector2st resolution;
+	std::uint32_t samplesPerPixel = 0;
+	Phase phase = Phase::Total;
+
+	// The least squares fit of Amdahl's law to every thread count, and the
+	// speedup it allows with unlimited threads.
+	double serialFraction = 0.;
+	double maximumSpeedup = 0.;
+};
+
+static std::vector<std::uint32_t> ParseCounts(std::string const &list, char const *what)
+{
+	std::vector<std::uint32_t> counts;
+	for(std::string const &item: SplitList(list))
+	{
+		unsigned long const count = std::stoul(item);
+		if(count == 0)
+			throw std::invalid_argument(std::string(what) + " start at 1");
+
+		counts.push_back(std::uint32_t(count));
+	}
+
+	return counts;
+}
+
+static LibRay::Math::Vector2st ParseResolution(std::string const &resolution)
+{
+	std::size_t const x = resolution.find('x');
+	if(x == std::string::npos)
+	{
+		throw std::invalid_argument(
+			"Expected <width>x<height>, got <" + resolution + ">");
+	}
+
+	std::size_t const width = std::stoul(resolution.substr(0, x));
+	std::size_t const height = std::stoul(resolution.substr(x + 1));
+	if(width == 0 || height == 0)
+		throw std::invalid_argument("Empty resolution <" + resolution + ">");
+
+	return {width, height};
+}
+
+static void PrintUsage(std::string const &executable)
+{
+	std::printf(
+		"Usage: %s [options]\n"
+		"Renders the benchmark scenes with every combination of thread count,\n"
+		"resolution, and samples per pixel, and writes how each phase scales\n"
+		"with threads as JSON and CSV.\n"
+		"  --scenes <list>        Comma separated scenes to run, default all:\n"
+		"                         spheres, mesh, glass, lights, textures\n"
+		"  --synthetic <config>   Also render a generated scene, configured like\n"
+		"                         spheres=100000,lights=64,glass=0.2, with\n"
+		"                         spheres, boxes, triangles, meshInstances,\n"
+		"                         meshTriangles, lights, clusters, glass, mirror,\n"
+		"                         extent, and distribution=uniform, clustered,\n"
+		"                         or sphereflake\n"
+		"  --threads <list>       Comma separated thread counts, default every\n"
+		"                         count from 1 to the hardware threads\n"
+		"  --resolutions <list>   Comma separated <width>x<height>, default\n"
+		"                         320x180,640x360\n"
+		"  --samples <list>       Comma separated samples per pixel, default 1,4\n"
+		"  --repeat <count>       Runs per configuration, the median is reported,\n"
+		"                         default 3\n"
+		"  --output <file>        Where to write the JSON, default scaling.json\n"
+		"  --csv <file>           Where to write the CSV, default scaling.csv\n"
+		"  --help                 Show this\n",
+		executable.c_str());
+	std::fflush(stdout);
+}
+
+static std::optional<Options> ParseOptions(std::vector<std::string> const &arguments)
+{
+	Options options;
+
+	std::string const executable =
+		arguments.empty() ? std::string("Scaling") : arguments[0];
+
+	for(std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		std::string const &argument = arguments[i];
+
+		auto const value = [&]() -> std::string const &
+		{
+			if(i + 1 >= arguments.size())
+			{
+				throw std::invalid_argument(
+					"Missing value for option <" + argument + ">");
+			}
+
+			return arguments[++i];
+		};
+
+		try
+		{
+			if(argument == "--scenes")
+				options.scenes = SplitList(value());
+			else if(argument == "--synthetic")
+				options.synthetic = LibRay::Scenes::ParseSyntheticConfiguration(value());
+			else if(argument == "--threads")
+				options.threadCounts = ParseCounts(value(), "Thread counts");
+			else if(argument == "--resolutions")
+			{
+				options.resolutions.clear();
+				for(std::string const &resolution: SplitList(value()))
+					options.resolutions.push_back(ParseResolution(resolution));
+			}
+			else if(argument == "--samples")
+				options.samplesPerPixel = ParseCounts(value(), "Samples per pixel");
+			else if(argument == "--repeat")
+			{
+				options.repeats = std::uint32_t(std::stoul(value()));
+				if(options.repeats == 0)
+					throw std::invalid_argument("Repeat at least once");
+			}
+			else if(argument == "--output")
+				options.outputFile = value();
+			else if(argument == "--csv")
+				options.csvFile = value();
+			else if(argument == "--help")
+			{
+				PrintUsage(executable);
+				return std::nullopt;
+			}
+			else
+				throw std::invalid_argument("Unknown option <" + argument + ">");
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			PrintUsage(executable);
+			return std::nullopt;
+		}
+	}
+
+	if(options.threadCounts.empty())
+	{
+		std::uint32_t const hardwareThreads =
+			std::max(std::thread::hardware_concurrency(), 1u);
+
+		for(std::uint32_t threads = 1; threads <= hardwareThreads; ++threads)
+			options.threadCounts.push_back(threads);
+	}
+
+	// The fewest threads are the baseline of the speedups.
+	std::sort(options.threadCounts.begin(), options.threadCounts.end());
+	options.threadCounts.erase(
+		std::unique(options.threadCounts.begin(), options.threadCounts.end()),
+		options.threadCounts.end());
+
+	return options;
+}
+
+template<typename Function>
+static double MedianSeconds(std::uint32_t repeats, Function const &function)
+{
+	std::vector<double> seconds;
+	for(std::uint32_t i = 0; i < repeats; ++i)
+	{
+		Stopwatch watch;
+		watch.Start();
+
+		function();
+
+		watch.Stop();
+		seconds.push_back(watch.Seconds());
+	}
+
+	std::sort(seconds.begin(), seconds.end());
+
+	return seconds[seconds.size() / 2];
+}
+
+// Loading and building run on the calling thread, so they're timed once per
+// scene, and are the same for every thread count.
+static Result RunConfiguration(
+	LibRay::Scene const &scene,
+	std::uint32_t samplesPerPixel,
+	std::uint32_t threads,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	RayTracer const rayTracer(
+		scene,
+		RayTracerConfiguration(
+			maxReflectionBounces,
+			threads,
+			samplesPerPixel,
+			Sampling::SamplerType::Sobol));
+
+	// Warms up the caches and the workers, and renders what the denoiser
+	// post-processes.
+	AOVBuffer features(scene.Camera().ScreenSize(), Denoiser::Features());
+	Image const noisy = rayTracer.TraceWithAOVs(features);
+
+	Denoiser const denoiser(DenoiserConfiguration(), rayTracer.SharedTaskProcessor());
+
+	Result result;
+	result.resolution = scene.Camera().ScreenSize();
+	result.samplesPerPixel = samplesPerPixel;
+	result.threads = threads;
+
+	result.seconds[std::size_t(Phase::Load)] = scene.LoadSeconds();
+	result.seconds[std::size_t(Phase::Build)] = scene.BuildSeconds();
+
+	result.seconds[std::size_t(Phase::Trace)] = MedianSeconds(
+		options.repeats,
+		[&rayTracer]()
+		{
+			rayTracer.Trace();
+		});
+
+	result.seconds[std::size_t(Phase::PostProcess)] = MedianSeconds(
+		options.repeats,
+		[&denoiser, &noisy, &features]()
+		{
+			denoiser.Denoise(noisy, features);
+		});
+
+	result.seconds[std::size_t(Phase::Total)] =
+		result.seconds[std::size_t(Phase::Load)]
+		+ result.seconds[std::size_t(Phase::Build)]
+		+ result.seconds[std::size_t(Phase::Trace)]
+		+ result.seconds[std::size_t(Phase::PostProcess)];
+
+	return result;
+}
+
+// Loads the scene once, and renders it at every resolution, sample count, and
+// thread count.
+static std::vector<Result> RunScene(
+	LibRay::Scenes::StandardScene const &standardScene,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	Scene scene(
+		Camera(
+			standardScene.camera,
+			options.resolutions.front(),
+			Math::Radians(90.f),
+			1.f,
+			500.f),
+		seed,
+		Materials::Color::White(),
+		0.01f,
+		standardScene.load);
+
+	std::vector<Result> results;
+
+	for(Math::Vector2st const &resolution: options.resolutions)
+	{
+		scene.UpdateCameraScreenSize(resolution);
+
+		for(std::uint32_t const samplesPerPixel: options.samplesPerPixel)
+		{
+			for(std::uint32_t const threads: options.threadCounts)
+			{
+				Result result = RunConfiguration(scene, samplesPerPixel, threads, options);
+				result.scene = standardScene.name;
+
+				std::printf(
+					"%-10s %4zux%-4zu %3u spp %3u threads: trace %.3fs, "
+					"post-process %.3fs, total %.3fs\n",
+					result.scene.c_str(),
+					resolution.x,
+					resolution.y,
+					samplesPerPixel,
+					threads,
+					result.seconds[std::size_t(Phase::Trace)],
+					result.seconds[std::size_t(Phase::PostProcess)],
+					result.seconds[std::size_t(Phase::Total)]);
+				std::fflush(stdout);
+
+				results.push_back(std::move(result));
+			}
+		}
+	}
+
+	return results;
+}
+
+static bool SameSeries(Result const &a, Result const &b)
+{
+	return a.scene == b.scene
+		&& a.resolution.x == b.resolution.x
+		&& a.resolution.y == b.resolution.y
+		&& a.samplesPerPixel == b.samplesPerPixel;
+}
+
+// Results of a series are consecutive, with the fewest threads first.
+static Result const &Baseline(std::vector<Result> const &results, std::size_t index)
+{
+	while(index > 0 && SameSeries(results[index - 1], results[index]))
+		--index;
+
+	return results[index];
+}
+
+static Scaling ScalingOf(Result const &baseline, Result const &result, Phase phase)
+{
+	double const baselineSeconds = baseline.seconds[std::size_t(phase)];
+	double const seconds = result.seconds[std::size_t(phase)];
+
+	// How many times the baseline threads were run.
+	double const threadRatio = double(result.threads) / double(baseline.threads);
+
+	Scaling scaling;
+	scaling.speedup = seconds > 0. ? baselineSeconds / seconds : 0.;
+	scaling.efficiency = scaling.speedup / threadRatio;
+
+	if(threadRatio > 1. && scaling.speedup > 0.)
+	{
+		scaling.serialFraction =
+			(1. / scaling.speedup - 1. / threadRatio) / (1. - 1. / threadRatio);
+	}
+
+	return scaling;
+}
+
+// Amdahl's law, 1 / speedup = f + (1 - f) / p, is linear in f after moving
+// 1 / p over: 1 / speedup - 1 / p = f * (1 - 1 / p).
+static std::vector<SeriesFit> FitSeries(std::vector<Result> const &results)
+{
+	std::vector<SeriesFit> fits;
+
+	std::size_t start = 0;
+	while(start < results.size())
+	{
+		std::size_t end = start + 1;
+		while(end < results.size() && SameSeries(results[start], results[end]))
+			++end;
+
+		for(std::size_t phase = 0; phase < phaseCount; ++phase)
+		{
+			double xy = 0., xx = 0.;
+			for(std::size_t i = start; i < end; ++i)
+			{
+				Scaling const scaling =
+					ScalingOf(results[start], results[i], Phase(phase));
+				if(scaling.speedup <= 0.)
+					continue;
+
+				double const threadRatio =
+					double(results[i].threads) / double(results[start].threads);
+
+				double const x = 1. - 1. / threadRatio;
+				double const y = 1. / scaling.speedup - 1. / threadRatio;
+
+				xy += x * y;
+				xx += x * x;
+			}
+
+			// A single thread count says nothing about scaling.
+			if(xx <= 0.)
+				continue;
+
+			SeriesFit fit;
+			fit.scene = results[start].scene;
+			fit.resolution = results[start].resolution;
+			fit.samplesPerPixel = results[start].samplesPerPixel;
+			fit.phase = Phase(phase);
+			fit.serialFraction = LibRay::Math::Clamp(xy / xx, 0., 1.);
+			fit.maximumSpeedup =
+				fit.serialFraction > 0. ? 1. / fit.serialFraction : 0.;
+
+			fits.push_back(std::move(fit));
+		}
+
+		start = end;
+	}
+
+	return fits;
+}
+
+static std::string ToCSV(std::vector<Result> const &results)
+{
+	std::ostringstream csv;
+	csv.precision(9);
+
+	csv << "scene,width,height,samplesPerPixel,threads,phase,seconds,speedup,"
+		<< "efficiency,serialFraction\n";
+
+	for(std::size_t i = 0; i < results.size(); ++i)
+	{
+		Result const &result = results[i];
+		Result const &baseline = Baseline(results, i);
+
+		for(std::size_t phase = 0; phase < phaseCount; ++phase)
+		{
+			Scaling const scaling = ScalingOf(baseline, result, Phase(phase));
+
+			csv << result.scene << ','
+				<< result.resolution.x << ','
+				<< result.resolution.y << ','
+				<< result.samplesPerPixel << ','
+				<< result.threads << ','
+				<< phaseNames[phase] << ','
+				<< result.seconds[phase] << ','
+				<< scaling.speedup << ','
+				<< scaling.efficiency << ',';
+
+			if(scaling.serialFraction)
+				csv << *scaling.serialFraction;
+
+			csv << '\n';
+		}
+	}
+
+	return csv.str();
+}
+
+static std::string ToJSON(
+	std::vector<Result> const &results,
+	std::vector<SeriesFit> const &fits,
+	Options const &options)
+{
+	std::ostringstream json;
+	json.precision(9);
+
+	json << "{\n"
+		<< "\t\"seed\": " << seed << ",\n"
+		<< "\t\"maxReflectionBounces\": " << unsigned(maxReflectionBounces) << ",\n"
+		<< "\t\"repeats\": " << options.repeats << ",\n"
+		<< "\t\"results\":\n\t[\n";
+
+	for(std::size_t i = 0; i < results.size(); ++i)
+	{
+		Result const &result = results[i];
+		Result const &baseline = Baseline(results, i);
+
+		for(std::size_t phase = 0; phase < phaseCount; ++phase)
+		{
+			Scaling const scaling = ScalingOf(baseline, result, Phase(phase));
+
+			json << "\t\t{"
+				<< "\"scene\": \"" << result.scene << "\", "
+				<< "\"width\": " << result.resolution.x << ", "
+				<< "\"height\": " << result.resolution.y << ", "
+				<< "\"samplesPerPixel\": " << result.samplesPerPixel << ", "
+				<< "\"threads\": " << result.threads << ", "
+				<< "\"phase\": \"" << phaseNames[phase] << "\", "
+				<< "\"seconds\": " << result.seconds[phase] << ", "
+				<< "\"speedup\": " << scaling.speedup << ", "
+				<< "\"efficiency\": " << scaling.efficiency << ", "
+				<< "\"serialFraction\": ";
+
+			if(scaling.serialFraction)
+				json << *scaling.serialFraction;
+			else
+				json << "null";
+
+			bool const last = i + 1 == results.size() && phase + 1 == phaseCount;
+			json << (last ? "}\n" : "},\n");
+		}
+	}
+
+	json << "\t],\n\t\"fits\":\n\t[\n";
+
+	for(std::size_t i = 0; i < fits.size(); ++i)
+	{
+		SeriesFit const &fit = fits[i];
+
+		json << "\t\t{"
+			<< "\"scene\": \"" << fit.scene << "\", "
+			<< "\"width\": " << fit.resolution.x << ", "
+			<< "\"height\": " << fit.resolution.y << ", "
+			<< "\"samplesPerPixel\": " << fit.samplesPerPixel << ", "
+			<< "\"phase\": \"" << phaseNames[std::size_t(fit.phase)] << "\", "
+			<< "\"serialFraction\": " << fit.serialFraction << ", "
+			<< "\"maximumSpeedup\": ";
+
+		if(fit.maximumSpeedup > 0.)
+			json << fit.maximumSpeedup;
+		else
+			json << "null";
+
+		json << (i + 1 < fits.size() ? "},\n" : "}\n");
+	}
+
+	json << "\t]\n}\n";
+
+	return json.str();
+}
+
+static void PrintFits(std::vector<SeriesFit> const &fits)
+{
+	for(SeriesFit const &fit: fits)
+	{
+		if(fit.phase == Phase::Load || fit.phase == Phase::Build)
+			continue;
+
+		std::printf(
+			"%-10s %4zux%-4zu %3u spp %-11s serial fraction %.3f",
+			fit.scene.c_str(),
+			fit.resolution.x,
+			fit.resolution.y,
+			fit.samplesPerPixel,
+			phaseNames[std::size_t(fit.phase)],
+			fit.serialFraction);
+
+		if(fit.maximumSpeedup > 0.)
+			std::printf(", at most %.1fx faster\n", fit.maximumSpeedup);
+		else
+			std::printf("\n");
+	}
+
+	std::fflush(stdout);
+}
+
+static void WriteFile(std::string const &fileName, std::string const &contents)
+{
+	std::ofstream file(fileName);
+	if(!(file << contents))
+		throw std::runtime_error("Failed to write <" + fileName + ">");
+
+	std::printf("Wrote <%s>\n", fileName.c_str());
+	std::fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	using namespace LibRay;
+
+	std::vector<std::string> arguments(argv, argv + argc);
+
+	std::optional<Options> const options = ParseOptions(arguments);
+	if(!options)
+		return EXIT_FAILURE;
+
+	std::vector<Scenes::StandardScene> scenes = Scenes::BenchmarkScenes();
+
+	if(options->synthetic && options->scenes.empty())
+		scenes.clear();
+	else if(!options->scenes.empty())
+	{
+		try
+		{
+			scenes = Scenes::PickScenes(scenes, options->scenes);
+		}
+		catch(std::invalid_argument const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(options->synthetic)
+		scenes.push_back(Scenes::Synthetic(*options->synthetic));
+
+	try
+	{
+		std::vector<Result> results;
+		for(Scenes::StandardScene const &scene: scenes)
+		{
+			std::vector<Result> sceneResults = RunScene(scene, *options);
+
+			results.insert(
+				results.end(),
+				std::make_move_iterator(sceneResults.begin()),
+				std::make_move_iterator(sceneResults.end()));
+		}
+
+		std::vector<SeriesFit> const fits = FitSeries(results);
+		PrintFits(fits);
+
+		WriteFile(options->outputFile, ToJSON(results, fits, *options));
+		WriteFile(options->csvFile, ToCSV(results));
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
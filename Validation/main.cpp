@@ -0,0 +1,717 @@
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <stb/stb_image_write.h>
+
+#include <libRay/Material/Color.hpp>
+#include <libRay/Math/MathUtils.hpp>
+#include <libRay/Math/Vector.hpp>
+#include <libRay/Camera.hpp>
+#include <libRay/EXRReader.hpp>
+#include <libRay/EXRWriter.hpp>
+#include <libRay/Heatmap.hpp>
+#include <libRay/Image.hpp>
+#include <libRay/JSONRecords.hpp>
+#include <libRay/RayTracer.hpp>
+#include <libRay/Scene.hpp>
+#include <libRay/Scenes.hpp>
+
+// Everything that changes the image is fixed, references are only valid for
+// these.
+constexpr std::size_t const width = 320;
+constexpr std::size_t const height = 180;
+constexpr std::uint64_t const seed = 0;
+constexpr std::uint32_t const samplesPerPixel = 2;
+constexpr std::uint8_t const maxReflectionBounces = 4;
+
+// Pixels with a channel further off than this are outliers. Other compilers,
+// -ffast-math, and -march=native round differently, which flips the few rays
+// that graze an edge, and with them whole pixels.
+constexpr double const outlierError = 0.01;
+
+struct Options final
+{
+	// Empty validates every reference scene.
+	std::vector<std::string> scenes;
+
+	std::string referenceDirectory = "Validation/References";
+
+	// Where the renders and differences of failed scenes are written.
+	std::string outputDirectory = ".";
+
+	// Write the references instead of comparing against them.
+	bool update = false;
+
+	// The largest root mean square error of a render that passes, in the
+	// linear radiance of the render, where 1 is white. Outliers are left out.
+	double tolerance = 0.001;
+
+	// The largest share of outlier pixels that passes, in percent. Builds
+	// with different floating point flags were at most 0.1% apart.
+	double outlierPercent = 0.5;
+
+	// 0 uses every hardware thread. The renders don't depend on it.
+	std::uint32_t threadCount = 0;
+};
+
+// What a reference was rendered with, from the manifest next to the
+// references.
+struct Recording final
+{
+	std::size_t width = 0;
+	std::size_t height = 0;
+	std::uint64_t seed = 0;
+	std::uint32_t samplesPerPixel = 0;
+	std::uint32_t maxReflectionBounces = 0;
+
+	// The compiler and configuration, floating point results depend on both.
+	std::string build;
+};
+
+struct Comparison final
+{
+	double rmse = 0.;
+
+	// Peak signal to noise ratio in decibels, with white as the peak.
+	// Infinite for identical images.
+	double psnr = 0.;
+
+	// The largest difference of a single channel of a pixel, and where.
+	double largestError = 0.;
+	std::size_t largestX = 0;
+	std::size_t largestY = 0;
+
+	// Pixels that are NaN or infinite in only one of the images.
+	std::size_t invalidPixels = 0;
+
+	// Pixels with a channel more than outlierError off, and the root mean
+	// square error of the others.
+	std::size_t outliers = 0;
+	double inlierRmse = 0.;
+
+	// The root mean square error of every pixel, over its channels.
+	std::vector<float> pixelErrors;
+};
+
+// The benchmark scenes, and generated ones covering the model instances,
+// random triangles, and sphereflakes they don't have.
+static std::vector<LibRay::Scenes::StandardScene> ReferenceScenes()
+{
+	using namespace LibRay;
+
+	std::vector<Scenes::StandardScene> scenes = Scenes::BenchmarkScenes();
+
+	std::vector<std::pair<std::string, std::string>> const synthetic =
+	{
+		{
+			"uniform",
+			"spheres=400,boxes=200,lights=8,glass=0.2,mirror=0.2"
+		},
+		{
+			"clustered",
+			"spheres=200,boxes=100,triangles=2000,meshInstances=50,"
+			"meshTriangles=512,lights=16,distribution=clustered,clusters=4"
+		},
+		{
+			"sphereflake",
+			"spheres=820,lights=4,distribution=sphereflake,mirror=0.3"
+		}
+	};
+
+	for(auto const &[name, description]: synthetic)
+	{
+		Scenes::StandardScene scene =
+			Scenes::Synthetic(Scenes::ParseSyntheticConfiguration(description));
+		scene.name = name;
+
+		scenes.push_back(std::move(scene));
+	}
+
+	return scenes;
+}
+
+static void PrintUsage(std::string const &executable)
+{
+	std::printf(
+		"Usage: %s [options]\n"
+		"Renders the reference scenes at %zux%zu, %u samples per pixel, and\n"
+		"seed %" PRIu64 ", and compares the float images against references\n"
+		"recorded earlier. Exits with an error when any differs by more than\n"
+		"the tolerance, writing the render and a heatmap of the difference.\n"
+		"Pixels with a channel more than %g off are outliers, which are left\n"
+		"out of the tolerance and limited by --outliers instead.\n"
+		"  --scenes <list>        Comma separated scenes to validate, default all:\n"
+		"                         spheres, mesh, glass, lights, textures, uniform,\n"
+		"                         clustered, sphereflake\n"
+		"  --references <dir>     Where the references are, default\n"
+		"                         Validation/References\n"
+		"  --output <dir>         Where failed renders and differences go,\n"
+		"                         default the working directory\n"
+		"  --update               Record the references instead of comparing\n"
+		"  --tolerance <rmse>     The largest root mean square error that passes,\n"
+		"                         where 1 is white, default 0.001\n"
+		"  --outliers <percent>   The largest share of outlier pixels that\n"
+		"                         passes, default 0.5\n"
+		"  --threads <count>      Threads to render with, default all\n"
+		"  --help                 Show this\n",
+		executable.c_str(),
+		width,
+		height,
+		samplesPerPixel,
+		seed,
+		outlierError);
+	std::fflush(stdout);
+}
+
+static std::optional<Options> ParseOptions(std::vector<std::string> const &arguments)
+{
+	Options options;
+
+	std::string const executable =
+		arguments.empty() ? std::string("Validation") : arguments[0];
+
+	for(std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		std::string const &argument = arguments[i];
+
+		auto const value = [&]() -> std::string const &
+		{
+			if(i + 1 >= arguments.size())
+			{
+				throw std::invalid_argument(
+					"Missing value for option <" + argument + ">");
+			}
+
+			return arguments[++i];
+		};
+
+		try
+		{
+			if(argument == "--scenes")
+				options.scenes = SplitList(value());
+			else if(argument == "--references")
+				options.referenceDirectory = value();
+			else if(argument == "--output")
+				options.outputDirectory = value();
+			else if(argument == "--update")
+				options.update = true;
+			else if(argument == "--tolerance")
+			{
+				options.tolerance = std::stod(value());
+				if(!(options.tolerance >= 0.))
+					throw std::invalid_argument("The tolerance can't be negative");
+			}
+			else if(argument == "--outliers")
+			{
+				options.outlierPercent = std::stod(value());
+				if(!(options.outlierPercent >= 0.))
+					throw std::invalid_argument("The outlier share can't be negative");
+			}
+			else if(argument == "--threads")
+				options.threadCount = std::uint32_t(std::stoul(value()));
+			else if(argument == "--help")
+			{
+				PrintUsage(executable);
+				return std::nullopt;
+			}
+			else
+				throw std::invalid_argument("Unknown option <" + argument + ">");
+		}
+		catch(std::exception const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			PrintUsage(executable);
+			return std::nullopt;
+		}
+	}
+
+	if(options.threadCount == 0)
+		options.threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	return options;
+}
+
+// The manifest of the references, in the reference directory.
+static std::string ManifestFile(Options const &options)
+{
+	return options.referenceDirectory + "/references.json";
+}
+
+static std::string BuildDescription()
+{
+#if defined(__clang__)
+	std::string build = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	std::string build = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	std::string build = "msvc " + std::to_string(_MSC_VER);
+#else
+	std::string build = "unknown compiler";
+#endif
+
+#if defined(NDEBUG)
+	build += " release";
+#else
+	build += " debug";
+#endif
+
+	return build;
+}
+
+static Recording CurrentRecording()
+{
+	Recording recording;
+	recording.width = width;
+	recording.height = height;
+	recording.seed = seed;
+	recording.samplesPerPixel = samplesPerPixel;
+	recording.maxReflectionBounces = maxReflectionBounces;
+	recording.build = BuildDescription();
+
+	return recording;
+}
+
+// The recordings by scene, empty when there's no manifest yet.
+static std::map<std::string, Recording> ReadManifest(Options const &options)
+{
+	using namespace LibRay;
+
+	std::string const fileName = ManifestFile(options);
+
+	if(!std::ifstream(fileName))
+		return {};
+
+	std::map<std::string, Recording> recordings;
+	for(JSONRecord const &record: ReadJSONRecords(fileName, "references"))
+	{
+		auto const scene = record.find("scene");
+		auto const build = record.find("build");
+		if(scene == record.end())
+			throw std::runtime_error("A reference in <" + fileName + "> has no scene");
+
+		Recording &recording = recordings[scene->second];
+		recording.width = std::size_t(RecordNumber(record, "width"));
+		recording.height = std::size_t(RecordNumber(record, "height"));
+		recording.seed = std::uint64_t(RecordNumber(record, "seed"));
+		recording.samplesPerPixel =
+			std::uint32_t(RecordNumber(record, "samplesPerPixel"));
+		recording.maxReflectionBounces =
+			std::uint32_t(RecordNumber(record, "maxReflectionBounces"));
+		recording.build = build != record.end() ? build->second : std::string();
+	}
+
+	return recordings;
+}
+
+static void WriteManifest(
+	std::map<std::string, Recording> const &recordings,
+	Options const &options)
+{
+	std::string const fileName = ManifestFile(options);
+
+	std::ofstream file(fileName);
+
+	file << "{\n\t\"references\":\n\t[\n";
+
+	std::size_t i = 0;
+	for(auto const &[scene, recording]: recordings)
+	{
+		file << "\t\t{"
+			<< "\"scene\": \"" << scene << "\", "
+			<< "\"width\": " << recording.width << ", "
+			<< "\"height\": " << recording.height << ", "
+			<< "\"seed\": " << recording.seed << ", "
+			<< "\"samplesPerPixel\": " << recording.samplesPerPixel << ", "
+			<< "\"maxReflectionBounces\": " << recording.maxReflectionBounces << ", "
+			<< "\"build\": \"" << recording.build << "\""
+			<< (++i < recordings.size() ? "},\n" : "}\n");
+	}
+
+	file << "\t]\n}\n";
+
+	if(!file)
+		throw std::runtime_error("Failed to write <" + fileName + ">");
+}
+
+static LibRay::Image Render(
+	LibRay::Scenes::StandardScene const &standardScene,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	Scene const scene(
+		Camera(
+			standardScene.camera,
+			Math::Vector2st(width, height),
+			Math::Radians(90.f),
+			1.f,
+			500.f),
+		seed,
+		Materials::Color::White(),
+		0.01f,
+		standardScene.load);
+
+	// Everything else is left at its default, so the references check what
+	// every user renders.
+	RayTracer const rayTracer(
+		scene,
+		RayTracerConfiguration(
+			maxReflectionBounces,
+			options.threadCount,
+			samplesPerPixel,
+			Sampling::SamplerType::Sobol));
+
+	return rayTracer.Trace();
+}
+
+static bool IsFinite(LibRay::Materials::Color const &color)
+{
+	return std::isfinite(color.r) && std::isfinite(color.g) && std::isfinite(color.b);
+}
+
+// Both images have to be the same size.
+static Comparison Compare(LibRay::Image const &render, LibRay::Image const &reference)
+{
+	using LibRay::Materials::Color;
+
+	std::size_t const pixelCount = render.sizeX * render.sizeY;
+
+	Comparison comparison;
+	comparison.pixelErrors.resize(pixelCount, 0.f);
+
+	double squaredSum = 0.;
+	double inlierSquaredSum = 0.;
+
+	for(std::size_t i = 0; i < pixelCount; ++i)
+	{
+		Color const &a = render.pixels[i];
+		Color const &b = reference.pixels[i];
+
+		// Matching NaNs and infinities are as broken as the reference, not
+		// different from it.
+		if(!IsFinite(a) || !IsFinite(b))
+		{
+			bool const same =
+				std::isnan(a.r) == std::isnan(b.r)
+				&& std::isnan(a.g) == std::isnan(b.g)
+				&& std::isnan(a.b) == std::isnan(b.b)
+				&& (std::isnan(a.r) || a.r == b.r)
+				&& (std::isnan(a.g) || a.g == b.g)
+				&& (std::isnan(a.b) || a.b == b.b);
+
+			if(!same)
+			{
+				++comparison.invalidPixels;
+				comparison.pixelErrors[i] = std::numeric_limits<float>::max();
+			}
+
+			continue;
+		}
+
+		std::array<double, 3> const channelErrors =
+		{
+			double(a.r) - double(b.r),
+			double(a.g) - double(b.g),
+			double(a.b) - double(b.b)
+		};
+
+		double pixelSquaredSum = 0.;
+		double pixelLargestError = 0.;
+		for(double const error: channelErrors)
+		{
+			pixelSquaredSum += error * error;
+			pixelLargestError = std::max(pixelLargestError, std::abs(error));
+
+			if(std::abs(error) > comparison.largestError)
+			{
+				comparison.largestError = std::abs(error);
+				comparison.largestX = i % render.sizeX;
+				comparison.largestY = i / render.sizeX;
+			}
+		}
+
+		squaredSum += pixelSquaredSum;
+
+		if(pixelLargestError > outlierError)
+			++comparison.outliers;
+		else
+			inlierSquaredSum += pixelSquaredSum;
+
+		comparison.pixelErrors[i] = float(std::sqrt(pixelSquaredSum / 3.));
+	}
+
+	comparison.rmse = std::sqrt(squaredSum / double(pixelCount * 3));
+	comparison.psnr = comparison.rmse > 0.
+		? -20. * std::log10(comparison.rmse)
+		: std::numeric_limits<double>::infinity();
+
+	std::size_t const inliers =
+		pixelCount - comparison.invalidPixels - comparison.outliers;
+	comparison.inlierRmse = inliers > 0
+		? std::sqrt(inlierSquaredSum / double(inliers * 3))
+		: 0.;
+
+	return comparison;
+}
+
+static bool WritePNG(LibRay::Image const &image, std::string const &fileName)
+{
+	std::vector<std::uint8_t> rgb;
+	rgb.reserve(image.pixels.size() * 3);
+
+	for(LibRay::Materials::Color const &pixel: image.pixels)
+	{
+		rgb.push_back(std::uint8_t(255.99f * LibRay::Math::Clamp(pixel.r, 0.f, 1.f)));
+		rgb.push_back(std::uint8_t(255.99f * LibRay::Math::Clamp(pixel.g, 0.f, 1.f)));
+		rgb.push_back(std::uint8_t(255.99f * LibRay::Math::Clamp(pixel.b, 0.f, 1.f)));
+	}
+
+	return stbi_write_png(
+		fileName.c_str(),
+		int(image.sizeX),
+		int(image.sizeY),
+		3,
+		rgb.data(),
+		0) != 0;
+}
+
+// Writes the render for a closer look, and where it differs as a heatmap.
+static void WriteFailure(
+	std::string const &name,
+	LibRay::Image const &render,
+	Comparison const &comparison,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	std::string const prefix = options.outputDirectory + "/" + name;
+
+	WriteEXR(prefix + "-render.exr", render);
+	std::printf("  Wrote <%s-render.exr>\n", prefix.c_str());
+
+	Image const difference = MakeHeatmap(
+		comparison.pixelErrors.data(),
+		Math::Vector2st(render.sizeX, render.sizeY));
+
+	if(!WritePNG(difference, prefix + "-difference.png"))
+		throw std::runtime_error("Failed to write <" + prefix + "-difference.png>");
+
+	std::printf(
+		"  Wrote <%s-difference.png>, red is an error of %g\n",
+		prefix.c_str(),
+		double(HeatmapScale(comparison.pixelErrors.data(), comparison.pixelErrors.size())));
+}
+
+// Returns whether the render of scene matches its reference. Updating adds
+// the scene to recordings.
+static bool Validate(
+	LibRay::Scenes::StandardScene const &scene,
+	std::map<std::string, Recording> &recordings,
+	Options const &options)
+{
+	using namespace LibRay;
+
+	std::string const referenceFile =
+		options.referenceDirectory + "/" + scene.name + ".exr";
+
+	Recording const current = CurrentRecording();
+
+	if(!options.update)
+	{
+		auto const recording = recordings.find(scene.name);
+		if(recording == recordings.end())
+		{
+			std::printf(
+				"%-12s FAILED, not in <%s>, record it with --update\n",
+				scene.name.c_str(),
+				ManifestFile(options).c_str());
+			std::fflush(stdout);
+
+			return false;
+		}
+
+		Recording const &recorded = recording->second;
+		if(recorded.width != current.width
+			|| recorded.height != current.height
+			|| recorded.seed != current.seed
+			|| recorded.samplesPerPixel != current.samplesPerPixel
+			|| recorded.maxReflectionBounces != current.maxReflectionBounces)
+		{
+			std::printf(
+				"%-12s FAILED, recorded at %zux%zu, %u samples per pixel, %u bounces,"
+				" and seed %" PRIu64 ", record it again with --update\n",
+				scene.name.c_str(),
+				recorded.width,
+				recorded.height,
+				recorded.samplesPerPixel,
+				recorded.maxReflectionBounces,
+				recorded.seed);
+			std::fflush(stdout);
+
+			return false;
+		}
+
+		// Other compilers and flags round differently, small differences are
+		// expected then.
+		if(recorded.build != current.build)
+		{
+			std::printf(
+				"%-12s recorded with %s, this is %s\n",
+				scene.name.c_str(),
+				recorded.build.c_str(),
+				current.build.c_str());
+		}
+	}
+
+	Image const render = Render(scene, options);
+
+	if(options.update)
+	{
+		WriteEXR(referenceFile, render);
+		recordings[scene.name] = current;
+
+		std::printf("%-12s recorded <%s>\n", scene.name.c_str(), referenceFile.c_str());
+		std::fflush(stdout);
+
+		return true;
+	}
+
+	std::optional<Image> reference;
+	try
+	{
+		reference = ReadEXR(referenceFile);
+	}
+	catch(std::exception const &e)
+	{
+		std::printf(
+			"%-12s FAILED, no reference: %s, record one with --update\n",
+			scene.name.c_str(),
+			e.what());
+		std::fflush(stdout);
+
+		return false;
+	}
+
+	if(reference->sizeX != render.sizeX || reference->sizeY != render.sizeY)
+	{
+		std::printf(
+			"%-12s FAILED, the reference is %zux%zu instead of %zux%zu\n",
+			scene.name.c_str(),
+			reference->sizeX,
+			reference->sizeY,
+			render.sizeX,
+			render.sizeY);
+		std::fflush(stdout);
+
+		return false;
+	}
+
+	Comparison const comparison = Compare(render, *reference);
+
+	double const outlierPercent =
+		100. * double(comparison.outliers) / double(render.pixels.size());
+
+	bool const passed = comparison.invalidPixels == 0
+		&& comparison.inlierRmse <= options.tolerance
+		&& outlierPercent <= options.outlierPercent;
+
+	std::printf(
+		"%-12s %s  RMSE %.3g, %.3g without %.2f%% outliers, PSNR %.1f dB,"
+		" largest error %.3g at %zu, %zu",
+		scene.name.c_str(),
+		passed ? "passed" : "FAILED",
+		comparison.rmse,
+		comparison.inlierRmse,
+		outlierPercent,
+		comparison.psnr,
+		comparison.largestError,
+		comparison.largestX,
+		comparison.largestY);
+
+	if(comparison.invalidPixels > 0)
+		std::printf(", %zu pixels NaN or infinite in one image", comparison.invalidPixels);
+
+	std::printf("\n");
+	std::fflush(stdout);
+
+	if(!passed)
+		WriteFailure(scene.name, render, comparison, options);
+
+	return passed;
+}
+
+int main(int argc, char **argv)
+{
+	using namespace LibRay;
+
+	std::vector<std::string> arguments(argv, argv + argc);
+
+	std::optional<Options> const options = ParseOptions(arguments);
+	if(!options)
+		return EXIT_FAILURE;
+
+	std::vector<Scenes::StandardScene> scenes = ReferenceScenes();
+
+	if(!options->scenes.empty())
+	{
+		try
+		{
+			scenes = Scenes::PickScenes(scenes, options->scenes);
+		}
+		catch(std::invalid_argument const &e)
+		{
+			std::fprintf(stderr, "%s\n", e.what());
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::size_t failures = 0;
+
+	try
+	{
+		std::map<std::string, Recording> recordings = ReadManifest(*options);
+
+		if(options->update)
+			std::filesystem::create_directories(options->referenceDirectory);
+
+		for(Scenes::StandardScene const &scene: scenes)
+		{
+			if(!Validate(scene, recordings, *options))
+				++failures;
+		}
+
+		// Scenes that weren't updated keep their recordings.
+		if(options->update)
+			WriteManifest(recordings, *options);
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Caught exception: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	if(failures > 0)
+	{
+		std::printf("%zu of %zu scenes differ from their references\n", failures, scenes.size());
+		std::fflush(stdout);
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include "AOVBuffer.hpp"
+
+#include <cassert>
+#include <limits>
+
+#include "PixelCost.hpp"
+
+namespace LibRay
+{
+using namespace Math;
+
+constexpr std::size_t const noPlane = std::numeric_limits<std::size_t>::max();
+
+AOVBuffer::AOVBuffer(Vector2st const &size, std::vector<AOV> const &aovs)
+: size(size)
+, aovs()
+, firstPlane()
+, planes()
+{
+	firstPlane.fill(noPlane);
+
+	for(AOV const aov: aovs)
+	{
+		// Asking for an AOV twice still gives it once.
+		if(Has(aov))
+			continue;
+
+		this->aovs.push_back(aov);
+		firstPlane[std::size_t(aov)] = planes.size();
+
+		for(std::size_t i = 0; i < ComponentCount(aov); ++i)
+			planes.emplace_back(size.x * size.y, 0.f);
+	}
+}
+
+Vector2st const &AOVBuffer::Size() const
+{
+	return size;
+}
+
+std::vector<AOV> const &AOVBuffer::AOVs() const
+{
+	return aovs;
+}
+
+bool AOVBuffer::Has(AOV aov) const
+{
+	return firstPlane[std::size_t(aov)] != noPlane;
+}
+
+Observer<float> AOVBuffer::Plane(AOV aov, std::size_t component)
+{
+	assert(component < ComponentCount(aov));
+
+	if(!Has(aov))
+		return nullptr;
+
+	return planes[firstPlane[std::size_t(aov)] + component].data();
+}
+
+Observer<float const> AOVBuffer::Plane(AOV aov, std::size_t component) const
+{
+	assert(component < ComponentCount(aov));
+
+	if(!Has(aov))
+		return nullptr;
+
+	return planes[firstPlane[std::size_t(aov)] + component].data();
+}
+
+std::size_t AOVBuffer::MemorySize() const
+{
+	return planes.size() * size.x * size.y * sizeof(float);
+}
+
+std::size_t AOVBuffer::ComponentCount(AOV aov)
+{
+	switch(aov)
+	{
+	case AOV::Depth:
+	case AOV::ShapeId:
+	case AOV::BounceCount:
+	case AOV::NodeVisits:
+	case AOV::PrimitiveTests:
+	case AOV::Time:
+		return 1;
+	case AOV::Normal:
+	case AOV::Albedo:
+		return 3;
+	case AOV::Rays:
+		return rayTypeCount;
+	}
+
+	return 0;
+}
+
+char const *AOVBuffer::Name(AOV aov)
+{
+	switch(aov)
+	{
+	case AOV::Depth:
+		return "depth";
+	case AOV::Normal:
+		return "normal";
+	case AOV::Albedo:
+		return "albedo";
+	case AOV::ShapeId:
+		return "shape-id";
+	case AOV::BounceCount:
+		return "bounce-count";
+	case AOV::NodeVisits:
+		return "bvh-nodes";
+	case AOV::PrimitiveTests:
+		return "primitive-tests";
+	case AOV::Rays:
+		return "rays";
+	case AOV::Time:
+		return "time";
+	}
+
+	return "unknown";
+}
+
+bool AOVBuffer::IsCost(AOV aov)
+{
+	return aov == AOV::NodeVisits
+		|| aov == AOV::PrimitiveTests
+		|| aov == AOV::Rays
+		|| aov == AOV::Time;
+}
+
+char const *AOVBuffer::ComponentName(AOV aov, std::size_t component)
+{
+	assert(component < ComponentCount(aov));
+
+	switch(aov)
+	{
+	case AOV::Depth:
+		return "Z";
+	case AOV::Normal:
+		return std::array<char const *, 3>{"X", "Y", "Z"}[component];
+	case AOV::Albedo:
+		return std::array<char const *, 3>{"R", "G", "B"}[component];
+	case AOV::ShapeId:
+	case AOV::BounceCount:
+	case AOV::NodeVisits:
+	case AOV::PrimitiveTests:
+		return "Y";
+	case AOV::Rays:
+		return RayTypeName(RayType(component));
+	case AOV::Time:
+		return "ns";
+	}
+
+	return "unknown";
+}
+} // namespace LibRay
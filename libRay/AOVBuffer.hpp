@@ -0,0 +1,90 @@
+#ifndef eb675168_9c84_4c73_9622_72be8df3c4f0
+#define eb675168_9c84_4c73_9622_72be8df3c4f0
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "API.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+// Arbitrary output variables, describing what the primary rays of a pixel hit.
+enum class AOV : std::uint8_t
+{
+	// Distance from the camera to the hit.
+	Depth,
+	// World space surface normal, xyz.
+	Normal,
+	// The surface color without lighting, rgb.
+	Albedo,
+	// Index in Scene::Shapes of what the first sample hit, -1 for nothing.
+	ShapeId,
+	// How many reflections and refractions deep the ray trees went.
+	BounceCount,
+
+	// What the pixel cost to render, summed over its samples instead of
+	// averaged. Counting slows rendering down a little.
+	// Bounding volume hierarchy nodes entered.
+	NodeVisits,
+	// Shapes and triangles tested against rays.
+	PrimitiveTests,
+	// Rays traced, per RayType.
+	Rays,
+	// Wall clock nanoseconds spent on the pixel.
+	Time
+};
+
+constexpr std::size_t const aovCount = 9;
+
+// A planar buffer of arbitrary output variables, written by
+// RayTracer::TraceWithAOVs alongside the color. Every component of an AOV has
+// its own plane of floats, row by row, holding the mean over the samples of a
+// pixel, except for ShapeId and the costs. Samples that hit nothing count as 0.
+class LIBRAY_API AOVBuffer final
+{
+public:
+	AOVBuffer(Math::Vector2st const &size, std::vector<AOV> const &aovs);
+
+	Math::Vector2st const &Size() const;
+	std::vector<AOV> const &AOVs() const;
+
+	bool Has(AOV aov) const;
+
+	// nullptr when the buffer doesn't have aov.
+	Observer<float> Plane(AOV aov, std::size_t component);
+	Observer<float const> Plane(AOV aov, std::size_t component) const;
+
+	std::size_t MemorySize() const;
+
+	static std::size_t ComponentCount(AOV aov);
+
+	// Names as used on the command line and for the layers of EXR files.
+	static char const *Name(AOV aov);
+	static char const *ComponentName(AOV aov, std::size_t component);
+
+	// Whether aov is one of the costs of rendering a pixel.
+	static bool IsCost(AOV aov);
+
+private:
+	Math::Vector2st size;
+	std::vector<AOV> aovs;
+
+	// Index of the first plane of every AOV, indexed by AOV.
+	std::array<std::size_t, aovCount> firstPlane;
+	std::vector<std::vector<float>> planes;
+};
+
+static_assert(std::is_copy_constructible_v<AOVBuffer>);
+static_assert(std::is_copy_assignable_v<AOVBuffer>);
+static_assert(!std::is_trivially_copyable_v<AOVBuffer>);
+
+static_assert(std::is_move_constructible_v<AOVBuffer>);
+static_assert(std::is_move_assignable_v<AOVBuffer>);
+} // namespace LibRay
+
+#endif // eb675168_9c84_4c73_9622_72be8df3c4f0
@@ -0,0 +1,208 @@
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Math/MathUtils.hpp"
+#include "Math/Vector.hpp"
+#include "Scene.hpp"
+
+namespace LibRay
+{
+using namespace Math;
+
+void TransformTrack::AddKey(float frame, Transform const &transform)
+{
+	auto const it = std::lower_bound(
+		keys.begin(),
+		keys.end(),
+		frame,
+		[](Key const &key, float keyFrame)
+		{
+			return key.frame < keyFrame;
+		});
+
+	if(it != keys.end() && it->frame == frame)
+		it->transform = transform;
+	else
+		keys.insert(it, {frame, transform});
+}
+
+bool TransformTrack::IsEmpty() const
+{
+	return keys.empty();
+}
+
+Transform TransformTrack::At(float frame) const
+{
+	if(keys.empty())
+		throw std::logic_error("Transform track without keys");
+
+	auto const next = std::upper_bound(
+		keys.cbegin(),
+		keys.cend(),
+		frame,
+		[](float keyFrame, Key const &key)
+		{
+			return keyFrame < key.frame;
+		});
+
+	auto const calculated = [](Transform transform)
+	{
+		transform.RecalculateMatrix();
+		return transform;
+	};
+
+	if(next == keys.cbegin())
+		return calculated(keys.front().transform);
+
+	if(next == keys.cend())
+		return calculated(keys.back().transform);
+
+	Key const &a = *(next - 1);
+	Key const &b = *next;
+
+	float const t = (frame - a.frame) / (b.frame - a.frame);
+
+	// Euler angles instead of quaternions, so a key at 360 degrees turns all
+	// the way around.
+	return calculated(Transform(
+		glm::mix(a.transform.Position(), b.transform.Position(), t),
+		glm::mix(a.transform.Rotation(), b.transform.Rotation(), t),
+		glm::mix(a.transform.Scale(), b.transform.Scale(), t)));
+}
+
+Animation::Animation(std::size_t frameCount)
+: frameCount(frameCount)
+, camera()
+, shapes()
+{
+}
+
+Animation Animation::Load(std::string const &fileName)
+{
+	std::ifstream file(fileName);
+	if(!file)
+		throw std::runtime_error("Failed to open animation <" + fileName + ">");
+
+	Animation animation(0);
+	float lastFrame = -1.f;
+
+	std::string line;
+	for(std::size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		auto const fail = [&](std::string const &message)
+		{
+			throw std::runtime_error(
+				fileName + ":" + std::to_string(lineNumber) + ": " + message);
+		};
+
+		std::size_t const comment = line.find('#');
+		if(comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream stream(line);
+
+		std::string statement;
+		if(!(stream >> statement))
+			continue;
+
+		auto const readVector = [&]()
+		{
+			Vector3 vector(0);
+			if(!(stream >> vector.x >> vector.y >> vector.z))
+				fail("Expected three numbers in <" + statement + ">");
+
+			return vector;
+		};
+
+		auto const readKey = [&](TransformTrack &track, bool hasScale)
+		{
+			float frame = 0.f;
+			if(!(stream >> frame) || frame < 0.f)
+				fail("Expected a frame number in <" + statement + ">");
+
+			Vector3 const position = readVector();
+			Vector3 const rotation = readVector();
+			Vector3 const scale = hasScale ? readVector() : Vector3(1);
+
+			track.AddKey(
+				frame,
+				Transform(
+					position,
+					Vector3(
+						Radians(rotation.x),
+						Radians(rotation.y),
+						Radians(rotation.z)),
+					scale));
+
+			lastFrame = std::max(lastFrame, frame);
+		};
+
+		if(statement == "frames")
+		{
+			if(!(stream >> animation.frameCount) || animation.frameCount == 0)
+				fail("Expected a frame count above 0");
+		}
+		else if(statement == "camera")
+			readKey(animation.camera, false);
+		else if(statement == "shape")
+		{
+			std::size_t index = 0;
+			if(!(stream >> index))
+				fail("Expected a shape index");
+
+			readKey(animation.shapes[index], true);
+		}
+		else
+			fail("Unknown statement <" + statement + ">");
+
+		std::string rest;
+		if(stream >> rest)
+			fail("Unexpected <" + rest + "> after <" + statement + ">");
+	}
+
+	if(file.bad())
+		throw std::runtime_error("Failed to read animation <" + fileName + ">");
+
+	// Without a frame count, end at the last key.
+	if(animation.frameCount == 0)
+	{
+		if(lastFrame < 0.f)
+			throw std::runtime_error("Animation <" + fileName + "> has no frames");
+
+		animation.frameCount = std::size_t(std::floor(lastFrame)) + 1;
+	}
+
+	return animation;
+}
+
+void Animation::Apply(Scene &scene, std::size_t frame) const
+{
+	float const time = float(frame);
+
+	if(!camera.IsEmpty())
+		scene.UpdateCameraTransform(camera.At(time));
+
+	if(shapes.empty())
+		return;
+
+	for(auto const &[index, track]: shapes)
+	{
+		if(index >= scene.Shapes().size())
+		{
+			throw std::runtime_error(
+				"Animated shape " + std::to_string(index) + " doesn't exist, the "
+				"scene has " + std::to_string(scene.Shapes().size()) + " shapes");
+		}
+
+		scene.UpdateShapeTransform(index, track.At(time));
+	}
+
+	scene.RefitBoundingVolumeHierarchy();
+}
+} // namespace LibRay
@@ -0,0 +1,84 @@
+#ifndef bb0b8373_7807_4d31_a211_26b1ef034757
+#define bb0b8373_7807_4d31_a211_26b1ef034757
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "API.hpp"
+#include "Transform.hpp"
+
+namespace LibRay
+{
+class Scene;
+
+// Keyframes of a transform, interpolated linearly in between. Before the first
+// and after the last key the transform stays at that key.
+class LIBRAY_API TransformTrack final
+{
+public:
+	TransformTrack() = default;
+
+	// Replaces the key at frame, if there is one.
+	void AddKey(float frame, Transform const &transform);
+
+	bool IsEmpty() const;
+
+	// The transform at frame, with its matrix calculated.
+	Transform At(float frame) const;
+
+private:
+	struct Key
+	{
+		float frame;
+		Transform transform;
+	};
+
+	// Sorted by frame.
+	std::vector<Key> keys;
+};
+
+static_assert(std::is_copy_constructible_v<TransformTrack>);
+static_assert(std::is_copy_assignable_v<TransformTrack>);
+static_assert(!std::is_trivially_copyable_v<TransformTrack>);
+
+static_assert(std::is_move_constructible_v<TransformTrack>);
+static_assert(std::is_move_assignable_v<TransformTrack>);
+
+// A sequence of frames moving the camera and shapes of a scene.
+class LIBRAY_API Animation final
+{
+public:
+	explicit Animation(std::size_t frameCount);
+
+	// Reads an animation from a text file with a statement per line:
+	//   frames <count>
+	//   camera <frame> <position xyz> <rotation xyz>
+	//   shape <index> <frame> <position xyz> <rotation xyz> <scale xyz>
+	// Rotations are Euler angles in degrees, shape indices are positions in
+	// Scene::Shapes, and # starts a comment. Throws std::runtime_error when
+	// the file can't be read or has errors.
+	static Animation Load(std::string const &fileName);
+
+	// Moves the camera and shapes to frame and refits the bounding volume
+	// hierarchy. Throws std::runtime_error for shapes the scene doesn't have.
+	void Apply(Scene &scene, std::size_t frame) const;
+
+public:
+	std::size_t frameCount;
+
+	TransformTrack camera;
+	std::map<std::size_t, TransformTrack> shapes;
+};
+
+static_assert(std::is_copy_constructible_v<Animation>);
+static_assert(std::is_copy_assignable_v<Animation>);
+static_assert(!std::is_trivially_copyable_v<Animation>);
+
+static_assert(std::is_move_constructible_v<Animation>);
+static_assert(std::is_move_assignable_v<Animation>);
+} // namespace LibRay
+
+#endif // bb0b8373_7807_4d31_a211_26b1ef034757
@@ -57,8 +57,19 @@ Vector2st const &Camera::ScreenSize() const
 	return screenSize;
 }
 
+void Camera::UpdateScreenSize(Vector2st const &newSize)
+{
+	screenSize = newSize;
+}
+
 Transform const &Camera::Transform() const
 {
 	return transform;
 }
+
+void Camera::UpdateTransform(class Transform const &newTransform)
+{
+	transform = newTransform;
+	transform.RecalculateMatrix();
+}
 } // namespace LibRay
@@ -45,8 +45,10 @@ public:
 
 	Frustum SceneFrustum() const;
 	Math::Vector2st const &ScreenSize() const;
+	void UpdateScreenSize(Math::Vector2st const &newSize);
 
 	class Transform const &Transform() const;
+	void UpdateTransform(class Transform const &newTransform);
 
 private:
 	class Transform transform;
@@ -0,0 +1,197 @@
+#include "Checkpoint.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "Material/Color.hpp"
+
+namespace LibRay
+{
+using namespace Materials;
+
+// The file holds the header, a byte per tile telling whether it is finished,
+// and the RGB sums of the finished tiles row by row, in native byte order.
+constexpr char const magic[8] = {'L', 'R', 'A', 'Y', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t version = 1;
+
+struct CheckpointHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t padding;
+	std::uint64_t fingerprint;
+	std::uint64_t width;
+	std::uint64_t height;
+	std::uint64_t tileCount;
+};
+
+static_assert(std::is_trivially_copyable_v<CheckpointHeader>);
+
+using File = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+static File OpenFile(std::string const &fileName, char const *mode)
+{
+	return File(std::fopen(fileName.c_str(), mode), &std::fclose);
+}
+
+CheckpointConfiguration::CheckpointConfiguration(std::string const &fileName)
+: fileName(fileName)
+, interval(60)
+, resume(false)
+, stopRequested(nullptr)
+{
+}
+
+Checkpoint::Checkpoint(
+	std::uint64_t fingerprint,
+	Math::Vector2st const &imageSize,
+	std::vector<Threading::Tile> &&tiles)
+: fingerprint(fingerprint)
+, tiles(std::move(tiles))
+, completed(this->tiles.size(), false)
+, accumulation(imageSize.x, imageSize.y)
+{
+	accumulation.pixels.resize(imageSize.x * imageSize.y, Color::Black());
+}
+
+Checkpoint Checkpoint::Load(
+	std::string const &fileName,
+	std::uint64_t fingerprint,
+	Math::Vector2st const &imageSize,
+	std::vector<Threading::Tile> &&tiles)
+{
+	File const file = OpenFile(fileName, "rb");
+	if(!file)
+		throw std::runtime_error("Failed to open checkpoint <" + fileName + ">");
+
+	auto const read = [&](void *data, std::size_t size)
+	{
+		if(std::fread(data, 1, size, file.get()) != size)
+			throw std::runtime_error("Checkpoint <" + fileName + "> is truncated");
+	};
+
+	CheckpointHeader header;
+	read(&header, sizeof(header));
+
+	if(std::memcmp(header.magic, magic, sizeof(magic)) != 0
+		|| header.version != version)
+	{
+		throw std::runtime_error("<" + fileName + "> is not a checkpoint");
+	}
+
+	if(header.fingerprint != fingerprint)
+	{
+		throw std::runtime_error(
+			"Checkpoint <" + fileName + "> belongs to a different scene or configuration");
+	}
+
+	if(header.width != imageSize.x
+		|| header.height != imageSize.y
+		|| header.tileCount != tiles.size())
+	{
+		throw std::runtime_error(
+			"Checkpoint <" + fileName + "> has a different image size or tiling");
+	}
+
+	Checkpoint checkpoint(fingerprint, imageSize, std::move(tiles));
+
+	std::vector<std::uint8_t> completed(checkpoint.tiles.size());
+	read(completed.data(), completed.size());
+
+	for(std::size_t i = 0; i < checkpoint.tiles.size(); ++i)
+	{
+		if(completed[i] == 0)
+			continue;
+
+		Threading::Tile const &tile = checkpoint.tiles[i];
+		for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+		{
+			read(
+				&checkpoint.accumulation.pixels[y * imageSize.x + tile.x],
+				tile.width * sizeof(Color));
+		}
+
+		checkpoint.completed[i] = true;
+	}
+
+	return checkpoint;
+}
+
+void Checkpoint::Save(std::string const &fileName) const
+{
+	static_assert(sizeof(Color) == 3 * sizeof(float));
+
+	std::string const temporaryName = fileName + ".tmp";
+
+	{
+		File const file = OpenFile(temporaryName, "wb");
+		if(!file)
+		{
+			throw std::runtime_error(
+				"Failed to create checkpoint <" + temporaryName + ">");
+		}
+
+		auto const write = [&](void const *data, std::size_t size)
+		{
+			if(std::fwrite(data, 1, size, file.get()) != size)
+			{
+				throw std::runtime_error(
+					"Failed to write checkpoint <" + temporaryName + ">");
+			}
+		};
+
+		CheckpointHeader header;
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.padding = 0;
+		header.fingerprint = fingerprint;
+		header.width = accumulation.sizeX;
+		header.height = accumulation.sizeY;
+		header.tileCount = tiles.size();
+
+		write(&header, sizeof(header));
+
+		std::vector<std::uint8_t> completedBytes(completed.cbegin(), completed.cend());
+		write(completedBytes.data(), completedBytes.size());
+
+		for(std::size_t i = 0; i < tiles.size(); ++i)
+		{
+			if(!completed[i])
+				continue;
+
+			Threading::Tile const &tile = tiles[i];
+			for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+			{
+				write(
+					&accumulation.pixels[y * accumulation.sizeX + tile.x],
+					tile.width * sizeof(Color));
+			}
+		}
+
+		if(std::fflush(file.get()) != 0)
+		{
+			throw std::runtime_error(
+				"Failed to write checkpoint <" + temporaryName + ">");
+		}
+	}
+
+#ifdef _WIN32
+	// Unlike POSIX, rename doesn't replace existing files on Windows.
+	std::remove(fileName.c_str());
+#endif
+
+	if(std::rename(temporaryName.c_str(), fileName.c_str()) != 0)
+		throw std::runtime_error("Failed to replace checkpoint <" + fileName + ">");
+}
+
+std::size_t Checkpoint::CompletedTileCount() const
+{
+	std::size_t count = 0;
+	for(bool const tileCompleted: completed)
+		count += tileCompleted ? 1 : 0;
+
+	return count;
+}
+} // namespace LibRay
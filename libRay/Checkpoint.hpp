@@ -0,0 +1,86 @@
+#ifndef fa1767d1_90ee_44a4_bcc0_5fa6ad33c3a3
+#define fa1767d1_90ee_44a4_bcc0_5fa6ad33c3a3
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Math/Vector.hpp"
+#include "Threading/Tile.hpp"
+#include "API.hpp"
+#include "Image.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+struct LIBRAY_API CheckpointConfiguration final
+{
+	explicit CheckpointConfiguration(std::string const &fileName);
+
+	std::string fileName;
+
+	// Minimum time between saving finished tiles.
+	std::chrono::seconds interval;
+
+	// Keep the finished tiles in fileName, if it exists.
+	bool resume;
+
+	// Set from another thread or a signal handler to save and stop.
+	Observer<std::atomic_bool const> stopRequested;
+};
+
+static_assert(std::is_copy_constructible_v<CheckpointConfiguration>);
+static_assert(std::is_copy_assignable_v<CheckpointConfiguration>);
+static_assert(!std::is_trivially_copyable_v<CheckpointConfiguration>);
+
+static_assert(std::is_move_constructible_v<CheckpointConfiguration>);
+static_assert(std::is_move_assignable_v<CheckpointConfiguration>);
+
+// The finished tiles of a render. Only the pixels of finished tiles are
+// saved, unfinished tiles are rendered from scratch after resuming.
+class LIBRAY_API Checkpoint final
+{
+public:
+	// A checkpoint without any finished tiles.
+	Checkpoint(
+		std::uint64_t fingerprint,
+		Math::Vector2st const &imageSize,
+		std::vector<Threading::Tile> &&tiles);
+
+	// Throws std::runtime_error when the file can't be read, or was saved for
+	// a different fingerprint, image size, or tiling.
+	static Checkpoint Load(
+		std::string const &fileName,
+		std::uint64_t fingerprint,
+		Math::Vector2st const &imageSize,
+		std::vector<Threading::Tile> &&tiles);
+
+	// Writes to a temporary file that replaces fileName when complete, so a
+	// crash while saving keeps the previous checkpoint.
+	void Save(std::string const &fileName) const;
+
+	std::size_t CompletedTileCount() const;
+
+public:
+	std::uint64_t fingerprint;
+	std::vector<Threading::Tile> tiles;
+
+	// Whether every sample of a tile is in accumulation.
+	std::vector<bool> completed;
+
+	// The sum of the samples of every pixel.
+	Image accumulation;
+};
+
+static_assert(std::is_copy_constructible_v<Checkpoint>);
+static_assert(std::is_copy_assignable_v<Checkpoint>);
+static_assert(!std::is_trivially_copyable_v<Checkpoint>);
+
+static_assert(std::is_move_constructible_v<Checkpoint>);
+static_assert(std::is_move_assignable_v<Checkpoint>);
+} // namespace LibRay
+
+#endif // fa1767d1_90ee_44a4_bcc0_5fa6ad33c3a3
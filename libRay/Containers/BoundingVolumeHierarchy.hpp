@@ -27,6 +27,22 @@ namespace Containers
 {
 template<typename T> class BVH;
 
+// What a hierarchy allocated for its nodes and leaves.
+struct LIBRAY_API BVHMemory final
+{
+	std::size_t nodeCount = 0;
+	std::size_t nodeBytes = 0;
+	std::size_t leafCount = 0;
+	std::size_t leafBytes = 0;
+};
+
+static_assert(std::is_copy_constructible_v<BVHMemory>);
+static_assert(std::is_copy_assignable_v<BVHMemory>);
+static_assert(std::is_trivially_copyable_v<BVHMemory>);
+
+static_assert(std::is_move_constructible_v<BVHMemory>);
+static_assert(std::is_move_assignable_v<BVHMemory>);
+
 namespace BVHDetails
 {
 constexpr std::size_t const leafSize = 1;
@@ -46,6 +62,8 @@ public:
 
 	std::optional<Intersection> Traverse(Math::Ray const &ray) const;
 
+	ShapeVec<T> const &Leafs() const;
+
 private:
 	ShapeVec<T> leafs;
 };
@@ -72,6 +90,13 @@ public:
 	void SetChild1(std::unique_ptr<BVHNode> node);
 	void SetChild2(std::unique_ptr<BVHNode> node);
 
+	// Recalculates the bounding boxes of this node and its children from the
+	// current shapes, returns the minimum and maximum corner.
+	std::pair<Math::Vector3, Math::Vector3> Refit();
+
+	// Adds this node and everything below it to memory.
+	void AddMemory(BVHMemory &memory) const;
+
 private:
 	bool isLeaf;
 
@@ -109,6 +134,13 @@ public:
 
 	BoundingBox RootBoundingBox() const;
 
+	// Updates the bounding boxes after shapes moved, keeping the tree. Much
+	// faster than building a new hierarchy, but traversal gets slower when
+	// shapes move far from where the hierarchy was built.
+	void Refit();
+
+	BVHMemory Memory() const;
+
 private:
 	BoundingBox CalculateBoundingBox(BVHDetails::ShapeVec<T> const &objects) const;
 	BoundingBox CalculateBoundingBox(
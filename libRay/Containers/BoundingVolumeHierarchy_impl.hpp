@@ -10,10 +10,14 @@
 #include <cmath>
 #include <cstring>
 #include <numeric>
+#include <string>
 
 #include "../Math/MathUtils.hpp"
 #include "../Math/Vector.hpp"
 #include "../Intersection.hpp"
+#include "../PixelCost.hpp"
+#include "../Statistics.hpp"
+#include "../Timeline.hpp"
 #include "BoundingBox.hpp"
 
 namespace LibRay::Containers
@@ -27,6 +31,12 @@ template<typename T>
 BVH<T>::BVH(ShapeVec<T> &&objects)
 : rootNode()
 {
+	Timeline::Span const span(
+		"Build BVH",
+		Timeline::IsRecording()
+			? std::to_string(objects.size()) + " objects"
+			: std::string());
+
 	MakeNodes(std::move(objects));
 }
 
@@ -36,6 +46,8 @@ std::optional<Intersection> BVH<T>::Traverse(Ray const &ray) const
 	if(!rootNode)
 		return std::nullopt;
 
+	Instrumentation::CountBoxTests(1);
+
 	if(rootNode->Intersects(ray) >= 0.f)
 		return rootNode->Traverse(ray);
 
@@ -51,6 +63,24 @@ BoundingBox BVH<T>::RootBoundingBox() const
 	return *rootNode;
 }
 
+template<typename T>
+void BVH<T>::Refit()
+{
+	if(rootNode)
+		rootNode->Refit();
+}
+
+template<typename T>
+BVHMemory BVH<T>::Memory() const
+{
+	BVHMemory memory;
+
+	if(rootNode)
+		rootNode->AddMemory(memory);
+
+	return memory;
+}
+
 template<typename T>
 BoundingBox BVH<T>::CalculateBoundingBox(ShapeVec<T> const &objects) const
 {
@@ -316,6 +346,9 @@ BVHNode<T>::~BVHNode() noexcept
 template<typename T>
 std::optional<Intersection> BVHNode<T>::Traverse(Ray const &ray) const
 {
+	if(Observer<PixelCost> const cost = currentPixelCost)
+		++cost->nodeVisits;
+
 	if(isLeaf)
 	{
 		assert(child1.leaf);
@@ -333,6 +366,8 @@ std::optional<Intersection> BVHNode<T>::Traverse(Ray const &ray) const
 	// from the other child and return the nearest one.
 	if(child1.node && child2)
 	{
+		Instrumentation::CountBoxTests(2);
+
 		float const boundingBoxDistance1 = child1.node->Intersects(ray);
 		float const boundingBoxDistance2 = child2->Intersects(ray);
 
@@ -419,12 +454,16 @@ std::optional<Intersection> BVHNode<T>::Traverse(Ray const &ray) const
 
 	if(child1.node)
 	{
+		Instrumentation::CountBoxTests(1);
+
 		if(child1.node->Intersects(ray) >= 0.f)
 			return child1.node->Traverse(ray);
 	}
 
 	if(child2)
 	{
+		Instrumentation::CountBoxTests(1);
+
 		if(child2->Intersects(ray) >= 0.f)
 			return child2->Traverse(ray);
 	}
@@ -483,6 +522,76 @@ void BVHNode<T>::SetChild2(std::unique_ptr<BVHNode<T>> node)
 	child2 = std::move(node);
 }
 
+template<typename T>
+std::pair<Vector3, Vector3> BVHNode<T>::Refit()
+{
+	// Same as BVH::CalculateBoundingBox, so a refit of a scene that didn't
+	// change gives the exact same boxes.
+	Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	if(isLeaf)
+	{
+		assert(child1.leaf);
+
+		for(Observer<Shapes::BaseShape<T> const> const &object: child1.leaf->Leafs())
+		{
+			BoundingBox const boundingBox = object->CalculateBoundingBox();
+
+			Vector3 const &halfBoundaries = boundingBox.HalfBoundaries();
+
+			min = glm::min(min, boundingBox.Position() - halfBoundaries);
+			max = glm::max(max, boundingBox.Position() + halfBoundaries);
+		}
+	}
+	else
+	{
+		std::array<Observer<BVHNode>, 2> const children{
+			child1.node.get(),
+			child2.get()};
+
+		for(Observer<BVHNode> const child: children)
+		{
+			if(!child)
+				continue;
+
+			std::pair<Vector3, Vector3> const childBounds = child->Refit();
+
+			min = glm::min(min, childBounds.first);
+			max = glm::max(max, childBounds.second);
+		}
+	}
+
+	static_cast<BoundingBox &>(*this) =
+		BoundingBox((max - min) * 0.5f, (max + min) * 0.5f);
+
+	return {min, max};
+}
+
+template<typename T>
+void BVHNode<T>::AddMemory(BVHMemory &memory) const
+{
+	++memory.nodeCount;
+	memory.nodeBytes += sizeof(BVHNode);
+
+	if(isLeaf)
+	{
+		assert(child1.leaf);
+
+		++memory.leafCount;
+		memory.leafBytes += sizeof(BVHLeaf<T>)
+			+ child1.leaf->Leafs().capacity() * sizeof(child1.leaf->Leafs()[0]);
+
+		return;
+	}
+
+	if(child1.node)
+		child1.node->AddMemory(memory);
+
+	if(child2)
+		child2->AddMemory(memory);
+}
+
 template<typename T>
 BVHLeaf<T>::BVHLeaf(ShapeVec<T> &&leafs)
 : leafs(std::move(leafs))
@@ -495,8 +604,13 @@ std::optional<Intersection> BVHLeaf<T>::Traverse(Ray const &ray) const
 	std::optional<Intersection> closestIntersection;
 	float closestDistance = 0;
 
+	Observer<PixelCost> const cost = currentPixelCost;
+
 	for(typename ShapeVec<T>::value_type const &leaf: leafs)
 	{
+		if(cost)
+			++cost->primitiveTests;
+
 		std::optional<Intersection> intersection = leaf->Intersects(ray);
 
 		if(!intersection)
@@ -523,6 +637,12 @@ std::optional<Intersection> BVHLeaf<T>::Traverse(Ray const &ray) const
 
 	return closestIntersection;
 }
+
+template<typename T>
+ShapeVec<T> const &BVHLeaf<T>::Leafs() const
+{
+	return leafs;
+}
 } // namespace BVHDetails
 } // namespace LibRay::Containers
 
@@ -0,0 +1,149 @@
+#include "LightTree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "../Material/Color.hpp"
+#include "../Light.hpp"
+
+namespace LibRay::Containers
+{
+using namespace Math;
+
+constexpr std::size_t const leafSize = 4;
+
+LightTree::LightTree(std::vector<Light> const &lights, float cutoff)
+: entries()
+, nodes()
+{
+	entries.reserve(lights.size());
+
+	for(Light const &light: lights)
+	{
+		float const radius = InfluenceRadius(light, cutoff);
+
+		// Lights without intensity never add anything.
+		if(radius > 0.f)
+			entries.push_back({&light, radius * radius});
+	}
+
+	if(!entries.empty())
+	{
+		nodes.reserve(2 * entries.size() / leafSize + 1);
+		Build(0, entries.size());
+	}
+}
+
+void LightTree::LightsAt(
+	Vector3 const &position,
+	std::vector<Observer<Light const>> &lights) const
+{
+	lights.clear();
+
+	if(nodes.empty())
+		return;
+
+	// Deep enough for any tree of 2^32 lights.
+	std::array<std::uint32_t, 64> stack;
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while(stackSize > 0)
+	{
+		Node const &node = nodes[stack[--stackSize]];
+
+		if(position.x < node.min.x || position.x > node.max.x
+			|| position.y < node.min.y || position.y > node.max.y
+			|| position.z < node.min.z || position.z > node.max.z)
+		{
+			continue;
+		}
+
+		if(node.count == 0)
+		{
+			std::uint32_t const firstChild =
+				std::uint32_t(std::distance(nodes.data(), &node)) + 1;
+
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = firstChild;
+			continue;
+		}
+
+		for(std::uint32_t i = node.first; i < node.first + node.count; ++i)
+		{
+			Entry const &entry = entries[i];
+			if(glm::length2(position - entry.light->Position()) <= entry.radiusSquared)
+				lights.push_back(entry.light);
+		}
+	}
+}
+
+float LightTree::InfluenceRadius(Light const &light, float cutoff)
+{
+	Materials::Color const &color = light.Color();
+	float const brightness =
+		light.Intensity() * std::max(color.r, std::max(color.g, color.b));
+
+	if(brightness <= 0.f)
+		return 0.f;
+
+	if(cutoff <= 0.f)
+		return std::numeric_limits<float>::infinity();
+
+	return std::sqrt(brightness / cutoff);
+}
+
+std::uint32_t LightTree::Build(std::size_t first, std::size_t last)
+{
+	Vector3 min(std::numeric_limits<float>::infinity());
+	Vector3 max(-std::numeric_limits<float>::infinity());
+	Vector3 centerMin = min;
+	Vector3 centerMax = max;
+
+	for(std::size_t i = first; i < last; ++i)
+	{
+		Vector3 const &position = entries[i].light->Position();
+		Vector3 const radius(std::sqrt(entries[i].radiusSquared));
+
+		min = glm::min(min, position - radius);
+		max = glm::max(max, position + radius);
+		centerMin = glm::min(centerMin, position);
+		centerMax = glm::max(centerMax, position);
+	}
+
+	std::uint32_t const index = std::uint32_t(nodes.size());
+	nodes.push_back({min, max, std::uint32_t(first), 0, 0});
+
+	if(last - first <= leafSize)
+	{
+		nodes[index].count = std::uint32_t(last - first);
+		return index;
+	}
+
+	// Split the light positions in half along their widest axis.
+	Vector3 const extent = centerMax - centerMin;
+	int const axis = extent.x >= extent.y && extent.x >= extent.z
+		? 0
+		: extent.y >= extent.z ? 1 : 2;
+
+	std::size_t const middle = first + (last - first) / 2;
+
+	std::nth_element(
+		entries.begin() + std::ptrdiff_t(first),
+		entries.begin() + std::ptrdiff_t(middle),
+		entries.begin() + std::ptrdiff_t(last),
+		[axis](Entry const &a, Entry const &b)
+		{
+			return a.light->Position()[axis] < b.light->Position()[axis];
+		});
+
+	Build(first, middle);
+	std::uint32_t const secondChild = Build(middle, last);
+
+	nodes[index].secondChild = secondChild;
+
+	return index;
+}
+} // namespace LibRay::Containers
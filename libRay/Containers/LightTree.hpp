@@ -0,0 +1,71 @@
+#ifndef dd870d0e_2257_4eed_b61e_c8a593212e25
+#define dd870d0e_2257_4eed_b61e_c8a593212e25
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+#include "../Utilites.hpp"
+
+namespace LibRay
+{
+class Light;
+
+namespace Containers
+{
+// A bounding volume hierarchy over the spheres of influence of point lights.
+// Outside its sphere a light adds less than the cutoff to any color channel,
+// so shading only has to consider the lights found at its position.
+class LIBRAY_API LightTree final
+{
+public:
+	// A cutoff of 0 keeps every light with an intensity everywhere.
+	LightTree(std::vector<Light> const &lights, float cutoff);
+
+	// Fills lights with the lights that can reach position.
+	void LightsAt(
+		Math::Vector3 const &position,
+		std::vector<Observer<Light const>> &lights) const;
+
+	// The distance where the light drops below cutoff, Intensity() / r²
+	// times the brightest channel of its color.
+	static float InfluenceRadius(Light const &light, float cutoff);
+
+private:
+	struct Entry
+	{
+		Observer<Light const> light;
+		float radiusSquared;
+	};
+
+	// Leaves hold count entries from first on, inner nodes have their first
+	// child right after them and the second one at secondChild.
+	struct Node
+	{
+		Math::Vector3 min;
+		Math::Vector3 max;
+		std::uint32_t first;
+		std::uint32_t count;
+		std::uint32_t secondChild;
+	};
+
+	// Builds the subtree of entries [first, last), returns its node index.
+	std::uint32_t Build(std::size_t first, std::size_t last);
+
+private:
+	std::vector<Entry> entries;
+	std::vector<Node> nodes;
+};
+
+static_assert(std::is_copy_constructible_v<LightTree>);
+static_assert(std::is_copy_assignable_v<LightTree>);
+static_assert(!std::is_trivially_copyable_v<LightTree>);
+
+static_assert(std::is_move_constructible_v<LightTree>);
+static_assert(std::is_move_assignable_v<LightTree>);
+} // namespace Containers
+} // namespace LibRay
+
+#endif // dd870d0e_2257_4eed_b61e_c8a593212e25
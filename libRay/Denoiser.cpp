@@ -0,0 +1,237 @@
+#include "Denoiser.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Material/Color.hpp"
+#include "Math/Vector.hpp"
+#include "Threading/Tile.hpp"
+
+namespace LibRay
+{
+using namespace Math;
+
+// The B3 spline of the À-trous wavelet.
+constexpr std::array<float, 5> const kernel =
+	{1.f / 16.f, 1.f / 4.f, 3.f / 8.f, 1.f / 4.f, 1.f / 16.f};
+
+static Vector3 Compress(Vector3 const &color)
+{
+	return color / (Vector3(1) + color);
+}
+
+// Channels too dark to divide the lighting by are filtered as they are.
+static float Divisor(float albedo)
+{
+	return albedo > 0.01f ? albedo : 1.f;
+}
+
+DenoiserConfiguration::DenoiserConfiguration()
+: iterations(3)
+, colorSigma(0.15f)
+, normalSigma(0.3f)
+, albedoSigma(0.1f)
+, depthSigma(1.f)
+, tileSize(64)
+{
+}
+
+Denoiser::Denoiser(
+	DenoiserConfiguration const &config,
+	std::shared_ptr<Threading::TaskProcessor> taskProcessor)
+: configuration(config)
+, taskProcessor(std::move(taskProcessor))
+{
+}
+
+std::vector<AOV> Denoiser::Features()
+{
+	return {AOV::Depth, AOV::Normal, AOV::Albedo};
+}
+
+Image Denoiser::Denoise(Image const &image, AOVBuffer const &features) const
+{
+	Vector2st const size(image.sizeX, image.sizeY);
+
+	if(features.Size() != size)
+		throw std::invalid_argument("The AOV buffer isn't the size of the image");
+
+	for(AOV const aov: Features())
+	{
+		if(!features.Has(aov))
+		{
+			throw std::invalid_argument(
+				std::string("The denoiser needs the ") + AOVBuffer::Name(aov) + " AOV");
+		}
+	}
+
+	std::size_t const pixelCount = size.x * size.y;
+
+	Observer<float const> const depths = features.Plane(AOV::Depth, 0);
+
+	auto const normalAt = [&features](std::size_t index)
+	{
+		return Vector3(
+			features.Plane(AOV::Normal, 0)[index],
+			features.Plane(AOV::Normal, 1)[index],
+			features.Plane(AOV::Normal, 2)[index]);
+	};
+
+	auto const albedoAt = [&features](std::size_t index)
+	{
+		return Vector3(
+			features.Plane(AOV::Albedo, 0)[index],
+			features.Plane(AOV::Albedo, 1)[index],
+			features.Plane(AOV::Albedo, 2)[index]);
+	};
+
+	std::vector<Threading::Tile> const tiles = Threading::MakeTiles(
+		size,
+		configuration.tileSize,
+		Threading::TileOrder::Scanline);
+
+	// What the lighting is divided by, and multiplied by after filtering.
+	std::vector<Vector3> albedo(pixelCount);
+	std::vector<Vector3> normals(pixelCount);
+	std::vector<Vector2> depthGradients(pixelCount);
+
+	std::vector<Vector3> current(pixelCount);
+	std::vector<Vector3> next(pixelCount);
+
+	// Compressed copies of current and next, for comparing colors.
+	std::vector<Vector3> currentCompressed(pixelCount);
+	std::vector<Vector3> nextCompressed(pixelCount);
+
+	auto const depthAt = [&](std::size_t x, std::size_t y)
+	{
+		return depths[std::min(y, size.y - 1) * size.x + std::min(x, size.x - 1)];
+	};
+
+	taskProcessor->ParallelFor(tiles.size(), [&](std::size_t tileIndex)
+	{
+		Threading::Tile const &tile = tiles[tileIndex];
+
+		for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+		{
+			for(std::size_t x = tile.x; x < tile.x + tile.width; ++x)
+			{
+				std::size_t const index = y * size.x + x;
+
+				Vector3 const surfaceAlbedo = albedoAt(index);
+				albedo[index] = Vector3(
+					Divisor(surfaceAlbedo.x),
+					Divisor(surfaceAlbedo.y),
+					Divisor(surfaceAlbedo.z));
+
+				normals[index] = normalAt(index);
+
+				depthGradients[index] = 0.5f * Vector2(
+					depthAt(x + 1, y) - depthAt(x > 0 ? x - 1 : 0, y),
+					depthAt(x, y + 1) - depthAt(x, y > 0 ? y - 1 : 0));
+
+				current[index] = Vector3(image.pixels[index]) / albedo[index];
+				currentCompressed[index] = Compress(current[index]);
+			}
+		}
+	});
+
+	float colorSigma = configuration.colorSigma;
+
+	float const inverseNormalVariance =
+		1.f / (configuration.normalSigma * configuration.normalSigma);
+	float const inverseAlbedoVariance =
+		1.f / (configuration.albedoSigma * configuration.albedoSigma);
+
+	for(std::uint32_t iteration = 0; iteration < configuration.iterations; ++iteration)
+	{
+		std::ptrdiff_t const step = std::ptrdiff_t(1) << iteration;
+		float const inverseColorVariance = 1.f / (colorSigma * colorSigma);
+
+		taskProcessor->ParallelFor(tiles.size(), [&](std::size_t tileIndex)
+		{
+			Threading::Tile const &tile = tiles[tileIndex];
+
+			for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+			{
+				for(std::size_t x = tile.x; x < tile.x + tile.width; ++x)
+				{
+					std::size_t const index = y * size.x + x;
+
+					Vector3 const &color = currentCompressed[index];
+					Vector3 const &normal = normals[index];
+					Vector3 const &surfaceAlbedo = albedo[index];
+					float const depth = depths[index];
+					Vector2 const &depthGradient = depthGradients[index];
+
+					Vector3 sum(0);
+					float weightSum = 0.f;
+
+					for(std::ptrdiff_t j = -2; j <= 2; ++j)
+					{
+						std::ptrdiff_t const qy = std::ptrdiff_t(y) + j * step;
+						if(qy < 0 || qy >= std::ptrdiff_t(size.y))
+							continue;
+
+						for(std::ptrdiff_t i = -2; i <= 2; ++i)
+						{
+							std::ptrdiff_t const qx = std::ptrdiff_t(x) + i * step;
+							if(qx < 0 || qx >= std::ptrdiff_t(size.x))
+								continue;
+
+							std::size_t const neighbour =
+								std::size_t(qy) * size.x + std::size_t(qx);
+
+							// How far the depth should be off on a flat surface.
+							float const expectedDepthChange =
+								std::abs(depthGradient.x * float(i * step))
+								+ std::abs(depthGradient.y * float(j * step));
+
+							float const depthDistance =
+								std::abs(depth - depths[neighbour])
+								/ (configuration.depthSigma * expectedDepthChange
+									+ 0.001f * depth
+									+ 1e-6f);
+
+							float const exponent =
+								glm::length2(currentCompressed[neighbour] - color)
+									* inverseColorVariance
+								+ glm::length2(normals[neighbour] - normal)
+									* inverseNormalVariance
+								+ glm::length2(albedo[neighbour] - surfaceAlbedo)
+									* inverseAlbedoVariance
+								+ depthDistance;
+
+							float const weight = kernel[std::size_t(i + 2)]
+								* kernel[std::size_t(j + 2)]
+								* std::exp(-exponent);
+
+							sum += current[neighbour] * weight;
+							weightSum += weight;
+						}
+					}
+
+					// The center always adds itself, so weightSum is above 0.
+					next[index] = sum / weightSum;
+					nextCompressed[index] = Compress(next[index]);
+				}
+			}
+		});
+
+		std::swap(current, next);
+		std::swap(currentCompressed, nextCompressed);
+		colorSigma *= 0.5f;
+	}
+
+	Image output(image.sizeX, image.sizeY);
+	output.pixels.reserve(pixelCount);
+
+	for(std::size_t i = 0; i < pixelCount; ++i)
+		output.pixels.emplace_back(current[i] * albedo[i]);
+
+	return output;
+}
+} // namespace LibRay
@@ -0,0 +1,77 @@
+#ifndef bb68a6c6_2334_41df_93bf_efe37bb8c0d1
+#define bb68a6c6_2334_41df_93bf_efe37bb8c0d1
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "Threading/TaskProcessor.hpp"
+#include "AOVBuffer.hpp"
+#include "API.hpp"
+#include "Image.hpp"
+
+namespace LibRay
+{
+struct LIBRAY_API DenoiserConfiguration final
+{
+	DenoiserConfiguration();
+
+	// Every pass doubles the distance between the filter taps, 3 passes
+	// reach 14 pixels away.
+	std::uint32_t iterations;
+
+	// How different neighbours may be before they stop being averaged in,
+	// larger values blur more. Colors are compared after compressing them to
+	// [0, 1), the color width halves every pass.
+	float colorSigma;
+	float normalSigma;
+	float albedoSigma;
+
+	// Relative to how fast the depth changes around a pixel, so slanted
+	// surfaces aren't mistaken for edges.
+	float depthSigma;
+
+	std::uint32_t tileSize;
+};
+
+static_assert(std::is_copy_constructible_v<DenoiserConfiguration>);
+static_assert(std::is_copy_assignable_v<DenoiserConfiguration>);
+static_assert(std::is_trivially_copyable_v<DenoiserConfiguration>);
+
+static_assert(std::is_move_constructible_v<DenoiserConfiguration>);
+static_assert(std::is_move_assignable_v<DenoiserConfiguration>);
+
+// An edge-avoiding À-trous wavelet filter (Dammertz et al. 2010), guided by
+// the depth, normal, and albedo of the primary hits. The lighting is divided
+// by the albedo before filtering and multiplied back after, so textures stay
+// sharp while the noise in the lighting is averaged out.
+class LIBRAY_API Denoiser final
+{
+public:
+	// Runs the passes on the workers of taskProcessor, a tile per task.
+	Denoiser(
+		DenoiserConfiguration const &config,
+		std::shared_ptr<Threading::TaskProcessor> taskProcessor);
+
+	// The AOVs Denoise needs, to pass to RayTracer::TraceWithAOVs.
+	static std::vector<AOV> Features();
+
+	// Throws std::invalid_argument when features misses one of Features(), or
+	// isn't the size of image.
+	Image Denoise(Image const &image, AOVBuffer const &features) const;
+
+private:
+	DenoiserConfiguration configuration;
+	std::shared_ptr<Threading::TaskProcessor> taskProcessor;
+};
+
+static_assert(std::is_copy_constructible_v<Denoiser>);
+static_assert(std::is_copy_assignable_v<Denoiser>);
+static_assert(!std::is_trivially_copyable_v<Denoiser>);
+
+static_assert(std::is_move_constructible_v<Denoiser>);
+static_assert(std::is_move_assignable_v<Denoiser>);
+} // namespace LibRay
+
+#endif // bb68a6c6_2334_41df_93bf_efe37bb8c0d1
@@ -0,0 +1,397 @@
+#include "Coordinator.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <numeric>
+#include <stdexcept>
+
+#include "../Material/Color.hpp"
+#include "../Image.hpp"
+#include "Protocol.hpp"
+
+namespace LibRay::Distributed
+{
+using namespace Materials;
+using Clock = std::chrono::steady_clock;
+
+// A worker that stops halfway through a message is given up on after this.
+constexpr std::chrono::seconds messageTimeout(30);
+constexpr std::chrono::milliseconds pollInterval(100);
+
+CoordinatorConfiguration::CoordinatorConfiguration(
+	std::uint16_t port,
+	std::uint32_t samplesPerPixel)
+: port(port)
+, samplesPerPixel(std::max(samplesPerPixel, 1u))
+, tileSize(32)
+, tileOrder(Threading::TileOrder::Hilbert)
+, workerTimeout(120)
+, fingerprint()
+{
+}
+
+Coordinator::Coordinator(
+	Math::Vector2st const &imageSize,
+	CoordinatorConfiguration const &configuration)
+: imageSize(imageSize)
+, configuration(configuration)
+, listener(Socket::Listen(configuration.port))
+, fingerprint(configuration.fingerprint)
+, frame(0)
+, workers()
+{
+}
+
+Coordinator::~Coordinator() noexcept
+{
+	for(Worker &worker: workers)
+	{
+		try
+		{
+			MessageWriter(MessageType::Shutdown).Send(worker.socket);
+		}
+		catch(std::exception const &)
+		{
+		}
+	}
+}
+
+Image Coordinator::Render()
+{
+	++frame;
+
+	std::vector<Threading::Tile> const tiles = Threading::MakeTiles(
+		imageSize,
+		configuration.tileSize,
+		configuration.tileOrder);
+
+	std::vector<bool> done(tiles.size(), false);
+	// How many workers have a copy of every tile.
+	std::vector<std::uint32_t> copies(tiles.size(), 0);
+	std::vector<Clock::time_point> sentAt(tiles.size());
+
+	std::deque<std::size_t> queue(tiles.size());
+	std::iota(queue.begin(), queue.end(), std::size_t(0));
+
+	std::size_t completed = 0;
+	std::size_t reportedTenth = 0;
+
+	Image image(imageSize.x, imageSize.y);
+	image.pixels.resize(imageSize.x * imageSize.y, Color::Black());
+
+	for(Worker &worker: workers)
+		worker.tiles.clear();
+
+	if(workers.empty())
+	{
+		std::printf("Waiting for workers on port %u\n", configuration.port);
+		std::fflush(stdout);
+	}
+
+	auto const drop = [&](Worker &worker, char const *reason)
+	{
+		std::fprintf(
+			stderr,
+			"Dropping worker %s (%s), requeueing %zu tiles\n",
+			worker.name.c_str(),
+			reason,
+			worker.tiles.size());
+
+		for(std::size_t const id: worker.tiles)
+		{
+			--copies[id];
+			if(!done[id] && copies[id] == 0)
+				queue.push_front(id);
+		}
+
+		worker.tiles.clear();
+		worker.socket.Close();
+	};
+
+	auto const assign = [&](Worker &worker, std::vector<std::size_t> const &ids)
+	{
+		MessageWriter message(MessageType::Assign);
+		message.Write(frame);
+		message.Write(std::uint32_t(0));
+		message.Write(configuration.samplesPerPixel);
+		message.Write(std::uint32_t(ids.size()));
+
+		for(std::size_t const id: ids)
+		{
+			Threading::Tile const &tile = tiles[id];
+
+			message.Write(std::uint64_t(id));
+			message.Write(std::uint64_t(tile.x));
+			message.Write(std::uint64_t(tile.y));
+			message.Write(std::uint64_t(tile.width));
+			message.Write(std::uint64_t(tile.height));
+		}
+
+		message.Send(worker.socket);
+
+		Clock::time_point const now = Clock::now();
+
+		// An idle worker has nothing to report, start its timeout now.
+		if(worker.tiles.empty())
+			worker.lastHeard = now;
+
+		for(std::size_t const id: ids)
+		{
+			worker.tiles.push_back(id);
+			++copies[id];
+			sentAt[id] = now;
+		}
+	};
+
+	auto const handle = [&](Worker &worker, MessageReader &message)
+	{
+		worker.lastHeard = Clock::now();
+
+		switch(message.Type())
+		{
+		case MessageType::Hello:
+		{
+			std::uint32_t const version = message.ReadUInt32();
+
+			// The rest of the layout might differ between versions.
+			if(version != protocolVersion)
+			{
+				drop(worker, "different protocol version");
+				break;
+			}
+
+			std::uint64_t const workerFingerprint = message.ReadUInt64();
+			std::uint32_t const threadCount = message.ReadUInt32();
+			std::uint64_t const width = message.ReadUInt64();
+			std::uint64_t const height = message.ReadUInt64();
+
+			if(width != imageSize.x || height != imageSize.y)
+				drop(worker, "different image size");
+			else if(fingerprint && workerFingerprint != *fingerprint)
+				drop(worker, "different scene or render settings");
+			else
+			{
+				if(!fingerprint)
+				{
+					fingerprint = workerFingerprint;
+
+					std::printf(
+						"Rendering with fingerprint %016" PRIx64 " of worker %s\n",
+						workerFingerprint,
+						worker.name.c_str());
+				}
+
+				worker.greeted = true;
+				worker.threadCount = std::max(threadCount, 1u);
+
+				std::printf(
+					"Worker %s joined with %u threads\n",
+					worker.name.c_str(),
+					worker.threadCount);
+				std::fflush(stdout);
+			}
+		} break;
+		case MessageType::TileResult:
+		{
+			std::uint32_t const resultFrame = message.ReadUInt32();
+			std::uint64_t const id = message.ReadUInt64();
+			Threading::Tile tile;
+			tile.x = std::size_t(message.ReadUInt64());
+			tile.y = std::size_t(message.ReadUInt64());
+			tile.width = std::size_t(message.ReadUInt64());
+			tile.height = std::size_t(message.ReadUInt64());
+
+			if(resultFrame != frame)
+				break;
+
+			if(id >= tiles.size()
+				|| tiles[id].x != tile.x
+				|| tiles[id].y != tile.y
+				|| tiles[id].width != tile.width
+				|| tiles[id].height != tile.height)
+			{
+				throw std::runtime_error("Result for an unknown tile");
+			}
+
+			auto const held = std::find(worker.tiles.begin(), worker.tiles.end(), id);
+			if(held != worker.tiles.end())
+			{
+				worker.tiles.erase(held);
+				--copies[id];
+			}
+
+			if(done[id])
+				break;
+
+			for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+			{
+				for(std::size_t x = tile.x; x < tile.x + tile.width; ++x)
+				{
+					Color &pixel = image.pixels[y * imageSize.x + x];
+					pixel.r = message.ReadFloat();
+					pixel.g = message.ReadFloat();
+					pixel.b = message.ReadFloat();
+				}
+			}
+
+			done[id] = true;
+			++completed;
+		} break;
+		case MessageType::Assign:
+		case MessageType::Shutdown:
+		{
+			throw std::runtime_error("Unexpected message from worker");
+		}
+		}
+	};
+
+	auto const feed = [&](Worker &worker)
+	{
+		// Keep a second batch queued on the worker while it renders the first.
+		if(!worker.greeted || worker.tiles.size() > worker.threadCount)
+			return;
+
+		std::vector<std::size_t> batch;
+
+		while(!queue.empty() && batch.size() < worker.threadCount)
+		{
+			std::size_t const id = queue.front();
+			queue.pop_front();
+
+			if(!done[id])
+				batch.push_back(id);
+		}
+
+		// Nothing left to hand out, race the oldest tile of another worker.
+		if(batch.empty() && worker.tiles.empty())
+		{
+			std::optional<std::size_t> oldest;
+
+			for(std::size_t id = 0; id < tiles.size(); ++id)
+			{
+				if(done[id] || copies[id] != 1)
+					continue;
+
+				if(!oldest || sentAt[id] < sentAt[*oldest])
+					oldest = id;
+			}
+
+			if(oldest)
+				batch.push_back(*oldest);
+		}
+
+		if(!batch.empty())
+			assign(worker, batch);
+	};
+
+	while(completed < tiles.size())
+	{
+		std::vector<Observer<Socket const>> sockets;
+		sockets.reserve(workers.size() + 1);
+		sockets.push_back(&listener);
+
+		for(Worker const &worker: workers)
+			sockets.push_back(&worker.socket);
+
+		for(std::size_t const index: Socket::WaitReadable(sockets, pollInterval))
+		{
+			if(index == 0)
+			{
+				Worker worker;
+				worker.socket = listener.Accept();
+				worker.socket.SetNonBlocking();
+				worker.name = worker.socket.PeerName();
+				worker.lastHeard = Clock::now();
+				worker.lastReceived = worker.lastHeard;
+
+				workers.push_back(std::move(worker));
+				continue;
+			}
+
+			Worker &worker = workers[index - 1];
+
+			try
+			{
+				bool const open = worker.incoming.ReceiveAvailable(worker.socket);
+				worker.lastReceived = Clock::now();
+
+				// Handling a message can drop the worker.
+				while(worker.socket.IsValid())
+				{
+					std::optional<MessageReader> message = worker.incoming.NextMessage();
+					if(!message)
+						break;
+
+					handle(worker, *message);
+				}
+
+				if(!open && worker.socket.IsValid())
+					drop(worker, "disconnected");
+			}
+			catch(std::exception const &e)
+			{
+				drop(worker, e.what());
+			}
+		}
+
+		Clock::time_point const now = Clock::now();
+
+		for(Worker &worker: workers)
+		{
+			if(!worker.socket.IsValid())
+				continue;
+
+			if(!worker.tiles.empty()
+				&& now - worker.lastHeard > configuration.workerTimeout)
+			{
+				drop(worker, "timed out");
+				continue;
+			}
+
+			if(worker.incoming.HasPartialMessage()
+				&& now - worker.lastReceived > messageTimeout)
+			{
+				drop(worker, "stopped halfway through a message");
+				continue;
+			}
+
+			try
+			{
+				feed(worker);
+			}
+			catch(std::exception const &e)
+			{
+				drop(worker, e.what());
+			}
+		}
+
+		workers.erase(
+			std::remove_if(
+				workers.begin(),
+				workers.end(),
+				[](Worker const &worker)
+				{
+					return !worker.socket.IsValid();
+				}),
+			workers.end());
+
+		std::size_t const tenth = completed * 10 / tiles.size();
+		if(tenth > reportedTenth)
+		{
+			reportedTenth = tenth;
+
+			std::printf(
+				"Rendered %zu of %zu tiles on %zu workers\n",
+				completed,
+				tiles.size(),
+				workers.size());
+			std::fflush(stdout);
+		}
+	}
+
+	return image;
+}
+} // namespace LibRay::Distributed
@@ -0,0 +1,118 @@
+#ifndef eaf2b25a_1609_4b3f_a9b0_0e6ccfd55a5b
+#define eaf2b25a_1609_4b3f_a9b0_0e6ccfd55a5b
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Math/Vector.hpp"
+#include "../Threading/Tile.hpp"
+#include "../API.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+
+namespace LibRay
+{
+class Image;
+
+namespace Distributed
+{
+struct LIBRAY_API CoordinatorConfiguration final
+{
+	CoordinatorConfiguration(std::uint16_t port, std::uint32_t samplesPerPixel);
+
+	std::uint16_t port;
+	std::uint32_t samplesPerPixel;
+
+	std::uint32_t tileSize;
+	Threading::TileOrder tileOrder;
+
+	// A worker with tiles that hasn't sent anything for this long is dropped,
+	// and its tiles are handed to other workers.
+	std::chrono::seconds workerTimeout;
+
+	// The RayTracer::Fingerprint every worker has to render with. Without it,
+	// the fingerprint of the first worker to join is used.
+	std::optional<std::uint64_t> fingerprint;
+};
+
+static_assert(std::is_copy_constructible_v<CoordinatorConfiguration>);
+static_assert(std::is_copy_assignable_v<CoordinatorConfiguration>);
+static_assert(std::is_trivially_copyable_v<CoordinatorConfiguration>);
+
+static_assert(std::is_move_constructible_v<CoordinatorConfiguration>);
+static_assert(std::is_move_assignable_v<CoordinatorConfiguration>);
+
+// Hands out tiles of a frame to worker processes, which connect over TCP.
+// Every worker gets twice as many tiles as it has threads, so the next batch
+// is already waiting when one is done. Tiles of workers that disconnect or
+// time out go back in the queue. Once the queue is empty, idle workers also
+// get a copy of the oldest unfinished tile of another worker, so one slow
+// worker doesn't hold up the frame. The first result for a tile is used.
+// Workers rendering a different scene or with different settings are
+// dropped when they join, so their tiles never mix into the frame.
+class LIBRAY_API Coordinator final
+{
+public:
+	// Starts listening right away, so workers can connect before Render.
+	Coordinator(
+		Math::Vector2st const &imageSize,
+		CoordinatorConfiguration const &configuration);
+
+	// Tells the connected workers to shut down.
+	~Coordinator() noexcept;
+
+	Coordinator(Coordinator const &) = delete;
+	Coordinator &operator=(Coordinator const &) = delete;
+
+	// Blocks until every tile is rendered, the result is averaged like the
+	// output of RayTracer::Trace.
+	Image Render();
+
+private:
+	struct Worker
+	{
+		Socket socket;
+		std::string name;
+
+		// The socket doesn't block, messages are put together here as their
+		// bytes arrive.
+		MessageAssembler incoming;
+		std::chrono::steady_clock::time_point lastReceived;
+
+		std::uint32_t threadCount = 0;
+		bool greeted = false;
+
+		// The unfinished tiles sent to the worker.
+		std::vector<std::size_t> tiles;
+		std::chrono::steady_clock::time_point lastHeard;
+	};
+
+private:
+	Math::Vector2st imageSize;
+	CoordinatorConfiguration configuration;
+
+	Socket listener;
+	// Every worker renders with this RayTracer::Fingerprint, once known.
+	std::optional<std::uint64_t> fingerprint;
+	// Results of copies of tiles of an earlier frame are ignored.
+	std::uint32_t frame;
+
+	// Workers stay connected between frames.
+	std::vector<Worker> workers;
+};
+
+static_assert(!std::is_copy_constructible_v<Coordinator>);
+static_assert(!std::is_copy_assignable_v<Coordinator>);
+static_assert(!std::is_trivially_copyable_v<Coordinator>);
+
+static_assert(!std::is_move_constructible_v<Coordinator>);
+static_assert(!std::is_move_assignable_v<Coordinator>);
+} // namespace Distributed
+} // namespace LibRay
+
+#endif // eaf2b25a_1609_4b3f_a9b0_0e6ccfd55a5b
@@ -0,0 +1,203 @@
+#include "Protocol.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Socket.hpp"
+
+namespace LibRay::Distributed
+{
+// A message starts with its type and the size of the payload, 4 bytes each.
+constexpr std::size_t headerSize = 8;
+
+// Anything larger is a corrupt stream, rather than a huge tile.
+constexpr std::uint32_t maxPayloadSize = 256u * 1024u * 1024u;
+
+static void AppendBytes(
+	std::vector<std::uint8_t> &buffer,
+	std::uint64_t value,
+	std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i)
+		buffer.push_back(std::uint8_t(value >> (8 * i)));
+}
+
+static std::uint32_t ParseUInt32(std::uint8_t const *bytes)
+{
+	return std::uint32_t(bytes[0])
+		| std::uint32_t(bytes[1]) << 8
+		| std::uint32_t(bytes[2]) << 16
+		| std::uint32_t(bytes[3]) << 24;
+}
+
+MessageWriter::MessageWriter(MessageType type)
+: buffer()
+{
+	AppendBytes(buffer, std::uint32_t(type), 4);
+	AppendBytes(buffer, 0, 4);
+}
+
+void MessageWriter::Write(std::uint32_t value)
+{
+	AppendBytes(buffer, value, 4);
+}
+
+void MessageWriter::Write(std::uint64_t value)
+{
+	AppendBytes(buffer, value, 8);
+}
+
+void MessageWriter::Write(float value)
+{
+	static_assert(sizeof(float) == sizeof(std::uint32_t));
+
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	Write(bits);
+}
+
+void MessageWriter::Send(Socket const &socket)
+{
+	std::uint32_t const payloadSize = std::uint32_t(buffer.size() - headerSize);
+	for(std::size_t i = 0; i < 4; ++i)
+		buffer[4 + i] = std::uint8_t(payloadSize >> (8 * i));
+
+	socket.Send(buffer.data(), buffer.size());
+}
+
+// Returns the type and payload size of a message header.
+static std::pair<MessageType, std::uint32_t> ParseHeader(std::uint8_t const *header)
+{
+	std::uint32_t const type = ParseUInt32(header);
+	std::uint32_t const payloadSize = ParseUInt32(header + 4);
+
+	if(type < std::uint32_t(MessageType::Hello)
+		|| type > std::uint32_t(MessageType::Shutdown))
+	{
+		throw std::runtime_error(
+			"Received unknown message type " + std::to_string(type));
+	}
+
+	if(payloadSize > maxPayloadSize)
+	{
+		throw std::runtime_error(
+			"Received message of " + std::to_string(payloadSize) + " bytes");
+	}
+
+	return {MessageType(type), payloadSize};
+}
+
+std::optional<MessageReader> MessageReader::Receive(Socket const &socket)
+{
+	std::uint8_t header[headerSize];
+	if(!socket.Receive(header, sizeof(header)))
+		return std::nullopt;
+
+	auto const [type, payloadSize] = ParseHeader(header);
+
+	std::vector<std::uint8_t> payload(payloadSize);
+	if(payloadSize > 0 && !socket.Receive(payload.data(), payload.size()))
+		return std::nullopt;
+
+	return MessageReader(type, std::move(payload));
+}
+
+MessageReader::MessageReader(
+	MessageType type,
+	std::vector<std::uint8_t> &&payload)
+: type(type)
+, payload(std::move(payload))
+, position(0)
+{
+}
+
+MessageType MessageReader::Type() const
+{
+	return type;
+}
+
+std::uint32_t MessageReader::ReadUInt32()
+{
+	return std::uint32_t(ReadBytes(4));
+}
+
+std::uint64_t MessageReader::ReadUInt64()
+{
+	return ReadBytes(8);
+}
+
+float MessageReader::ReadFloat()
+{
+	std::uint32_t const bits = ReadUInt32();
+
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+std::uint64_t MessageReader::ReadBytes(std::size_t count)
+{
+	if(payload.size() - position < count)
+		throw std::runtime_error("Read past the end of a message");
+
+	std::uint64_t value = 0;
+	for(std::size_t i = 0; i < count; ++i)
+		value |= std::uint64_t(payload[position + i]) << (8 * i);
+
+	position += count;
+
+	return value;
+}
+
+bool MessageAssembler::ReceiveAvailable(Socket const &socket)
+{
+	// Tile results are a few kilobytes to megabytes, read in large steps.
+	constexpr std::size_t const chunkSize = 64 * 1024;
+
+	while(true)
+	{
+		std::size_t const oldSize = buffer.size();
+		buffer.resize(oldSize + chunkSize);
+
+		std::optional<std::size_t> const received =
+			socket.ReceiveAvailable(buffer.data() + oldSize, chunkSize);
+
+		buffer.resize(oldSize + received.value_or(0));
+
+		if(!received)
+			return false;
+
+		if(*received < chunkSize)
+			return true;
+	}
+}
+
+std::optional<MessageReader> MessageAssembler::NextMessage()
+{
+	if(buffer.size() < headerSize)
+		return std::nullopt;
+
+	auto const [type, payloadSize] = ParseHeader(buffer.data());
+
+	std::size_t const messageSize = headerSize + payloadSize;
+	if(buffer.size() < messageSize)
+		return std::nullopt;
+
+	std::vector<std::uint8_t> payload(
+		buffer.begin() + std::ptrdiff_t(headerSize),
+		buffer.begin() + std::ptrdiff_t(messageSize));
+
+	buffer.erase(buffer.begin(), buffer.begin() + std::ptrdiff_t(messageSize));
+
+	return MessageReader(type, std::move(payload));
+}
+
+bool MessageAssembler::HasPartialMessage() const
+{
+	return !buffer.empty();
+}
+} // namespace LibRay::Distributed
@@ -0,0 +1,123 @@
+#ifndef fcddafa4_6991_4224_bbee_8a9116460006
+#define fcddafa4_6991_4224_bbee_8a9116460006
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "../API.hpp"
+
+namespace LibRay::Distributed
+{
+class Socket;
+
+// Bumped whenever the layout of a message changes.
+constexpr std::uint32_t protocolVersion = 2;
+
+enum class MessageType : std::uint32_t
+{
+	// Worker to coordinator: version, RayTracer::Fingerprint, thread count,
+	// image width and height.
+	Hello = 1,
+	// Coordinator to worker: frame, first sample, sample count, tile count, and
+	// per tile its id, x, y, width, and height.
+	Assign = 2,
+	// Worker to coordinator: frame, tile id, x, y, width, height, and the
+	// averaged RGB floats of the tile, row by row.
+	TileResult = 3,
+	// Coordinator to worker: the frame is done, exit.
+	Shutdown = 4
+};
+
+// Builds a message, numbers are written little endian so workers and
+// coordinator don't need to share an architecture.
+class LIBRAY_API MessageWriter final
+{
+public:
+	explicit MessageWriter(MessageType type);
+
+	void Write(std::uint32_t value);
+	void Write(std::uint64_t value);
+	void Write(float value);
+
+	// Fills in the payload size and sends the message.
+	void Send(Socket const &socket);
+
+private:
+	std::vector<std::uint8_t> buffer;
+};
+
+static_assert(std::is_copy_constructible_v<MessageWriter>);
+static_assert(std::is_copy_assignable_v<MessageWriter>);
+static_assert(!std::is_trivially_copyable_v<MessageWriter>);
+
+static_assert(std::is_move_constructible_v<MessageWriter>);
+static_assert(std::is_move_assignable_v<MessageWriter>);
+
+// Reads a message, reading past its end throws std::runtime_error.
+class LIBRAY_API MessageReader final
+{
+public:
+	// Returns std::nullopt when the peer closed the connection.
+	static std::optional<MessageReader> Receive(Socket const &socket);
+
+	MessageType Type() const;
+
+	std::uint32_t ReadUInt32();
+	std::uint64_t ReadUInt64();
+	float ReadFloat();
+
+private:
+	MessageReader(MessageType type, std::vector<std::uint8_t> &&payload);
+
+	std::uint64_t ReadBytes(std::size_t count);
+
+	friend class MessageAssembler;
+
+private:
+	MessageType type;
+	std::vector<std::uint8_t> payload;
+	std::size_t position;
+};
+
+static_assert(std::is_copy_constructible_v<MessageReader>);
+static_assert(std::is_copy_assignable_v<MessageReader>);
+static_assert(!std::is_trivially_copyable_v<MessageReader>);
+
+static_assert(std::is_move_constructible_v<MessageReader>);
+static_assert(std::is_move_assignable_v<MessageReader>);
+
+// Collects the messages of a non-blocking socket as their bytes arrive, so
+// one peer that's slow to send the rest of a message doesn't hold up the
+// others.
+class LIBRAY_API MessageAssembler final
+{
+public:
+	MessageAssembler() = default;
+
+	// Reads whatever socket has without waiting. Returns false when the peer
+	// closed the connection.
+	bool ReceiveAvailable(Socket const &socket);
+
+	// The oldest message that has fully arrived, throws std::runtime_error
+	// for a corrupt header.
+	std::optional<MessageReader> NextMessage();
+
+	// Whether part of a message has arrived, but not all of it.
+	bool HasPartialMessage() const;
+
+private:
+	std::vector<std::uint8_t> buffer;
+};
+
+static_assert(std::is_copy_constructible_v<MessageAssembler>);
+static_assert(std::is_copy_assignable_v<MessageAssembler>);
+static_assert(!std::is_trivially_copyable_v<MessageAssembler>);
+
+static_assert(std::is_move_constructible_v<MessageAssembler>);
+static_assert(std::is_move_assignable_v<MessageAssembler>);
+} // namespace LibRay::Distributed
+
+#endif // fcddafa4_6991_4224_bbee_8a9116460006
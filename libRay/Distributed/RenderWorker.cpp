@@ -0,0 +1,174 @@
+#include "RenderWorker.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../Material/Color.hpp"
+#include "../Threading/Tile.hpp"
+#include "../Image.hpp"
+#include "../Scene.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+
+namespace LibRay::Distributed
+{
+using namespace Materials;
+
+RenderWorker::RenderWorker(
+	Scene const &scene,
+	RayTracerConfiguration &&configuration)
+: scene(scene)
+, rayTracer(scene, std::move(configuration))
+{
+}
+
+bool RenderWorker::Serve(
+	std::string const &host,
+	std::uint16_t port,
+	std::chrono::seconds connectTimeout) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point const deadline = Clock::now() + connectTimeout;
+
+	// The coordinator might not be up yet when a whole farm starts at once.
+	Socket socket;
+	while(!socket.IsValid())
+	{
+		try
+		{
+			socket = Socket::Connect(host, port);
+		}
+		catch(std::exception const &)
+		{
+			if(Clock::now() >= deadline)
+				throw;
+
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+		}
+	}
+
+	std::uint64_t const fingerprint = rayTracer.Fingerprint();
+
+	std::printf(
+		"Connected to coordinator %s, render fingerprint %016" PRIx64 "\n",
+		socket.PeerName().c_str(),
+		fingerprint);
+	std::fflush(stdout);
+
+	Math::Vector2st const &screenSize = scene.Camera().ScreenSize();
+
+	MessageWriter hello(MessageType::Hello);
+	hello.Write(protocolVersion);
+	hello.Write(fingerprint);
+	hello.Write(std::max(rayTracer.Configuration().threadCount, 1u));
+	hello.Write(std::uint64_t(screenSize.x));
+	hello.Write(std::uint64_t(screenSize.y));
+	hello.Send(socket);
+
+	Image accumulation(screenSize.x, screenSize.y);
+	accumulation.pixels.resize(screenSize.x * screenSize.y, Color::Black());
+
+	while(true)
+	{
+		std::optional<MessageReader> message = MessageReader::Receive(socket);
+		if(!message)
+		{
+			std::fprintf(stderr, "Coordinator closed the connection\n");
+			return false;
+		}
+
+		switch(message->Type())
+		{
+		case MessageType::Assign:
+		{
+			std::uint32_t const frame = message->ReadUInt32();
+			std::uint32_t const sampleStart = message->ReadUInt32();
+			std::uint32_t const sampleCount = message->ReadUInt32();
+			std::uint32_t const tileCount = message->ReadUInt32();
+
+			std::vector<std::uint64_t> ids;
+			std::vector<Threading::Tile> tiles;
+			ids.reserve(tileCount);
+			tiles.reserve(tileCount);
+
+			for(std::uint32_t i = 0; i < tileCount; ++i)
+			{
+				ids.push_back(message->ReadUInt64());
+
+				Threading::Tile tile;
+				tile.x = std::size_t(message->ReadUInt64());
+				tile.y = std::size_t(message->ReadUInt64());
+				tile.width = std::size_t(message->ReadUInt64());
+				tile.height = std::size_t(message->ReadUInt64());
+
+				if(tile.x + tile.width > screenSize.x
+					|| tile.y + tile.height > screenSize.y)
+				{
+					throw std::runtime_error("Assigned a tile outside the image");
+				}
+
+				// Tiles are sent more than once when a worker was too slow.
+				for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+				{
+					std::fill_n(
+						accumulation.pixels.begin()
+							+ std::ptrdiff_t(y * screenSize.x + tile.x),
+						tile.width,
+						Color::Black());
+				}
+
+				tiles.push_back(tile);
+			}
+
+			rayTracer.TraceTiles(accumulation, tiles, sampleStart, sampleCount);
+
+			float const inverseSampleCount = 1.f / float(std::max(sampleCount, 1u));
+
+			for(std::size_t i = 0; i < tiles.size(); ++i)
+			{
+				Threading::Tile const &tile = tiles[i];
+
+				MessageWriter result(MessageType::TileResult);
+				result.Write(frame);
+				result.Write(ids[i]);
+				result.Write(std::uint64_t(tile.x));
+				result.Write(std::uint64_t(tile.y));
+				result.Write(std::uint64_t(tile.width));
+				result.Write(std::uint64_t(tile.height));
+
+				for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+				{
+					for(std::size_t x = tile.x; x < tile.x + tile.width; ++x)
+					{
+						Color const pixel =
+							accumulation.pixels[y * screenSize.x + x]
+							* inverseSampleCount;
+
+						result.Write(pixel.r);
+						result.Write(pixel.g);
+						result.Write(pixel.b);
+					}
+				}
+
+				result.Send(socket);
+			}
+		} break;
+		case MessageType::Shutdown:
+		{
+			return true;
+		}
+		case MessageType::Hello:
+		case MessageType::TileResult:
+		{
+			throw std::runtime_error("Unexpected message from coordinator");
+		}
+		}
+	}
+}
+} // namespace LibRay::Distributed
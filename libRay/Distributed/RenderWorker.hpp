@@ -0,0 +1,47 @@
+#ifndef ec13d1b7_5aa4_42b6_ab4c_fd01cad331af
+#define ec13d1b7_5aa4_42b6_ab4c_fd01cad331af
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "../API.hpp"
+#include "../RayTracer.hpp"
+
+namespace LibRay
+{
+class Scene;
+
+namespace Distributed
+{
+// Renders tiles handed out by a Coordinator, the scene is loaded once and
+// used for every tile.
+class LIBRAY_API RenderWorker final
+{
+public:
+	RenderWorker(Scene const &scene, RayTracerConfiguration &&configuration);
+
+	// Connects to the coordinator, retrying for up to connectTimeout, and
+	// renders tiles until it is told to shut down. Returns false when the
+	// coordinator went away instead.
+	bool Serve(
+		std::string const &host,
+		std::uint16_t port,
+		std::chrono::seconds connectTimeout) const;
+
+private:
+	Scene const &scene;
+	RayTracer rayTracer;
+};
+
+static_assert(std::is_copy_constructible_v<RenderWorker>);
+static_assert(!std::is_copy_assignable_v<RenderWorker>);
+static_assert(!std::is_trivially_copyable_v<RenderWorker>);
+
+static_assert(std::is_move_constructible_v<RenderWorker>);
+static_assert(!std::is_move_assignable_v<RenderWorker>);
+} // namespace Distributed
+} // namespace LibRay
+
+#endif // ec13d1b7_5aa4_42b6_ab4c_fd01cad331af
@@ -0,0 +1,439 @@
+#include "Socket.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace LibRay::Distributed
+{
+static constexpr Socket::Handle invalidHandle = ~Socket::Handle(0);
+
+#ifdef _WIN32
+using NativeHandle = SOCKET;
+using Length = int;
+
+static constexpr int sendFlags = 0;
+
+static std::string LastError()
+{
+	return "error " + std::to_string(WSAGetLastError());
+}
+
+static bool WouldBlock()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+static void CloseNative(NativeHandle socket)
+{
+	closesocket(socket);
+}
+
+static void InitializeSockets()
+{
+	static std::once_flag once;
+	std::call_once(
+		once,
+		[]()
+		{
+			WSADATA data;
+			if(WSAStartup(MAKEWORD(2, 2), &data) != 0)
+				throw std::runtime_error("Failed to initialize Winsock");
+		});
+}
+#else
+using NativeHandle = int;
+using Length = socklen_t;
+
+// Writing to a closed connection should fail, not raise SIGPIPE.
+#ifdef MSG_NOSIGNAL
+static constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int sendFlags = 0;
+#endif
+
+static std::string LastError()
+{
+	return std::strerror(errno);
+}
+
+static bool WouldBlock()
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+static void CloseNative(NativeHandle socket)
+{
+	close(socket);
+}
+
+static void InitializeSockets()
+{
+}
+#endif
+
+static NativeHandle Native(Socket::Handle handle)
+{
+	return NativeHandle(handle);
+}
+
+static bool IsValidNative(NativeHandle socket)
+{
+#ifdef _WIN32
+	return socket != INVALID_SOCKET;
+#else
+	return socket >= 0;
+#endif
+}
+
+Socket::Socket() noexcept
+: handle(invalidHandle)
+{
+}
+
+Socket::Socket(Handle handle) noexcept
+: handle(handle)
+{
+}
+
+Socket::~Socket() noexcept
+{
+	Close();
+}
+
+Socket::Socket(Socket &&other) noexcept
+: handle(std::exchange(other.handle, invalidHandle))
+{
+}
+
+Socket &Socket::operator=(Socket &&other) noexcept
+{
+	if(this != &other)
+	{
+		Close();
+		handle = std::exchange(other.handle, invalidHandle);
+	}
+
+	return *this;
+}
+
+Socket Socket::Listen(std::uint16_t port)
+{
+	InitializeSockets();
+
+	NativeHandle const socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if(!IsValidNative(socket))
+		throw std::runtime_error("Failed to create socket: " + LastError());
+
+	Socket listener = Socket(Handle(socket));
+
+	// Allow restarting the coordinator right away on the same port.
+	int const reuse = 1;
+	setsockopt(
+		socket,
+		SOL_SOCKET,
+		SO_REUSEADDR,
+		reinterpret_cast<char const *>(&reuse),
+		sizeof(reuse));
+
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+
+	if(bind(
+		socket,
+		reinterpret_cast<sockaddr const *>(&address),
+		sizeof(address)) != 0)
+	{
+		throw std::runtime_error(
+			"Failed to bind to port " + std::to_string(port) + ": " + LastError());
+	}
+
+	if(listen(socket, SOMAXCONN) != 0)
+		throw std::runtime_error("Failed to listen: " + LastError());
+
+	return listener;
+}
+
+Socket Socket::Connect(std::string const &host, std::uint16_t port)
+{
+	InitializeSockets();
+
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	Observer<addrinfo> addresses = nullptr;
+	int const result = getaddrinfo(
+		host.c_str(),
+		std::to_string(port).c_str(),
+		&hints,
+		&addresses);
+
+	if(result != 0)
+		throw std::runtime_error("Failed to resolve <" + host + ">");
+
+	std::string error = "no addresses";
+
+	for(Observer<addrinfo> address = addresses; address; address = address->ai_next)
+	{
+		NativeHandle const socket = ::socket(
+			address->ai_family,
+			address->ai_socktype,
+			address->ai_protocol);
+
+		if(!IsValidNative(socket))
+		{
+			error = LastError();
+			continue;
+		}
+
+		if(connect(socket, address->ai_addr, Length(address->ai_addrlen)) != 0)
+		{
+			error = LastError();
+			CloseNative(socket);
+			continue;
+		}
+
+		freeaddrinfo(addresses);
+
+		// Tile results are sent as soon as they are done.
+		int const noDelay = 1;
+		setsockopt(
+			socket,
+			IPPROTO_TCP,
+			TCP_NODELAY,
+			reinterpret_cast<char const *>(&noDelay),
+			sizeof(noDelay));
+
+		return Socket(Handle(socket));
+	}
+
+	freeaddrinfo(addresses);
+
+	throw std::runtime_error(
+		"Failed to connect to <" + host + ":" + std::to_string(port) + ">: "
+		+ error);
+}
+
+Socket Socket::Accept() const
+{
+	NativeHandle const socket = accept(Native(handle), nullptr, nullptr);
+	if(!IsValidNative(socket))
+		throw std::runtime_error("Failed to accept connection: " + LastError());
+
+	return Socket(Handle(socket));
+}
+
+bool Socket::IsValid() const
+{
+	return handle != invalidHandle;
+}
+
+std::string Socket::PeerName() const
+{
+	sockaddr_storage address;
+	Length length = sizeof(address);
+
+	if(getpeername(
+		Native(handle),
+		reinterpret_cast<sockaddr *>(&address),
+		&length) != 0)
+	{
+		return "unknown";
+	}
+
+	char host[NI_MAXHOST];
+	char service[NI_MAXSERV];
+
+	if(getnameinfo(
+		reinterpret_cast<sockaddr const *>(&address),
+		length,
+		host,
+		sizeof(host),
+		service,
+		sizeof(service),
+		NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+	{
+		return "unknown";
+	}
+
+	return std::string(host) + ":" + service;
+}
+
+void Socket::SetReceiveTimeout(std::chrono::milliseconds timeout) const
+{
+#ifdef _WIN32
+	DWORD const value = DWORD(timeout.count());
+#else
+	timeval value;
+	value.tv_sec = decltype(value.tv_sec)(timeout.count() / 1000);
+	value.tv_usec = decltype(value.tv_usec)((timeout.count() % 1000) * 1000);
+#endif
+
+	setsockopt(
+		Native(handle),
+		SOL_SOCKET,
+		SO_RCVTIMEO,
+		reinterpret_cast<char const *>(&value),
+		sizeof(value));
+}
+
+void Socket::SetNonBlocking() const
+{
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	if(ioctlsocket(Native(handle), FIONBIO, &nonBlocking) != 0)
+		throw std::runtime_error("Failed to make socket non-blocking: " + LastError());
+#else
+	int const flags = fcntl(Native(handle), F_GETFL, 0);
+	if(flags < 0 || fcntl(Native(handle), F_SETFL, flags | O_NONBLOCK) != 0)
+		throw std::runtime_error("Failed to make socket non-blocking: " + LastError());
+#endif
+}
+
+void Socket::Send(void const *data, std::size_t size) const
+{
+	Observer<char const> bytes = static_cast<Observer<char const>>(data);
+
+	while(size > 0)
+	{
+		auto const sent = send(Native(handle), bytes, Length(size), sendFlags);
+		if(sent < 0 && WouldBlock())
+		{
+#ifdef _WIN32
+			WSAPOLLFD descriptor;
+#else
+			pollfd descriptor;
+#endif
+			descriptor.fd = Native(handle);
+			descriptor.events = POLLOUT;
+			descriptor.revents = 0;
+
+#ifdef _WIN32
+			WSAPoll(&descriptor, 1, -1);
+#else
+			poll(&descriptor, 1, -1);
+#endif
+			continue;
+		}
+
+		if(sent <= 0)
+			throw std::runtime_error("Failed to send: " + LastError());
+
+		bytes += sent;
+		size -= std::size_t(sent);
+	}
+}
+
+bool Socket::Receive(void *data, std::size_t size) const
+{
+	Observer<char> bytes = static_cast<Observer<char>>(data);
+
+	while(size > 0)
+	{
+		auto const received = recv(Native(handle), bytes, Length(size), 0);
+		if(received == 0)
+			return false;
+
+		if(received < 0)
+			throw std::runtime_error("Failed to receive: " + LastError());
+
+		bytes += received;
+		size -= std::size_t(received);
+	}
+
+	return true;
+}
+
+std::optional<std::size_t> Socket::ReceiveAvailable(void *data, std::size_t size) const
+{
+	auto const received =
+		recv(Native(handle), static_cast<Observer<char>>(data), Length(size), 0);
+
+	if(received == 0)
+		return std::nullopt;
+
+	if(received < 0)
+	{
+		if(WouldBlock())
+			return 0;
+
+		throw std::runtime_error("Failed to receive: " + LastError());
+	}
+
+	return std::size_t(received);
+}
+
+void Socket::Close() noexcept
+{
+	if(handle == invalidHandle)
+		return;
+
+	CloseNative(Native(handle));
+	handle = invalidHandle;
+}
+
+std::vector<std::size_t> Socket::WaitReadable(
+	std::vector<Observer<Socket const>> const &sockets,
+	std::chrono::milliseconds timeout)
+{
+#ifdef _WIN32
+	std::vector<WSAPOLLFD> descriptors(sockets.size());
+#else
+	std::vector<pollfd> descriptors(sockets.size());
+#endif
+
+	for(std::size_t i = 0; i < sockets.size(); ++i)
+	{
+		descriptors[i].fd = Native(sockets[i]->handle);
+		descriptors[i].events = POLLIN;
+		descriptors[i].revents = 0;
+	}
+
+#ifdef _WIN32
+	int const result = WSAPoll(
+		descriptors.data(),
+		ULONG(descriptors.size()),
+		int(timeout.count()));
+#else
+	int const result = poll(
+		descriptors.data(),
+		nfds_t(descriptors.size()),
+		int(timeout.count()));
+#endif
+
+	std::vector<std::size_t> readable;
+	if(result <= 0)
+		return readable;
+
+	for(std::size_t i = 0; i < descriptors.size(); ++i)
+	{
+		if(descriptors[i].revents & (POLLIN | POLLHUP | POLLERR))
+			readable.push_back(i);
+	}
+
+	return readable;
+}
+} // namespace LibRay::Distributed
@@ -0,0 +1,87 @@
+#ifndef b25d00d8_cb83_423f_b816_321de51a7f91
+#define b25d00d8_cb83_423f_b816_321de51a7f91
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../API.hpp"
+#include "../Utilites.hpp"
+
+namespace LibRay::Distributed
+{
+// A TCP socket, blocking unless SetNonBlocking is called. Errors are thrown
+// as std::runtime_error.
+class LIBRAY_API Socket final
+{
+public:
+	// Wide enough for both file descriptors and Winsock handles.
+	using Handle = std::uintptr_t;
+
+public:
+	Socket() noexcept;
+	~Socket() noexcept;
+
+	Socket(Socket &&other) noexcept;
+	Socket(Socket const &) = delete;
+
+	Socket &operator=(Socket &&other) noexcept;
+	Socket &operator=(Socket const &) = delete;
+
+	// Listens on every IPv4 interface.
+	static Socket Listen(std::uint16_t port);
+	static Socket Connect(std::string const &host, std::uint16_t port);
+
+	Socket Accept() const;
+
+	bool IsValid() const;
+	std::string PeerName() const;
+
+	// A receive that waits longer than timeout fails, so a peer that stops
+	// halfway through a message can't block forever.
+	void SetReceiveTimeout(std::chrono::milliseconds timeout) const;
+
+	// Receives return right away instead of waiting for data, see
+	// ReceiveAvailable.
+	void SetNonBlocking() const;
+
+	// Waits for room to send on a non-blocking socket too.
+	void Send(void const *data, std::size_t size) const;
+
+	// Returns false when the peer closed the connection before all data was
+	// received. Only for blocking sockets.
+	bool Receive(void *data, std::size_t size) const;
+
+	// Reads what has arrived, at most size bytes, without waiting on a
+	// non-blocking socket. Returns how many were read, 0 when nothing was
+	// waiting, or std::nullopt when the peer closed the connection.
+	std::optional<std::size_t> ReceiveAvailable(void *data, std::size_t size) const;
+
+	void Close() noexcept;
+
+	// Returns the indices of the sockets with data to read, or whose peer
+	// hung up, after waiting at most timeout.
+	static std::vector<std::size_t> WaitReadable(
+		std::vector<Observer<Socket const>> const &sockets,
+		std::chrono::milliseconds timeout);
+
+private:
+	explicit Socket(Handle handle) noexcept;
+
+private:
+	Handle handle;
+};
+
+static_assert(!std::is_copy_constructible_v<Socket>);
+static_assert(!std::is_copy_assignable_v<Socket>);
+static_assert(!std::is_trivially_copyable_v<Socket>);
+
+static_assert(std::is_move_constructible_v<Socket>);
+static_assert(std::is_move_assignable_v<Socket>);
+} // namespace LibRay::Distributed
+
+#endif // b25d00d8_cb83_423f_b816_321de51a7f91
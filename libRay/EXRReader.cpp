@@ -0,0 +1,244 @@
+#include "EXRReader.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Material/Color.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+// The same layout as WriteEXR, see EXRWriter.cpp.
+constexpr std::uint32_t const magic = 20000630;
+constexpr std::uint32_t const floatPixelType = 2;
+
+// Walks the bytes of the file, throwing when reading past the end.
+class EXRCursor final
+{
+public:
+	EXRCursor(std::vector<std::uint8_t> const &bytes, std::string const &fileName)
+	: bytes(bytes)
+	, fileName(fileName)
+	, position(0)
+	{
+	}
+
+	std::uint64_t Integer(std::size_t size)
+	{
+		Need(size);
+
+		std::uint64_t value = 0;
+		for(std::size_t i = 0; i < size; ++i)
+			value |= std::uint64_t(bytes[position + i]) << (8 * i);
+
+		position += size;
+
+		return value;
+	}
+
+	float Float()
+	{
+		std::uint32_t const bits = std::uint32_t(Integer(4));
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+
+		return value;
+	}
+
+	// Empty at the null byte ending a list.
+	std::string String()
+	{
+		std::string value;
+		for(;;)
+		{
+			Need(1);
+
+			char const c = char(bytes[position++]);
+			if(c == 0)
+				return value;
+
+			value += c;
+		}
+	}
+
+	void Skip(std::size_t size)
+	{
+		Need(size);
+		position += size;
+	}
+
+	std::size_t Position() const
+	{
+		return position;
+	}
+
+	void Seek(std::size_t newPosition)
+	{
+		if(newPosition > bytes.size())
+			Fail("points past the end");
+
+		position = newPosition;
+	}
+
+	[[noreturn]] void Fail(std::string const &reason) const
+	{
+		throw std::runtime_error("Can't read <" + fileName + ">, it " + reason);
+	}
+
+private:
+	void Need(std::size_t size) const
+	{
+		if(size > bytes.size() - position)
+			Fail("ends early");
+	}
+
+	std::vector<std::uint8_t> const &bytes;
+	std::string const &fileName;
+	std::size_t position;
+};
+
+struct EXRChannel
+{
+	std::string name;
+	std::uint32_t pixelType;
+};
+
+Image ReadEXR(std::string const &fileName)
+{
+	using File = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+	File const file(std::fopen(fileName.c_str(), "rb"), &std::fclose);
+	if(!file)
+		throw std::runtime_error("Failed to open <" + fileName + "> for reading");
+
+	std::vector<std::uint8_t> bytes;
+	std::array<std::uint8_t, 4096> buffer;
+	for(;;)
+	{
+		std::size_t const read =
+			std::fread(buffer.data(), 1, buffer.size(), file.get());
+		bytes.insert(bytes.end(), buffer.begin(), buffer.begin() + std::ptrdiff_t(read));
+
+		if(read < buffer.size())
+			break;
+	}
+
+	if(std::ferror(file.get()))
+		throw std::runtime_error("Failed to read <" + fileName + ">");
+
+	EXRCursor cursor(bytes, fileName);
+
+	if(cursor.Integer(4) != magic)
+		cursor.Fail("isn't an OpenEXR file");
+
+	// Tiled, multi-part, and deep files set flags in the version.
+	if(cursor.Integer(4) != 2)
+		cursor.Fail("isn't a single part scanline file");
+
+	std::vector<EXRChannel> channels;
+	std::uint64_t compression = ~std::uint64_t(0);
+	std::int64_t minX = 0, minY = 0, maxX = -1, maxY = -1;
+
+	for(std::string name = cursor.String(); !name.empty(); name = cursor.String())
+	{
+		std::string const type = cursor.String();
+		std::size_t const size = std::size_t(cursor.Integer(4));
+		std::size_t const end = cursor.Position() + size;
+
+		if(name == "channels" && type == "chlist")
+		{
+			for(std::string channel = cursor.String(); !channel.empty(); channel = cursor.String())
+			{
+				std::uint32_t const pixelType = std::uint32_t(cursor.Integer(4));
+
+				// Linearity, reserved bytes, and subsampling.
+				cursor.Skip(12);
+
+				channels.push_back({channel, pixelType});
+			}
+		}
+		else if(name == "compression" && type == "compression")
+			compression = cursor.Integer(1);
+		else if(name == "dataWindow" && type == "box2i")
+		{
+			minX = std::int32_t(cursor.Integer(4));
+			minY = std::int32_t(cursor.Integer(4));
+			maxX = std::int32_t(cursor.Integer(4));
+			maxY = std::int32_t(cursor.Integer(4));
+		}
+
+		cursor.Seek(end);
+	}
+
+	if(compression != 0)
+		cursor.Fail("is compressed");
+
+	if(maxX < minX || maxY < minY)
+		cursor.Fail("has no pixels");
+
+	std::size_t const width = std::size_t(maxX - minX + 1);
+	std::size_t const height = std::size_t(maxY - minY + 1);
+
+	// Channels are stored in the order of the list, which is sorted by name.
+	std::size_t red = channels.size(), green = channels.size(), blue = channels.size();
+	for(std::size_t c = 0; c < channels.size(); ++c)
+	{
+		if(channels[c].pixelType != floatPixelType)
+			cursor.Fail("has channels that aren't 32 bit floats");
+
+		if(channels[c].name == "R")
+			red = c;
+		else if(channels[c].name == "G")
+			green = c;
+		else if(channels[c].name == "B")
+			blue = c;
+	}
+
+	if(red == channels.size() || green == channels.size() || blue == channels.size())
+		cursor.Fail("misses one of the R, G, and B channels");
+
+	Image image(width, height);
+	image.pixels.resize(width * height, Materials::Color::Black());
+
+	std::size_t const lineDataSize = channels.size() * width * sizeof(float);
+	std::size_t const offsets = cursor.Position();
+
+	for(std::size_t line = 0; line < height; ++line)
+	{
+		cursor.Seek(offsets + line * 8);
+		cursor.Seek(std::size_t(cursor.Integer(8)));
+
+		std::int64_t const y = std::int32_t(cursor.Integer(4)) - minY;
+		if(y < 0 || y >= std::int64_t(height))
+			cursor.Fail("has a scanline outside of its data window");
+
+		if(cursor.Integer(4) != lineDataSize)
+			cursor.Fail("has a scanline of the wrong size");
+
+		Observer<Materials::Color> const row = &image.pixels[std::size_t(y) * width];
+
+		for(std::size_t c = 0; c < channels.size(); ++c)
+		{
+			for(std::size_t x = 0; x < width; ++x)
+			{
+				float const value = cursor.Float();
+
+				if(c == red)
+					row[x].r = value;
+				else if(c == green)
+					row[x].g = value;
+				else if(c == blue)
+					row[x].b = value;
+			}
+		}
+	}
+
+	return image;
+}
+} // namespace LibRay
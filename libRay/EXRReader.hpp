@@ -0,0 +1,17 @@
+#ifndef fd52df00_8efa_4268_af13_fe5a006f88ac
+#define fd52df00_8efa_4268_af13_fe5a006f88ac
+
+#include <string>
+
+#include "API.hpp"
+#include "Image.hpp"
+
+namespace LibRay
+{
+// Reads the R, G, and B channels of an uncompressed scanline OpenEXR file in
+// 32 bit floats, like WriteEXR writes, skipping any other channels. Throws
+// std::runtime_error when the file can't be read, or is stored any other way.
+LIBRAY_API Image ReadEXR(std::string const &fileName);
+} // namespace LibRay
+
+#endif // fd52df00_8efa_4268_af13_fe5a006f88ac
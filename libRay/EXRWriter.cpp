@@ -0,0 +1,192 @@
+#include "EXRWriter.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "AOVBuffer.hpp"
+
+namespace LibRay
+{
+// The file is little endian, scanlines are stored one per chunk.
+constexpr std::uint32_t const magic = 20000630;
+constexpr std::uint32_t const version = 2;
+constexpr std::uint32_t const floatPixelType = 2;
+
+struct Channel
+{
+	std::string name;
+	Observer<float const> plane;
+};
+
+static void AppendBytes(
+	std::vector<std::uint8_t> &buffer,
+	std::uint64_t value,
+	std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i)
+		buffer.push_back(std::uint8_t(value >> (8 * i)));
+}
+
+static void AppendFloat(std::vector<std::uint8_t> &buffer, float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	AppendBytes(buffer, bits, 4);
+}
+
+static void AppendString(std::vector<std::uint8_t> &buffer, std::string const &value)
+{
+	buffer.insert(buffer.end(), value.begin(), value.end());
+	buffer.push_back(0);
+}
+
+static void AppendAttribute(
+	std::vector<std::uint8_t> &buffer,
+	std::string const &name,
+	std::string const &type,
+	std::vector<std::uint8_t> const &value)
+{
+	AppendString(buffer, name);
+	AppendString(buffer, type);
+	AppendBytes(buffer, value.size(), 4);
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void WriteEXR(
+	std::string const &fileName,
+	Image const &image,
+	Observer<AOVBuffer const> aovs)
+{
+	std::size_t const width = image.sizeX;
+	std::size_t const height = image.sizeY;
+
+	if(width == 0 || height == 0)
+		throw std::runtime_error("Can't write an empty image to <" + fileName + ">");
+
+	if(aovs && aovs->Size() != Math::Vector2st(width, height))
+		throw std::runtime_error("The AOV buffer isn't the size of the image");
+
+	// The color is stored planar as well, to write every channel the same way.
+	std::vector<std::vector<float>> colorPlanes(3, std::vector<float>(width * height));
+	for(std::size_t i = 0; i < width * height; ++i)
+	{
+		colorPlanes[0][i] = image.pixels[i].r;
+		colorPlanes[1][i] = image.pixels[i].g;
+		colorPlanes[2][i] = image.pixels[i].b;
+	}
+
+	std::vector<Channel> channels = {
+		{"R", colorPlanes[0].data()},
+		{"G", colorPlanes[1].data()},
+		{"B", colorPlanes[2].data()}};
+
+	if(aovs)
+	{
+		for(AOV const aov: aovs->AOVs())
+		{
+			for(std::size_t c = 0; c < AOVBuffer::ComponentCount(aov); ++c)
+			{
+				channels.push_back({
+					std::string(AOVBuffer::Name(aov)) + "."
+						+ AOVBuffer::ComponentName(aov, c),
+					aovs->Plane(aov, c)});
+			}
+		}
+	}
+
+	// Readers expect the channel list sorted by name, pixels are stored in the
+	// same order.
+	std::sort(
+		channels.begin(),
+		channels.end(),
+		[](Channel const &a, Channel const &b)
+		{
+			return a.name < b.name;
+		});
+
+	std::vector<std::uint8_t> header;
+	AppendBytes(header, magic, 4);
+	AppendBytes(header, version, 4);
+
+	std::vector<std::uint8_t> channelList;
+	for(Channel const &channel: channels)
+	{
+		AppendString(channelList, channel.name);
+		AppendBytes(channelList, floatPixelType, 4);
+
+		// Not perceptually linear, and 3 reserved bytes.
+		AppendBytes(channelList, 0, 4);
+
+		// No subsampling in x and y.
+		AppendBytes(channelList, 1, 4);
+		AppendBytes(channelList, 1, 4);
+	}
+	channelList.push_back(0);
+
+	std::vector<std::uint8_t> window;
+	AppendBytes(window, 0, 4);
+	AppendBytes(window, 0, 4);
+	AppendBytes(window, width - 1, 4);
+	AppendBytes(window, height - 1, 4);
+
+	std::vector<std::uint8_t> one;
+	AppendFloat(one, 1.f);
+
+	AppendAttribute(header, "channels", "chlist", channelList);
+	AppendAttribute(header, "compression", "compression", {0});
+	AppendAttribute(header, "dataWindow", "box2i", window);
+	AppendAttribute(header, "displayWindow", "box2i", window);
+	AppendAttribute(header, "lineOrder", "lineOrder", {0});
+	AppendAttribute(header, "pixelAspectRatio", "float", one);
+	AppendAttribute(header, "screenWindowCenter", "v2f", std::vector<std::uint8_t>(8, 0));
+	AppendAttribute(header, "screenWindowWidth", "float", one);
+	header.push_back(0);
+
+	std::size_t const lineDataSize = channels.size() * width * sizeof(float);
+
+	// Every chunk holds its y and the size of its data before the data.
+	std::size_t const chunkSize = 8 + lineDataSize;
+	std::size_t const firstChunk = header.size() + height * 8;
+
+	for(std::size_t y = 0; y < height; ++y)
+		AppendBytes(header, firstChunk + y * chunkSize, 8);
+
+	using File = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+	File const file(std::fopen(fileName.c_str(), "wb"), &std::fclose);
+	if(!file)
+		throw std::runtime_error("Failed to open <" + fileName + "> for writing");
+
+	auto const write = [&](std::vector<std::uint8_t> const &bytes)
+	{
+		if(std::fwrite(bytes.data(), 1, bytes.size(), file.get()) != bytes.size())
+			throw std::runtime_error("Failed to write to <" + fileName + ">");
+	};
+
+	write(header);
+
+	std::vector<std::uint8_t> chunk;
+	chunk.reserve(chunkSize);
+
+	for(std::size_t y = 0; y < height; ++y)
+	{
+		chunk.clear();
+		AppendBytes(chunk, y, 4);
+		AppendBytes(chunk, lineDataSize, 4);
+
+		for(Channel const &channel: channels)
+		{
+			for(std::size_t x = 0; x < width; ++x)
+				AppendFloat(chunk, channel.plane[y * width + x]);
+		}
+
+		write(chunk);
+	}
+}
+} // namespace LibRay
@@ -0,0 +1,24 @@
+#ifndef c29338fc_8938_4b62_84cc_c12e5fd1dff9
+#define c29338fc_8938_4b62_84cc_c12e5fd1dff9
+
+#include <string>
+
+#include "API.hpp"
+#include "Image.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+class AOVBuffer;
+
+// Writes image as the R, G, and B channels of an uncompressed scanline
+// OpenEXR file, in 32 bit floats without tone mapping. Every AOV in aovs, when
+// given, is added as a layer of channels named like "normal.X". Throws
+// std::runtime_error when the file can't be written.
+LIBRAY_API void WriteEXR(
+	std::string const &fileName,
+	Image const &image,
+	Observer<AOVBuffer const> aovs = nullptr);
+} // namespace LibRay
+
+#endif // c29338fc_8938_4b62_84cc_c12e5fd1dff9
@@ -0,0 +1,35 @@
+#include "GBuffer.hpp"
+
+namespace LibRay
+{
+GBuffer::GBuffer()
+: fingerprint(0)
+, samplesPerPixel(0)
+, hits()
+, lightWordCount(0)
+, visibleLights()
+{
+}
+
+bool GBuffer::IsEmpty() const
+{
+	return fingerprint == 0;
+}
+
+void GBuffer::Clear()
+{
+	fingerprint = 0;
+	samplesPerPixel = 0;
+	lightWordCount = 0;
+
+	// Release the memory, a cleared G-buffer might not be filled again.
+	hits = {};
+	visibleLights = {};
+}
+
+std::size_t GBuffer::MemorySize() const
+{
+	return hits.capacity() * sizeof(hits[0])
+		+ visibleLights.capacity() * sizeof(visibleLights[0]);
+}
+} // namespace LibRay
@@ -0,0 +1,71 @@
+#ifndef cee1b979_0841_49d6_a4b3_f6a08b761687
+#define cee1b979_0841_49d6_a4b3_f6a08b761687
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "API.hpp"
+
+namespace LibRay
+{
+// The primary hit and the lights that reached it for every sample of a frame,
+// filled and replayed by RayTracer::TraceWithGBuffer. Takes 8 bytes per
+// sample and 8 more for every 64 lights, so 225MB for 1280x720 at 16 samples
+// per pixel with up to 64 lights.
+class LIBRAY_API GBuffer final
+{
+public:
+	// Which primitive a primary ray hit. Replaying intersects the ray with
+	// that primitive alone to get the position, normal and uv back.
+	struct Hit
+	{
+		// The index in Scene::Shapes, noIndex where the ray missed.
+		std::uint32_t shape;
+
+		// The index in the model that was hit, noIndex for other shapes.
+		std::uint32_t triangle;
+	};
+
+	static_assert(std::is_copy_constructible_v<Hit>);
+	static_assert(std::is_copy_assignable_v<Hit>);
+	static_assert(std::is_trivially_copyable_v<Hit>);
+
+	static_assert(std::is_move_constructible_v<Hit>);
+	static_assert(std::is_move_assignable_v<Hit>);
+
+	static constexpr std::uint32_t const noIndex =
+		std::numeric_limits<std::uint32_t>::max();
+
+public:
+	GBuffer();
+
+	bool IsEmpty() const;
+	void Clear();
+
+	std::size_t MemorySize() const;
+
+public:
+	// What the hits were traced for, 0 when empty.
+	std::uint64_t fingerprint;
+	std::uint32_t samplesPerPixel;
+
+	// Samples of a pixel are next to each other, pixels are row by row.
+	std::vector<Hit> hits;
+
+	// lightWordCount words per sample, bit i is set when light i of the scene
+	// is in front of the hit and not blocked, however far it reaches.
+	std::size_t lightWordCount;
+	std::vector<std::uint64_t> visibleLights;
+};
+
+static_assert(std::is_copy_constructible_v<GBuffer>);
+static_assert(std::is_copy_assignable_v<GBuffer>);
+static_assert(!std::is_trivially_copyable_v<GBuffer>);
+
+static_assert(std::is_move_constructible_v<GBuffer>);
+static_assert(std::is_move_assignable_v<GBuffer>);
+} // namespace LibRay
+
+#endif // cee1b979_0841_49d6_a4b3_f6a08b761687
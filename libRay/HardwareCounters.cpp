@@ -0,0 +1,248 @@
+#include "HardwareCounters.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace LibRay
+{
+HardwareCounts::HardwareCounts()
+: cycles(0)
+, instructions(0)
+, cacheReferences(0)
+, cacheMisses(0)
+, branches(0)
+, branchMisses(0)
+{
+}
+
+HardwareCounts &HardwareCounts::operator+=(HardwareCounts const &other)
+{
+	cycles += other.cycles;
+	instructions += other.instructions;
+	cacheReferences += other.cacheReferences;
+	cacheMisses += other.cacheMisses;
+	branches += other.branches;
+	branchMisses += other.branchMisses;
+
+	return *this;
+}
+
+double HardwareCounts::InstructionsPerCycle() const
+{
+	return cycles > 0 ? double(instructions) / double(cycles) : 0.;
+}
+
+double HardwareCounts::CacheMissRate() const
+{
+	return cacheReferences > 0 ? double(cacheMisses) / double(cacheReferences) : 0.;
+}
+
+double HardwareCounts::BranchMissRate() const
+{
+	return branches > 0 ? double(branchMisses) / double(branches) : 0.;
+}
+
+namespace Instrumentation
+{
+// In the order of HardwareCounts, the first leads the group.
+constexpr std::size_t const counterCount = 6;
+
+// Kept trivially destructible, the counters are closed explicitly.
+struct CounterGroup
+{
+	std::array<int, counterCount> descriptors;
+	bool opened;
+
+	// errno of the counter that failed to open, 0 when none did.
+	int error;
+	std::size_t failedCounter;
+};
+
+static thread_local CounterGroup counterGroup{{-1, -1, -1, -1, -1, -1}, false, 0, 0};
+
+#ifdef __linux__
+constexpr std::array<char const *, counterCount> const counterNames =
+{
+	"cycles",
+	"instructions",
+	"cache references",
+	"cache misses",
+	"branches",
+	"branch misses"
+};
+
+constexpr std::array<std::uint64_t, counterCount> const counterConfigs =
+{
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_REFERENCES,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int OpenCounter(std::uint64_t config, int groupLeader)
+{
+	perf_event_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.config = config;
+	attributes.read_format = PERF_FORMAT_GROUP
+		| PERF_FORMAT_TOTAL_TIME_ENABLED
+		| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	// The group starts counting as a whole once it's complete.
+	attributes.disabled = groupLeader == -1 ? 1 : 0;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	// The calling thread, on any processor.
+	return int(syscall(SYS_perf_event_open, &attributes, 0, -1, groupLeader, 0));
+}
+
+static bool OpenCounterGroup(CounterGroup &group)
+{
+	group.opened = true;
+
+	for(std::size_t i = 0; i < counterCount; ++i)
+	{
+		int const descriptor = OpenCounter(counterConfigs[i], group.descriptors[0]);
+		if(descriptor == -1)
+		{
+			group.error = errno;
+			group.failedCounter = i;
+
+			CloseHardwareCounters();
+			group.opened = true;
+
+			return false;
+		}
+
+		group.descriptors[i] = descriptor;
+	}
+
+	ioctl(group.descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(group.descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	return true;
+}
+#endif // __linux__
+
+std::optional<HardwareReading> ReadHardwareCounters()
+{
+#ifdef __linux__
+	CounterGroup &group = counterGroup;
+
+	if(!group.opened && !OpenCounterGroup(group))
+		return std::nullopt;
+
+	if(group.descriptors[0] == -1)
+		return std::nullopt;
+
+	// The count of values, the times, and the values in the order of the group.
+	std::array<std::uint64_t, 3 + counterCount> values{};
+	ssize_t const size = read(group.descriptors[0], values.data(), sizeof(values));
+
+	if(size != ssize_t(sizeof(values)) || values[0] != counterCount)
+		return std::nullopt;
+
+	HardwareReading reading;
+	reading.timeEnabled = values[1];
+	reading.timeRunning = values[2];
+	reading.counts.cycles = values[3];
+	reading.counts.instructions = values[4];
+	reading.counts.cacheReferences = values[5];
+	reading.counts.cacheMisses = values[6];
+	reading.counts.branches = values[7];
+	reading.counts.branchMisses = values[8];
+
+	return reading;
+#else
+	return std::nullopt;
+#endif
+}
+
+std::string HardwareCountersError()
+{
+#ifdef __linux__
+	CounterGroup const &group = counterGroup;
+
+	if(group.error == 0)
+		return std::string();
+
+	std::string error =
+		std::string("Unable to count ")
+		+ counterNames[group.failedCounter]
+		+ ", perf_event_open failed: "
+		+ std::strerror(group.error);
+
+	if(group.error == EACCES || group.error == EPERM)
+		error += ", see /proc/sys/kernel/perf_event_paranoid";
+	else if(group.error == ENOENT || group.error == ENODEV || group.error == EOPNOTSUPP)
+		error += ", the processor or virtual machine has no such counter";
+
+	return error;
+#else
+	return "Hardware counters are only supported on Linux";
+#endif
+}
+
+void CloseHardwareCounters()
+{
+	CounterGroup &group = counterGroup;
+
+	// Members of a group are closed before their leader.
+	for(std::size_t i = counterCount; i-- > 0;)
+	{
+#ifdef __linux__
+		if(group.descriptors[i] != -1)
+			close(group.descriptors[i]);
+#endif
+
+		group.descriptors[i] = -1;
+	}
+
+	group.opened = false;
+}
+
+HardwareCounts HardwareCountsBetween(
+	HardwareReading const &start,
+	HardwareReading const &end)
+{
+	std::uint64_t const enabled = end.timeEnabled - start.timeEnabled;
+	std::uint64_t const running = end.timeRunning - start.timeRunning;
+
+	// Counters that never ran in between counted nothing that can be scaled.
+	if(running == 0)
+		return HardwareCounts();
+
+	double const scale = double(enabled) / double(running);
+
+	auto const between = [scale](std::uint64_t first, std::uint64_t last)
+	{
+		return std::uint64_t(double(last - first) * scale + 0.5);
+	};
+
+	HardwareCounts counts;
+	counts.cycles = between(start.counts.cycles, end.counts.cycles);
+	counts.instructions = between(start.counts.instructions, end.counts.instructions);
+	counts.cacheReferences =
+		between(start.counts.cacheReferences, end.counts.cacheReferences);
+	counts.cacheMisses = between(start.counts.cacheMisses, end.counts.cacheMisses);
+	counts.branches = between(start.counts.branches, end.counts.branches);
+	counts.branchMisses = between(start.counts.branchMisses, end.counts.branchMisses);
+
+	return counts;
+}
+} // namespace Instrumentation
+} // namespace LibRay
@@ -0,0 +1,92 @@
+#ifndef e7bb5b86_357e_4c87_a4b9_3ae27fd3890a
+#define e7bb5b86_357e_4c87_a4b9_3ae27fd3890a
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include "Threading/Tile.hpp"
+#include "API.hpp"
+
+namespace LibRay
+{
+// What the performance monitoring unit of the processor counted while running
+// libRay, excluding the kernel.
+struct LIBRAY_API HardwareCounts final
+{
+	HardwareCounts();
+
+	HardwareCounts &operator+=(HardwareCounts const &other);
+
+	double InstructionsPerCycle() const;
+
+	// Of the cache references, which are mostly last level cache accesses.
+	double CacheMissRate() const;
+
+	double BranchMissRate() const;
+
+	std::uint64_t cycles;
+	std::uint64_t instructions;
+	std::uint64_t cacheReferences;
+	std::uint64_t cacheMisses;
+	std::uint64_t branches;
+	std::uint64_t branchMisses;
+};
+
+static_assert(std::is_copy_constructible_v<HardwareCounts>);
+static_assert(std::is_copy_assignable_v<HardwareCounts>);
+static_assert(std::is_trivially_copyable_v<HardwareCounts>);
+
+static_assert(std::is_move_constructible_v<HardwareCounts>);
+static_assert(std::is_move_assignable_v<HardwareCounts>);
+
+// The counts of rendering the pixels of one tile, as it was when finished.
+// Tiles that handed off rows to other workers are smaller than they started.
+struct LIBRAY_API TileHardwareCounts final
+{
+	Threading::Tile tile;
+	HardwareCounts counts;
+};
+
+static_assert(std::is_copy_constructible_v<TileHardwareCounts>);
+static_assert(std::is_copy_assignable_v<TileHardwareCounts>);
+static_assert(std::is_trivially_copyable_v<TileHardwareCounts>);
+
+static_assert(std::is_move_constructible_v<TileHardwareCounts>);
+static_assert(std::is_move_assignable_v<TileHardwareCounts>);
+
+namespace Instrumentation
+{
+// The running counts of a thread, with the nanoseconds they were enabled and
+// actually counting. The kernel shares the counters between programs when
+// there are too few, and they only count part of the time.
+struct LIBRAY_API HardwareReading final
+{
+	HardwareCounts counts;
+	std::uint64_t timeEnabled = 0;
+	std::uint64_t timeRunning = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<HardwareReading>);
+
+// Reads the counters of the calling thread, which are opened the first time,
+// and stay open until CloseHardwareCounters. Returns nullopt when they can't
+// be opened, see HardwareCountersError. Counting is done with perf_event_open
+// on Linux, and unavailable elsewhere.
+LIBRAY_API std::optional<HardwareReading> ReadHardwareCounters();
+
+// Why the counters of the calling thread couldn't be opened.
+LIBRAY_API std::string HardwareCountersError();
+
+LIBRAY_API void CloseHardwareCounters();
+
+// What was counted between two readings of the same thread, scaled up for the
+// time the counters weren't running.
+LIBRAY_API HardwareCounts HardwareCountsBetween(
+	HardwareReading const &start,
+	HardwareReading const &end);
+} // namespace Instrumentation
+} // namespace LibRay
+
+#endif // e7bb5b86_357e_4c87_a4b9_3ae27fd3890a
@@ -0,0 +1,69 @@
+#include "Heatmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Material/Color.hpp"
+
+namespace LibRay
+{
+using namespace Materials;
+
+constexpr float const scalePercentile = 0.99f;
+
+float HeatmapScale(Observer<float const> values, std::size_t count)
+{
+	if(count == 0)
+		return 0.f;
+
+	std::vector<float> sorted(values, values + count);
+
+	std::size_t const index =
+		std::min(std::size_t(float(count) * scalePercentile), count - 1);
+
+	std::nth_element(sorted.begin(), sorted.begin() + std::ptrdiff_t(index), sorted.end());
+
+	// When most pixels are 0, like for rays only glass spawns, the scale ends
+	// at the largest value instead.
+	if(sorted[index] <= 0.f)
+		return *std::max_element(sorted.begin(), sorted.end());
+
+	return sorted[index];
+}
+
+Image MakeHeatmap(Observer<float const> values, Math::Vector2st const &size)
+{
+	std::size_t const count = size.x * size.y;
+
+	float const scale = HeatmapScale(values, count);
+	float const inverseScale = scale > 0.f ? 1.f / scale : 0.f;
+
+	// Evenly spaced along the scale.
+	std::array<Color, 6> const gradient = {
+		Color(0.f, 0.f, 0.3f),
+		Color(0.f, 0.2f, 1.f),
+		Color(0.f, 1.f, 1.f),
+		Color(0.f, 1.f, 0.f),
+		Color(1.f, 1.f, 0.f),
+		Color(1.f, 0.f, 0.f)};
+
+	Image heatmap(size.x, size.y);
+
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		float const position = std::clamp(values[i] * inverseScale, 0.f, 1.f)
+			* float(gradient.size() - 1);
+
+		std::size_t const stop =
+			std::min(std::size_t(position), gradient.size() - 2);
+
+		float const t = position - float(stop);
+
+		heatmap.pixels.emplace_back(
+			gradient[stop] * (1.f - t) + gradient[stop + 1] * t);
+	}
+
+	return heatmap;
+}
+} // namespace LibRay
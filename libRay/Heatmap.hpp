@@ -0,0 +1,25 @@
+#ifndef b8d0cdd7_9fc1_4fc8_945f_5d29e2b3f0ca
+#define b8d0cdd7_9fc1_4fc8_945f_5d29e2b3f0ca
+
+#include <cstddef>
+
+#include "Math/Vector.hpp"
+#include "API.hpp"
+#include "Image.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+// Colors values, a plane of size, from dark blue at 0 through cyan, green,
+// and yellow to red at the top of the scale. The scale ends at the value only
+// 1 in 100 pixels goes over, so a few outliers don't leave the rest of the
+// image dark, or at the largest value when that one is 0. The colors are ready to be written, without tone mapping.
+LIBRAY_API Image MakeHeatmap(
+	Observer<float const> values,
+	Math::Vector2st const &size);
+
+// The value MakeHeatmap colors red.
+LIBRAY_API float HeatmapScale(Observer<float const> values, std::size_t count);
+} // namespace LibRay
+
+#endif // b8d0cdd7_9fc1_4fc8_945f_5d29e2b3f0ca
@@ -11,6 +11,7 @@ Intersection::Intersection(
 	Vector3 const &worldPosition,
 	Vector2 const &uv)
 : shape(&shape)
+, triangle(nullptr)
 , surfaceNormal(glm::normalize(surfaceNormal))
 , surfaceTangent()
 , worldPosition(worldPosition)
@@ -25,6 +26,7 @@ Intersection::Intersection(
 	Vector3 const &worldPosition,
 	Vector2 const &uv)
 : shape(&shape)
+, triangle(nullptr)
 , surfaceNormal(glm::normalize(surfaceNormal))
 , surfaceTangent(glm::normalize(surfaceTangent))
 , worldPosition(worldPosition)
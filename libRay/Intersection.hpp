@@ -11,6 +11,7 @@ namespace LibRay
 {
 namespace Shapes
 {
+class ModelTriangle;
 class Shape;
 } // namespace Shapes
 
@@ -32,6 +33,9 @@ public:
 
 public:
 	Observer<Shapes::Shape const> shape;
+
+	// The triangle that was hit, when shape is a model.
+	Observer<Shapes::ModelTriangle const> triangle;
 	Math::Vector3 surfaceNormal;
 	Math::Vector3 surfaceTangent;
 	Math::Vector3 worldPosition;
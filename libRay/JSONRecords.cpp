@@ -0,0 +1,142 @@
+#include "JSONRecords.hpp"
+
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace LibRay
+{
+std::vector<JSONRecord> ReadJSONRecords(
+	std::string const &fileName,
+	std::string const &arrayName)
+{
+	std::ifstream file(fileName);
+	if(!file)
+		throw std::runtime_error("Failed to open <" + fileName + ">");
+
+	std::string const text(
+		(std::istreambuf_iterator<char>(file)),
+		std::istreambuf_iterator<char>());
+
+	auto const fail = [&]()
+	{
+		throw std::runtime_error(
+			"<" + fileName + "> has no array <" + arrayName + "> of flat objects");
+	};
+
+	std::size_t position = text.find("\"" + arrayName + "\"");
+	if(position == std::string::npos)
+		fail();
+
+	position = text.find('[', position);
+	if(position == std::string::npos)
+		fail();
+
+	++position;
+
+	auto const skipSpace = [&]()
+	{
+		while(position < text.size() && std::isspace(std::uint8_t(text[position])))
+			++position;
+	};
+
+	auto const readToken = [&]()
+	{
+		skipSpace();
+		if(position >= text.size())
+			fail();
+
+		std::string token;
+		if(text[position] == '"')
+		{
+			std::size_t const end = text.find('"', position + 1);
+			if(end == std::string::npos)
+				fail();
+
+			token = text.substr(position + 1, end - position - 1);
+			position = end + 1;
+		}
+		else
+		{
+			std::size_t const end = text.find_first_of(",}] \t\r\n", position);
+			if(end == std::string::npos || end == position)
+				fail();
+
+			token = text.substr(position, end - position);
+			position = end;
+		}
+
+		return token;
+	};
+
+	auto const expect = [&](char c)
+	{
+		skipSpace();
+		if(position >= text.size() || text[position] != c)
+			fail();
+
+		++position;
+	};
+
+	// Skips the comma between elements, if there is one.
+	auto const skipComma = [&]()
+	{
+		skipSpace();
+		if(position < text.size() && text[position] == ',')
+			++position;
+
+		skipSpace();
+	};
+
+	std::vector<JSONRecord> records;
+
+	skipSpace();
+	while(position < text.size() && text[position] != ']')
+	{
+		expect('{');
+
+		JSONRecord record;
+
+		skipSpace();
+		while(position < text.size() && text[position] != '}')
+		{
+			std::string const key = readToken();
+			expect(':');
+			record[key] = readToken();
+
+			skipComma();
+		}
+
+		expect('}');
+		records.push_back(std::move(record));
+
+		skipComma();
+	}
+
+	expect(']');
+
+	return records;
+}
+
+double RecordNumber(
+	JSONRecord const &record,
+	std::string const &key,
+	double fallback)
+{
+	auto const it = record.find(key);
+	if(it == record.end())
+		return fallback;
+
+	try
+	{
+		return std::stod(it->second);
+	}
+	catch(std::exception const &)
+	{
+		return fallback;
+	}
+}
+} // namespace LibRay
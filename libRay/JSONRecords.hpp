@@ -0,0 +1,30 @@
+#ifndef ceda3902_74a9_4d5d_a7a8_f9ce7af74c54
+#define ceda3902_74a9_4d5d_a7a8_f9ce7af74c54
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "API.hpp"
+
+namespace LibRay
+{
+// The keys of an object mapped to their strings or numbers.
+using JSONRecord = std::map<std::string, std::string>;
+
+// Reads the flat objects in the array named arrayName of a JSON file, like
+// the results the benchmarks write. Nested objects and arrays, and escapes
+// in strings, aren't supported. Throws std::runtime_error when the file can't
+// be read or isn't laid out like that.
+LIBRAY_API std::vector<JSONRecord> ReadJSONRecords(
+	std::string const &fileName,
+	std::string const &arrayName);
+
+// The number stored under key, or fallback when record doesn't have it.
+LIBRAY_API double RecordNumber(
+	JSONRecord const &record,
+	std::string const &key,
+	double fallback = 0.);
+} // namespace LibRay
+
+#endif // ceda3902_74a9_4d5d_a7a8_f9ce7af74c54
@@ -1,8 +1,12 @@
 #include "Material.hpp"
 
+#include <algorithm>
 #include <cstdio>
+#include <vector>
 
 #include "../Math/MathUtils.hpp"
+#include "../Shaders/Shader.hpp"
+#include "../Utilites.hpp"
 
 namespace LibRay::Materials
 {
@@ -109,6 +113,48 @@ Texture const &Material::TexturePropertyByName(std::string const &name) const
 	return it->second;
 }
 
+std::unordered_map<std::string, Texture> const &Material::TextureProperties() const
+{
+	return textureProperties;
+}
+
+std::uint64_t Material::Fingerprint() const
+{
+	Hasher hasher;
+	hasher
+		.Add(std::string(shader.Name()))
+		.Add(reflectiveness)
+		.Add(refractiveIndexInside)
+		.Add(refractiveIndexOutside);
+
+	// The maps don't keep an order, the hash has to.
+	auto const sortedNames = [](auto const &properties)
+	{
+		std::vector<std::string> names;
+		names.reserve(properties.size());
+		for(auto const &property: properties)
+			names.push_back(property.first);
+
+		std::sort(names.begin(), names.end());
+
+		return names;
+	};
+
+	for(std::string const &name: sortedNames(floatProperties))
+		hasher.Add(name).Add(floatProperties.at(name));
+
+	for(std::string const &name: sortedNames(colorProperties))
+	{
+		Color const &color = colorProperties.at(name);
+		hasher.Add(name).Add(color.r).Add(color.g).Add(color.b);
+	}
+
+	for(std::string const &name: sortedNames(textureProperties))
+		hasher.Add(name).Add(textureProperties.at(name).Fingerprint());
+
+	return hasher.Value();
+}
+
 void Material::Reflectiveness(float newReflectiveness)
 {
 	reflectiveness = newReflectiveness;
@@ -41,6 +41,11 @@ public:
 	void UpdateTextureProperty(std::string const &name, Texture texture);
 	Texture const &TexturePropertyByName(std::string const &name) const;
 
+	std::unordered_map<std::string, Texture> const &TextureProperties() const;
+
+	// Changes whenever the shader, a property, or a texture changes.
+	std::uint64_t Fingerprint() const;
+
 	void Reflectiveness(float newReflectiveness);
 	float Reflectiveness() const;
 
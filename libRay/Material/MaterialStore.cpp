@@ -36,6 +36,13 @@ Material const &MaterialStore::MaterialByIndex(IndexType index) const
 	return materials[index].second;
 }
 
+Material &MaterialStore::MaterialByIndex(IndexType index)
+{
+	assert(index < materials.size());
+
+	return materials[index].second;
+}
+
 MaterialStore::IndexType MaterialStore::MaterialIndexByName(
 	std::string const &name) const
 {
@@ -48,4 +55,9 @@ MaterialStore::IndexType MaterialStore::MaterialIndexByName(
 	throw std::runtime_error(
 		"Material with name <" + name + "> doesn't exist!\n");
 }
+
+MaterialStore::ContainerType const &MaterialStore::Materials() const
+{
+	return materials;
+}
 } // namespace LibRay::Materials
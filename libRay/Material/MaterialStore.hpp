@@ -25,8 +25,12 @@ public:
 
 	IndexType AddMaterial(std::string const &name, Material material);
 	Material const &MaterialByIndex(IndexType index) const;
+	Material &MaterialByIndex(IndexType index);
 	IndexType MaterialIndexByName(std::string const &name) const;
 
+	// The materials with their names, by index.
+	ContainerType const &Materials() const;
+
 private:
 	ContainerType materials;
 };
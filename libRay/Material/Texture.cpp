@@ -7,6 +7,9 @@
 #include <stb/stb_image.h>
 
 #include "../Math/MathUtils.hpp"
+#include "../Statistics.hpp"
+#include "../Timeline.hpp"
+#include "../Utilites.hpp"
 
 namespace LibRay::Materials
 {
@@ -22,6 +25,8 @@ Texture::Texture(
 , wrapMethodU(wrapMethodU)
 , wrapMethodV(wrapMethodV)
 {
+	Timeline::Span const span("Decode texture", fileName);
+
 	stbi_set_flip_vertically_on_load(flipY);
 
 	int width, height, channels;
@@ -128,6 +133,8 @@ Texture::WrappingMethod Texture::WrapMethodV() const
 
 Color const &Texture::Sample(float u, float v) const
 {
+	Instrumentation::CountTextureSample();
+
 	switch(wrapMethodU)
 	{
 	case WrappingMethod::Repeat:
@@ -182,6 +189,31 @@ Color const &Texture::Sample(float u, float v) const
 	return rgbData[x + y * dimensions.x];
 }
 
+Vector2st const &Texture::Dimensions() const
+{
+	return dimensions;
+}
+
+std::size_t Texture::MemorySize() const
+{
+	return rgbData.capacity() * sizeof(rgbData[0]);
+}
+
+std::uint64_t Texture::Fingerprint() const
+{
+	Hasher hasher;
+	hasher
+		.Add(std::uint64_t(dimensions.x))
+		.Add(std::uint64_t(dimensions.y))
+		.Add(std::uint64_t(wrapMethodU))
+		.Add(std::uint64_t(wrapMethodV));
+
+	for(Color const &color: rgbData)
+		hasher.Add(color.r).Add(color.g).Add(color.b);
+
+	return hasher.Value();
+}
+
 Texture const &Texture::Black()
 {
 	static Texture texture(
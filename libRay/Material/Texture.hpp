@@ -7,11 +7,12 @@
 #include <vector>
 
 #include "../Math/Vector.hpp"
+#include "../API.hpp"
 #include "Color.hpp"
 
 namespace LibRay::Materials
 {
-class Texture final
+class LIBRAY_API Texture final
 {
 public:
 	enum class WrappingMethod
@@ -57,6 +58,14 @@ public:
 
 	Color const &Sample(float u, float v) const;
 
+	Math::Vector2st const &Dimensions() const;
+
+	// Bytes of pixels, every copy of a texture has its own.
+	std::size_t MemorySize() const;
+
+	// Hashes the dimensions, wrapping, and every pixel.
+	std::uint64_t Fingerprint() const;
+
 	// Built-in 1x1 textures
 	static Texture const &Black();
 	static Texture const &Blue();
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
 #include <tuple>
 
 namespace LibRay::Math
@@ -20,6 +21,32 @@ inline float Degrees(float radians)
 	return radians * (180.f / PI);
 }
 
+// Maps 32 random bits to [0, 1). Uses the top 24 bits, which a float holds
+// exactly, so the result is always strictly below 1.
+inline float ToUnitFloat(std::uint32_t value)
+{
+	return float(value >> 8) * (1.f / 16777216.f);
+}
+
+// SplitMix64, returns a number in [0, 1). Used instead of <random>, whose
+// distributions differ between standard libraries.
+inline float NextRandom(std::uint64_t &state)
+{
+	state += 0x9e3779b97f4a7c15ull;
+
+	std::uint64_t word = state;
+	word = (word ^ (word >> 30)) * 0xbf58476d1ce4e5b9ull;
+	word = (word ^ (word >> 27)) * 0x94d049bb133111ebull;
+	word ^= word >> 31;
+
+	return ToUnitFloat(std::uint32_t(word >> 32));
+}
+
+inline float RandomRange(std::uint64_t &state, float min, float max)
+{
+	return min + (max - min) * NextRandom(state);
+}
+
 template<typename T> int Sign(T val)
 {
 	return (T(0) < val) - (T(0) > val);
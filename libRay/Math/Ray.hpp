@@ -4,11 +4,12 @@
 #include <type_traits>
 #include <string>
 
+#include "../API.hpp"
 #include "Vector.hpp"
 
 namespace LibRay::Math
 {
-class Ray final
+class LIBRAY_API Ray final
 {
 public:
 	Ray(Vector3 const &origin, Vector3 const &direction);
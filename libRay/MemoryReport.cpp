@@ -0,0 +1,161 @@
+#include "MemoryReport.hpp"
+
+#include <cstdio>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace LibRay
+{
+static std::string Megabytes(std::size_t bytes)
+{
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.1f MiB", double(bytes) / (1024. * 1024.));
+
+	return buffer;
+}
+
+MemoryReport::MemoryReport()
+: textures()
+, models()
+, sceneBVH()
+, framebufferBytes(0)
+, peakResidentBytes(0)
+{
+}
+
+std::size_t MemoryReport::TextureBytes() const
+{
+	std::size_t bytes = 0;
+	for(TextureMemory const &texture: textures)
+		bytes += texture.bytes;
+
+	return bytes;
+}
+
+std::map<std::string, std::size_t> MemoryReport::TextureBytesPerMaterial() const
+{
+	std::map<std::string, std::size_t> materials;
+	for(TextureMemory const &texture: textures)
+		materials[texture.material] += texture.bytes;
+
+	return materials;
+}
+
+std::size_t MemoryReport::VertexBytes() const
+{
+	std::size_t bytes = 0;
+	for(ModelMemory const &model: models)
+		bytes += model.vertexBytes;
+
+	return bytes;
+}
+
+std::size_t MemoryReport::TriangleBytes() const
+{
+	std::size_t bytes = 0;
+	for(ModelMemory const &model: models)
+		bytes += model.triangleBytes;
+
+	return bytes;
+}
+
+Containers::BVHMemory MemoryReport::BVHTotal() const
+{
+	Containers::BVHMemory total = sceneBVH;
+
+	for(ModelMemory const &model: models)
+	{
+		total.nodeCount += model.bvh.nodeCount;
+		total.nodeBytes += model.bvh.nodeBytes;
+		total.leafCount += model.bvh.leafCount;
+		total.leafBytes += model.bvh.leafBytes;
+	}
+
+	return total;
+}
+
+std::size_t MemoryReport::TotalBytes() const
+{
+	Containers::BVHMemory const bvh = BVHTotal();
+
+	return TextureBytes()
+		+ VertexBytes()
+		+ TriangleBytes()
+		+ bvh.nodeBytes
+		+ bvh.leafBytes
+		+ framebufferBytes;
+}
+
+std::string MemoryReport::Summary() const
+{
+	Containers::BVHMemory const bvh = BVHTotal();
+
+	std::string summary =
+		"Scene memory: " + Megabytes(TotalBytes())
+		+ ", textures " + Megabytes(TextureBytes())
+		+ " in " + std::to_string(textures.size())
+		+ ", vertices " + Megabytes(VertexBytes())
+		+ ", triangles " + Megabytes(TriangleBytes())
+		+ ", BVH nodes " + Megabytes(bvh.nodeBytes)
+		+ " and leaves " + Megabytes(bvh.leafBytes)
+		+ ", framebuffer " + Megabytes(framebufferBytes);
+
+	if(peakResidentBytes > 0)
+		summary += ", peak RSS " + Megabytes(peakResidentBytes);
+
+	return summary + "\n";
+}
+
+std::string MemoryReport::Report() const
+{
+	std::string report = "Textures per material:\n";
+	for(auto const &[material, bytes]: TextureBytesPerMaterial())
+		report += "  " + Megabytes(bytes) + "  " + material + "\n";
+
+	report += "Textures:\n";
+	for(TextureMemory const &texture: textures)
+	{
+		report += "  " + Megabytes(texture.bytes)
+			+ "  " + std::to_string(texture.dimensions.x)
+			+ "x" + std::to_string(texture.dimensions.y)
+			+ "  " + texture.material + " " + texture.property + "\n";
+	}
+
+	report += "Models:\n";
+	for(ModelMemory const &model: models)
+	{
+		report += "  shape " + std::to_string(model.shapeIndex)
+			+ ": " + std::to_string(model.triangleCount) + " triangles"
+			+ ", vertices " + Megabytes(model.vertexBytes)
+			+ ", triangles " + Megabytes(model.triangleBytes)
+			+ ", " + std::to_string(model.bvh.nodeCount) + " BVH nodes "
+			+ Megabytes(model.bvh.nodeBytes)
+			+ ", " + std::to_string(model.bvh.leafCount) + " leaves "
+			+ Megabytes(model.bvh.leafBytes) + "\n";
+	}
+
+	report += "Scene BVH: "
+		+ std::to_string(sceneBVH.nodeCount) + " nodes "
+		+ Megabytes(sceneBVH.nodeBytes)
+		+ ", " + std::to_string(sceneBVH.leafCount) + " leaves "
+		+ Megabytes(sceneBVH.leafBytes) + "\n";
+
+	return report;
+}
+
+std::size_t PeakResidentBytes()
+{
+#ifdef __linux__
+	rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// In kilobytes on Linux.
+	return std::size_t(usage.ru_maxrss) * 1024;
+#else
+	return 0;
+#endif
+}
+} // namespace LibRay
@@ -0,0 +1,91 @@
+#ifndef d9d4b808_70f0_4bfb_8611_1d25de5d62ba
+#define d9d4b808_70f0_4bfb_8611_1d25de5d62ba
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Containers/BoundingVolumeHierarchy.hpp"
+#include "Math/Vector.hpp"
+#include "API.hpp"
+
+namespace LibRay
+{
+// Where the memory of a scene goes, see Scene::Memory. Counts what the
+// containers allocated, not what the allocator keeps around them.
+struct LIBRAY_API MemoryReport final
+{
+	// A texture property of a material. Materials hold their textures by
+	// value, so a texture used by two materials is counted twice, as it's
+	// stored twice.
+	struct TextureMemory
+	{
+		std::string material;
+		std::string property;
+		Math::Vector2st dimensions;
+		std::size_t bytes;
+	};
+
+	struct ModelMemory
+	{
+		// In Scene::Shapes, or past its end for the meshes of instances.
+		std::size_t shapeIndex;
+		std::size_t triangleCount;
+
+		// The vertices, which are held by the triangles.
+		std::size_t vertexBytes;
+
+		// The rest of the array of ModelTriangles.
+		std::size_t triangleBytes;
+
+		Containers::BVHMemory bvh;
+	};
+
+	MemoryReport();
+
+	std::size_t TextureBytes() const;
+
+	// Keyed by the name of the material.
+	std::map<std::string, std::size_t> TextureBytesPerMaterial() const;
+
+	std::size_t VertexBytes() const;
+	std::size_t TriangleBytes() const;
+
+	// Of the hierarchies of every model, and of the scene.
+	Containers::BVHMemory BVHTotal() const;
+
+	// Everything counted, peakResidentBytes aside.
+	std::size_t TotalBytes() const;
+
+	// A single line with the totals, for the log.
+	std::string Summary() const;
+
+	// Every material, texture, and model, one per line, to go with Summary.
+	std::string Report() const;
+
+	std::vector<TextureMemory> textures;
+	std::vector<ModelMemory> models;
+	Containers::BVHMemory sceneBVH;
+
+	// A single float image of the size of the camera, renders allocate one
+	// to accumulate samples in.
+	std::size_t framebufferBytes;
+
+	// The most the process had in physical memory so far, 0 where unknown.
+	std::size_t peakResidentBytes;
+};
+
+static_assert(std::is_copy_constructible_v<MemoryReport>);
+static_assert(std::is_copy_assignable_v<MemoryReport>);
+static_assert(!std::is_trivially_copyable_v<MemoryReport>);
+
+static_assert(std::is_move_constructible_v<MemoryReport>);
+static_assert(std::is_move_assignable_v<MemoryReport>);
+
+// The peak resident set size of the process on Linux, 0 elsewhere.
+LIBRAY_API std::size_t PeakResidentBytes();
+} // namespace LibRay
+
+#endif // d9d4b808_70f0_4bfb_8611_1d25de5d62ba
@@ -0,0 +1,65 @@
+#ifndef c56135bb_ba33_4b1c_9a5f_297e44b4c07d
+#define c56135bb_ba33_4b1c_9a5f_297e44b4c07d
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+enum class RayType : std::uint8_t
+{
+	Primary,
+	Reflection,
+	Refraction,
+	Shadow
+};
+
+constexpr std::size_t const rayTypeCount = 4;
+
+inline char const *RayTypeName(RayType type)
+{
+	switch(type)
+	{
+	case RayType::Primary:
+		return "primary";
+	case RayType::Reflection:
+		return "reflection";
+	case RayType::Refraction:
+		return "refraction";
+	case RayType::Shadow:
+		return "shadow";
+	}
+
+	return "unknown";
+}
+
+// The work tracing the samples of one pixel took.
+struct PixelCost final
+{
+	// Bounding volume hierarchy nodes entered, in the scene and in models.
+	std::uint64_t nodeVisits = 0;
+
+	// Shapes and triangles tested against a ray.
+	std::uint64_t primitiveTests = 0;
+
+	// Indexed by RayType.
+	std::array<std::uint64_t, rayTypeCount> rays{};
+};
+
+static_assert(std::is_copy_constructible_v<PixelCost>);
+static_assert(std::is_copy_assignable_v<PixelCost>);
+static_assert(std::is_trivially_copyable_v<PixelCost>);
+
+static_assert(std::is_move_constructible_v<PixelCost>);
+static_assert(std::is_move_assignable_v<PixelCost>);
+
+// Set by a rendering thread while it counts the cost of a pixel, the rest of
+// the time counting is skipped.
+inline thread_local Observer<PixelCost> currentPixelCost = nullptr;
+} // namespace LibRay
+
+#endif // c56135bb_ba33_4b1c_9a5f_297e44b4c07d
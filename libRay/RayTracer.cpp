@@ -1,8 +1,14 @@
 #include "RayTracer.hpp"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <stdexcept>
+#include <string>
 
 #include "Material/Color.hpp"
 #include "Material/Material.hpp"
@@ -10,12 +16,19 @@
 #include "Math/Matrix.hpp"
 #include "Math/Ray.hpp"
 #include "Shaders/Shader.hpp"
+#include "Shapes/Model/Model.hpp"
+#include "Shapes/Model/ModelTriangle.hpp"
 #include "Shapes/Shape.hpp"
 #include "Threading/TaskProcessor.hpp"
+#include "AOVBuffer.hpp"
+#include "Checkpoint.hpp"
+#include "GBuffer.hpp"
 #include "Image.hpp"
 #include "Intersection.hpp"
 #include "Light.hpp"
 #include "Scene.hpp"
+#include "Statistics.hpp"
+#include "Timeline.hpp"
 #include "Utilites.hpp"
 
 namespace LibRay
@@ -26,6 +39,31 @@ using namespace Shapes;
 
 constexpr float const bias = 0.005f;
 
+// The last opaque object that blocked a shadow ray to each light, kept per
+// thread so neighbouring pixels of a tile reuse it without locking.
+struct ShadowOccluderCache
+{
+	struct Occluder
+	{
+		Observer<Shape const> shape = nullptr;
+
+		// Only the triangle is tested when the occluder was a model.
+		Observer<ModelTriangle const> triangle = nullptr;
+	};
+
+	// The cache is dropped when a thread renders another scene.
+	std::uint64_t sceneId = 0;
+	std::vector<Occluder> occluders;
+
+	std::uint64_t lookups = 0;
+	std::uint64_t hits = 0;
+
+	// Set for the pass a worker renders, off for rays traced outside of one.
+	bool enabled = false;
+};
+
+static thread_local ShadowOccluderCache shadowOccluderCache;
+
 static std::string indent(int n)
 {
 	return std::string(size_t(n), '\t');
@@ -33,97 +71,547 @@ static std::string indent(int n)
 
 RayTracerConfiguration::RayTracerConfiguration(
 	std::uint8_t maxReflectionBounces,
-	std::uint8_t threadCount,
-	AntiAliasingMode aaMode)
+	std::uint32_t threadCount,
+	std::uint32_t samplesPerPixel,
+	Sampling::SamplerType samplerType)
 : maxReflectionBounces(maxReflectionBounces)
 , threadCount(threadCount)
-, aaMode(aaMode)
+, samplesPerPixel(std::max(samplesPerPixel, 1u))
+, samplerType(samplerType)
+, threadPlacement(Threading::ThreadPlacement::Default)
+, minimumContribution(0.01f)
+, cacheShadowOccluders(true)
+, tileSize(32)
+, tileOrder(Threading::TileOrder::Hilbert)
+, hardwareCounters(false)
 {
 }
 
 RayTracer::RayTracer(Scene const &scene, RayTracerConfiguration &&config)
+: RayTracer(
+	scene,
+	std::move(config),
+	std::make_shared<Threading::TaskProcessor>(
+		config.threadCount,
+		config.threadPlacement))
+{
+}
+
+RayTracer::RayTracer(
+	Scene const &scene,
+	RayTracerConfiguration &&config,
+	std::shared_ptr<Threading::TaskProcessor> taskProcessor)
 : scene(scene)
 , configuration(std::move(config))
+, sampler(Sampling::Sampler::Create(configuration.samplerType, scene.Seed()))
+, taskProcessor(std::move(taskProcessor))
+, counters(std::make_shared<Counters>())
 {
-	raySteps.reserve(size_t(configuration.aaMode));
+}
 
-	Camera const &camera = scene.Camera();
-	Vector2st const &screenSize = camera.ScreenSize();
-	Camera::Frustum const frustum = camera.SceneFrustum();
+float RayTracer::RayState::NextRandom()
+{
+	// PCG, with a 32 bit state and a permuted output.
+	randomState = randomState * 747796405u + 2891336453u;
 
-	float const nearPlaneWidth = frustum.nearPlaneHeight * frustum.aspectRatio;
+	std::uint32_t word =
+		((randomState >> ((randomState >> 28u) + 4u)) ^ randomState) * 277803737u;
+	word = (word >> 22u) ^ word;
+
+	return Math::ToUnitFloat(word);
+}
+
+RayTracer::TimeBudgetResult::TimeBudgetResult(Image &&image)
+: image(std::move(image))
+{
+}
+
+RayTracerConfiguration const &RayTracer::Configuration() const
+{
+	return configuration;
+}
+
+std::shared_ptr<Threading::TaskProcessor> const &
+RayTracer::SharedTaskProcessor() const
+{
+	return taskProcessor;
+}
+
+Image RayTracer::Trace() const
+{
+	Stopwatch watch;
+	watch.Start();
+
+	Image output = BlankImage();
+
+	std::uint32_t const sampleCount = configuration.samplesPerPixel;
+	TracePass(output, 0, sampleCount);
+
+	float const inverseSampleCount = 1.f / float(sampleCount);
+	for(Color &pixel: output.pixels)
+		pixel *= inverseSampleCount;
+
+	watch.Stop();
+
+	std::cout << "Took " << watch.Value() << " to render the scene\n";
+	std::fflush(stdout);
+
+	return output;
+}
+
+Image RayTracer::TraceProgressive(ProgressCallback const &callback) const
+{
+	Stopwatch watch;
+	watch.Start();
+
+	Image accumulation = BlankImage();
+	Image snapshot = BlankImage();
+
+	std::uint32_t const targetSampleCount = configuration.samplesPerPixel;
 
-	float const fullStepX = nearPlaneWidth / float(screenSize.x);
-	float const fullStepy = frustum.nearPlaneHeight / float(screenSize.y);
+	Progress progress;
+	progress.targetSampleCount = targetSampleCount;
 
-	switch(configuration.aaMode)
+	while(progress.sampleCount < targetSampleCount)
 	{
-		case RayTracerConfiguration::AntiAliasingMode::AA1:
-		{
-			raySteps.emplace_back(0.5f * fullStepX, 0.5f * fullStepy);
-		} break;
-		case RayTracerConfiguration::AntiAliasingMode::AA2:
-		{
-			raySteps.emplace_back(0.25f * fullStepX, 0.5f * fullStepy);
-			raySteps.emplace_back(0.75f * fullStepX, 0.5f * fullStepy);
-		} break;
-		case RayTracerConfiguration::AntiAliasingMode::AA4:
-		{
-			raySteps.emplace_back(0.25f * fullStepX, 0.25f * fullStepy);
-			raySteps.emplace_back(0.75f * fullStepX, 0.75f * fullStepy);
+		// Start with a single sample per pixel, then double the sample count
+		// with every pass.
+		std::uint32_t const passSampleCount = std::min(
+			std::max(progress.sampleCount, 1u),
+			targetSampleCount - progress.sampleCount);
+
+		TracePass(accumulation, progress.sampleCount, passSampleCount);
+		progress.sampleCount += passSampleCount;
+
+		float const inverseSampleCount = 1.f / float(progress.sampleCount);
+		std::transform(
+			accumulation.pixels.cbegin(),
+			accumulation.pixels.cend(),
+			snapshot.pixels.begin(),
+			[inverseSampleCount](Color const &sum)
+			{
+				return sum * inverseSampleCount;
+			});
+
+		if(callback && !callback(snapshot, progress))
+			break;
+
+		++progress.pass;
+	}
+
+	watch.Stop();
+
+	std::cout << "Took " << watch.Value() << " to render the scene in "
+		<< progress.sampleCount << " samples per pixel\n";
+	std::fflush(stdout);
+
+	return snapshot;
+}
+
+RayTracer::TimeBudgetResult RayTracer::TraceWithTimeBudget(
+	std::chrono::duration<float> budget) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point const start = Clock::now();
+	auto const elapsed = [&]()
+	{
+		return std::chrono::duration<float>(Clock::now() - start).count();
+	};
+
+	std::uint32_t const targetSampleCount = configuration.samplesPerPixel;
+	std::uint8_t const maxBounces = configuration.maxReflectionBounces;
+
+	// Fewer samples than this look worse than fewer bounces.
+	std::uint32_t const minimumSampleCount = std::min(targetSampleCount, 4u);
+
+	Image accumulation = BlankImage();
+
+	// The first sample of every pixel measures the time of a sample, and how
+	// many of its rays a lower bounce depth would save.
+	std::vector<std::atomic<std::uint64_t>> raysPerBounce(
+		std::size_t(maxBounces) + 1);
+
+	TracePass(accumulation, 0, 1, raysPerBounce.data());
+
+	float const firstPassSeconds = elapsed();
+
+	std::uint64_t totalRays = 0;
+	for(std::atomic<std::uint64_t> const &rays: raysPerBounce)
+		totalRays += rays;
+
+	auto const secondsPerSample = [&](std::uint8_t bounces)
+	{
+		std::uint64_t rays = 0;
+		for(std::size_t i = 0; i <= bounces; ++i)
+			rays += raysPerBounce[i];
+
+		return firstPassSeconds * float(rays) / float(std::max(totalRays, std::uint64_t(1)));
+	};
+
+	// How many samples per pixel fit in the rest of the budget.
+	auto const fittingSampleCount = [&](float remaining, float sampleSeconds)
+	{
+		if(remaining <= 0.f)
+			return 0u;
+
+		if(sampleSeconds <= 0.f)
+			return targetSampleCount;
+
+		return std::uint32_t(
+			std::min(remaining / sampleSeconds, float(targetSampleCount)));
+	};
+
+	float const remaining = budget.count() - firstPassSeconds;
 
-			raySteps.emplace_back(0.25f * fullStepX, 0.25f * fullStepy);
-			raySteps.emplace_back(0.75f * fullStepX, 0.75f * fullStepy);
-		} break;
-		case RayTracerConfiguration::AntiAliasingMode::AA8:
+	// The first sample is kept when rendering at full depth, otherwise the
+	// image starts over so every sample has the same depth. The first sample
+	// is still returned if no pass at the lower depth fits.
+	std::uint8_t bounces = maxBounces;
+	std::uint32_t sampleCount = 1;
+	std::optional<Image> fullDepthImage;
+
+	std::uint32_t const fullDepthSampleCount = std::min(
+		1 + fittingSampleCount(remaining, secondsPerSample(maxBounces)),
+		targetSampleCount);
+
+	if(fullDepthSampleCount < minimumSampleCount && maxBounces > 0)
+	{
+		// The deepest depth that fits enough samples, or no bounces at all.
+		std::uint8_t depth = maxBounces;
+		do
 		{
-			raySteps.emplace_back(0.2f * fullStepX, 0.25f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.25f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.25f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.25f * fullStepy);
-
-			raySteps.emplace_back(0.2f * fullStepX, 0.75f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.75f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.75f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.75f * fullStepy);
-		} break;
-		case RayTracerConfiguration::AntiAliasingMode::AA16:
+			--depth;
+		}
+		while(depth > 0
+			&& fittingSampleCount(remaining, secondsPerSample(depth))
+				< minimumSampleCount);
+
+		if(fittingSampleCount(remaining, secondsPerSample(depth))
+			> fullDepthSampleCount)
 		{
-			raySteps.emplace_back(0.2f * fullStepX, 0.2f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.2f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.2f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.2f * fullStepy);
+			bounces = depth;
+			sampleCount = 0;
+
+			fullDepthImage = std::move(accumulation);
+			accumulation = BlankImage();
+		}
+	}
+
+	RayTracer limited(*this);
+	limited.configuration.maxReflectionBounces = bounces;
+
+	float sampleSeconds = secondsPerSample(bounces);
+
+	while(sampleCount < targetSampleCount)
+	{
+		// Double the samples with every pass, like progressive rendering, to
+		// correct the estimate before most of the budget is spent.
+		std::uint32_t const passSampleCount = std::min({
+			std::max(sampleCount, 1u),
+			targetSampleCount - sampleCount,
+			fittingSampleCount(budget.count() - elapsed(), sampleSeconds)});
+
+		if(passSampleCount == 0)
+			break;
+
+		Clock::time_point const passStart = Clock::now();
+
+		limited.TracePass(accumulation, sampleCount, passSampleCount);
+		sampleCount += passSampleCount;
+
+		sampleSeconds = std::chrono::duration<float>(Clock::now() - passStart).count()
+			/ float(passSampleCount);
+	}
+
+	if(sampleCount == 0)
+	{
+		accumulation = std::move(*fullDepthImage);
+		bounces = maxBounces;
+		sampleCount = 1;
+	}
 
-			raySteps.emplace_back(0.2f * fullStepX, 0.4f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.4f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.4f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.4f * fullStepy);
+	float const inverseSampleCount = 1.f / float(sampleCount);
+	for(Color &pixel: accumulation.pixels)
+		pixel *= inverseSampleCount;
 
-			raySteps.emplace_back(0.2f * fullStepX, 0.6f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.6f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.6f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.6f * fullStepy);
+	TimeBudgetResult result(std::move(accumulation));
+	result.samplesPerPixel = sampleCount;
+	result.maxReflectionBounces = bounces;
+	result.seconds = elapsed();
+
+	return result;
+}
 
-			raySteps.emplace_back(0.2f * fullStepX, 0.8f * fullStepy);
-			raySteps.emplace_back(0.4f * fullStepX, 0.8f * fullStepy);
-			raySteps.emplace_back(0.6f * fullStepX, 0.8f * fullStepy);
-			raySteps.emplace_back(0.8f * fullStepX, 0.8f * fullStepy);
-		} break;
+Image RayTracer::TraceWithGBuffer(GBuffer &gbuffer) const
+{
+	Vector2st const &screenSize = scene.Camera().ScreenSize();
+	std::uint32_t const sampleCount = configuration.samplesPerPixel;
+
+	// The hits point into the scene, so they are only valid for the same one.
+	// Refractive materials let shadow rays through, so making one opaque or
+	// refractive changes the visible lights.
+	std::uint64_t const fingerprint = Hasher()
+		.Add(scene.Id())
+		.Add(scene.GeometryFingerprint())
+		.Add(scene.ShadowFingerprint())
+		.Add(std::uint64_t(sampleCount))
+		.Add(std::uint64_t(configuration.samplerType))
+		.Value();
+
+	bool const replay = gbuffer.fingerprint == fingerprint;
+
+	if(!replay)
+	{
+		std::size_t const totalSampleCount =
+			screenSize.x * screenSize.y * sampleCount;
+
+		gbuffer.fingerprint = 0;
+		gbuffer.samplesPerPixel = sampleCount;
+		gbuffer.lightWordCount = (scene.Lights().size() + 63) / 64;
+		gbuffer.hits.assign(
+			totalSampleCount,
+			GBuffer::Hit{GBuffer::noIndex, GBuffer::noIndex});
+		gbuffer.visibleLights.assign(totalSampleCount * gbuffer.lightWordCount, 0);
 	}
+
+	Image output = BlankImage();
+
+	PassContext pass = MakePassContext(output, 0, sampleCount);
+	pass.gbuffer = &gbuffer;
+	pass.replayGBuffer = replay;
+
+	TraceTiles(
+		pass,
+		Threading::MakeTiles(
+			screenSize,
+			configuration.tileSize,
+			configuration.tileOrder));
+
+	gbuffer.fingerprint = fingerprint;
+
+	float const inverseSampleCount = 1.f / float(sampleCount);
+	for(Color &pixel: output.pixels)
+		pixel *= inverseSampleCount;
+
+	return output;
 }
 
-Image RayTracer::Trace() const
+Image RayTracer::TraceWithAOVs(AOVBuffer &aovs) const
 {
+	Vector2st const &screenSize = scene.Camera().ScreenSize();
+	if(aovs.Size() != screenSize)
+		throw std::invalid_argument("The AOV buffer isn't the size of the screen");
+
+	std::uint32_t const sampleCount = configuration.samplesPerPixel;
+
 	Stopwatch watch;
 	watch.Start();
 
+	Image output = BlankImage();
+
+	PassContext pass = MakePassContext(output, 0, sampleCount);
+	pass.aovs = &aovs;
+
+	TraceTiles(
+		pass,
+		Threading::MakeTiles(
+			screenSize,
+			configuration.tileSize,
+			configuration.tileOrder));
+
+	float const inverseSampleCount = 1.f / float(sampleCount);
+	for(Color &pixel: output.pixels)
+		pixel *= inverseSampleCount;
+
+	watch.Stop();
+
+	std::cout << "Took " << watch.Value() << " to render the scene\n";
+	std::fflush(stdout);
+
+	return output;
+}
+
+std::optional<Image> RayTracer::TraceWithCheckpoints(
+	CheckpointConfiguration const &checkpointConfiguration) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	Vector2st const &screenSize = scene.Camera().ScreenSize();
+	std::string const &fileName = checkpointConfiguration.fileName;
+	std::uint64_t const fingerprint = Fingerprint();
+
+	std::vector<Threading::Tile> tiles = Threading::MakeTiles(
+		screenSize,
+		configuration.tileSize,
+		configuration.tileOrder);
+
+	bool const resume = checkpointConfiguration.resume
+		&& std::ifstream(fileName).good();
+
+	Checkpoint checkpoint = resume
+		? Checkpoint::Load(fileName, fingerprint, screenSize, std::move(tiles))
+		: Checkpoint(fingerprint, screenSize, std::move(tiles));
+
+	if(resume)
+	{
+		std::printf(
+			"Resuming from <%s>, %zu of %zu tiles done\n",
+			fileName.c_str(),
+			checkpoint.CompletedTileCount(),
+			checkpoint.tiles.size());
+		std::fflush(stdout);
+	}
+
+	auto const stopRequested = [&]()
+	{
+		return checkpointConfiguration.stopRequested
+			&& checkpointConfiguration.stopRequested->load();
+	};
+
+	std::vector<std::size_t> remaining;
+	for(std::size_t i = 0; i < checkpoint.tiles.size(); ++i)
+	{
+		if(!checkpoint.completed[i])
+			remaining.push_back(i);
+	}
+
+	// Render in batches that keep every worker busy, so a stop or a save
+	// doesn't wait for the whole frame.
+	std::size_t const batchSize = 4 * taskProcessor->ThreadCount();
+
+	Clock::time_point lastSave = Clock::now();
+	std::vector<Threading::Tile> batch;
+
+	for(std::size_t first = 0; first < remaining.size(); first += batchSize)
+	{
+		if(stopRequested())
+		{
+			checkpoint.Save(fileName);
+			return std::nullopt;
+		}
+
+		std::size_t const last = std::min(first + batchSize, remaining.size());
+
+		batch.clear();
+		for(std::size_t i = first; i < last; ++i)
+			batch.push_back(checkpoint.tiles[remaining[i]]);
+
+		TraceTiles(
+			checkpoint.accumulation,
+			batch,
+			0,
+			configuration.samplesPerPixel);
+
+		for(std::size_t i = first; i < last; ++i)
+			checkpoint.completed[remaining[i]] = true;
+
+		if(Clock::now() - lastSave >= checkpointConfiguration.interval)
+		{
+			checkpoint.Save(fileName);
+			lastSave = Clock::now();
+		}
+	}
+
+	std::remove(fileName.c_str());
+
+	Image output = std::move(checkpoint.accumulation);
+
+	float const inverseSampleCount = 1.f / float(configuration.samplesPerPixel);
+	for(Color &pixel: output.pixels)
+		pixel *= inverseSampleCount;
+
+	return output;
+}
+
+std::uint64_t RayTracer::Fingerprint() const
+{
+	// The thread settings only change how fast the image is rendered.
+	return Hasher()
+		.Add(scene.Fingerprint())
+		.Add(std::uint64_t(configuration.maxReflectionBounces))
+		.Add(std::uint64_t(configuration.samplesPerPixel))
+		.Add(std::uint64_t(configuration.samplerType))
+		.Add(configuration.minimumContribution)
+		.Add(std::uint64_t(configuration.tileSize))
+		.Add(std::uint64_t(configuration.tileOrder))
+		.Value();
+}
+
+Image RayTracer::BlankImage() const
+{
+	Vector2st const &screenSize = scene.Camera().ScreenSize();
+
+	Image image(std::size_t(screenSize.x), std::size_t(screenSize.y));
+	image.pixels.resize(std::size_t(screenSize.x * screenSize.y), Color::Black());
+
+	// Clearing the image placed all of it on the node of this thread. Let the
+	// pinned workers touch their tiles first instead, they get the same blocks
+	// of tiles in every pass, so most of what they accumulate into is local.
+	if(taskProcessor->PinsWorkers())
+	{
+		Threading::Topology::DiscardPages(
+			image.pixels.data(),
+			image.pixels.size() * sizeof(Color));
+
+		std::vector<Threading::Tile> const tiles = Threading::MakeTiles(
+			screenSize,
+			configuration.tileSize,
+			configuration.tileOrder);
+
+		taskProcessor->ParallelFor(
+			tiles.size(),
+			[&image, &tiles](std::size_t index)
+			{
+				Threading::Tile const &tile = tiles[index];
+
+				for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
+				{
+					auto const row = image.pixels.begin()
+						+ std::ptrdiff_t(y * image.sizeX + tile.x);
+
+					std::fill(row, row + std::ptrdiff_t(tile.width), Color::Black());
+				}
+			});
+	}
+
+	return image;
+}
+
+void RayTracer::TracePass(
+	Image &accumulation,
+	std::uint32_t sampleStart,
+	std::uint32_t sampleCount,
+	Observer<std::atomic<std::uint64_t>> raysPerBounce) const
+{
+	std::vector<Threading::Tile> const tiles = Threading::MakeTiles(
+		scene.Camera().ScreenSize(),
+		configuration.tileSize,
+		configuration.tileOrder);
+
+	PassContext pass = MakePassContext(accumulation, sampleStart, sampleCount);
+	pass.raysPerBounce = raysPerBounce;
+
+	TraceTiles(pass, tiles);
+}
+
+void RayTracer::TraceTiles(
+	Image &accumulation,
+	std::vector<Threading::Tile> const &tiles,
+	std::uint32_t sampleStart,
+	std::uint32_t sampleCount) const
+{
+	TraceTiles(MakePassContext(accumulation, sampleStart, sampleCount), tiles);
+}
+
+RayTracer::PassContext RayTracer::MakePassContext(
+	Image &accumulation,
+	std::uint32_t sampleStart,
+	std::uint32_t sampleCount) const
+{
 	Camera const &camera = scene.Camera();
-	Vector2st const &screenSize = camera.ScreenSize();
 	Camera::Frustum const frustum = camera.SceneFrustum();
 
-	Image output(std::size_t(screenSize.x), std::size_t(screenSize.y));
-	output.pixels.resize(std::size_t(screenSize.x * screenSize.y), Color::Black());
-
 	Matrix4x4 const camToWorld = camera.Transform().Matrix();
 
 	Vector3 const worldFar = Transform::TransformTranslation(
@@ -134,65 +622,108 @@ Image RayTracer::Trace() const
 
 	float const worldFarDistance = glm::length2(worldFar - cameraPosition);
 
-	Threading::TaskProcessor scheduler(configuration.threadCount);
+	// A cached occluder might be behind glass the full shadow ray hits first,
+	// which lets the light through, only opaque scenes are safe to cache.
+	bool const cacheShadowOccluders =
+		configuration.cacheShadowOccluders && !scene.HasRefractiveMaterials();
 
-	using ssize_t = std::make_signed_t<size_t>;
-	std::lldiv_t const xSplit = std::lldiv(ssize_t(screenSize.x), 64);
+	return
+		{
+			this,
+			&accumulation,
+			sampleStart,
+			sampleCount,
+			worldFarDistance,
+			nullptr,
+			nullptr,
+			false,
+			nullptr,
+			cacheShadowOccluders
+		};
+}
 
-	std::lldiv_t const ySplit = std::lldiv(ssize_t(screenSize.y), 64);
+void RayTracer::TraceTiles(
+	PassContext const &pass,
+	std::vector<Threading::Tile> const &tiles) const
+{
+	if(configuration.hardwareCounters)
+	{
+		std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+		counters->statistics.hardwarePerPass.emplace_back();
+		counters->statistics.hardwarePerTile.clear();
+	}
 
-	std::size_t const xCount = size_t(xSplit.quot);
-	std::size_t const xOffWidth = size_t(64 + xSplit.rem);
+	std::chrono::steady_clock::time_point const start =
+		std::chrono::steady_clock::now();
 
-	std::size_t const yCount = size_t(ySplit.quot);
-	std::size_t const yOffWidth = size_t(64 + ySplit.rem);
+	{
+		Timeline::Span const span(
+			"Render tiles",
+			std::to_string(tiles.size()) + " tiles");
+		taskProcessor->ParallelFor(
+			tiles.size(),
+			[this, &pass, &tiles](std::size_t index)
+			{
+				TraceChunk(pass, tiles[index]);
+			});
+	}
 
-	for(size_t i = 0; i < yCount; ++i)
+	if(configuration.hardwareCounters)
 	{
-		for(size_t j = 0; j < xCount; ++j)
-		{
-			scheduler.AddTask(
-				[
-					this,
-					&output,
-					worldFarDistance,
-					xCount,
-					yCount,
-					i,
-					j,
-					xOffWidth,
-					yOffWidth
-				]()
-				{
-					RayTracer::TraceChunk(
-						output,
-						i < yCount - 1 ? 64 : yOffWidth,
-						j < xCount - 1 ? 64 : xOffWidth,
-						64 * j,
-						64 * i,
-						worldFarDistance);
-				});
-		}
+		// Passes where no worker could count are left out.
+		std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+		if(counters->statistics.hardwarePerTile.empty())
+			counters->statistics.hardwarePerPass.pop_back();
 	}
 
-	scheduler.Run();
+	if constexpr(Instrumentation::enabled)
+	{
+		std::chrono::duration<double> const seconds =
+			std::chrono::steady_clock::now() - start;
 
-	watch.Stop();
+		std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+		counters->statistics.seconds += seconds.count();
+	}
+}
 
-	std::cout << "Took " << watch.Value() << " to render the scene\n";
-	std::fflush(stdout);
+Threading::Task RayTracer::MakeChunkTask(
+	PassContext const &pass,
+	Threading::Tile const &tile)
+{
+	return
+		{
+			&RayTracer::RunChunkTask,
+			const_cast<Observer<PassContext>>(&pass),
+			{tile.x, tile.y, tile.width, tile.height}
+		};
+}
 
-	return output;
+void RayTracer::RunChunkTask(
+	Observer<void> context,
+	Threading::Task::Arguments const &arguments)
+{
+	PassContext const &pass = *static_cast<Observer<PassContext const>>(context);
+
+	pass.rayTracer->TraceChunk(
+		pass,
+		{arguments[0], arguments[1], arguments[2], arguments[3]});
 }
 
-void RayTracer::TraceChunk(
-	Image &output,
-	std::size_t chunkLength,
-	std::size_t chunkWidth,
-	std::size_t chunkStartX,
-	std::size_t chunkStartY,
-	float worldFarDistance) const
+void RayTracer::TraceChunk(PassContext const &pass, Threading::Tile tile) const
 {
+	// Named after where the tile starts, it may hand off rows to other workers.
+	Timeline::Span const span(
+		"Tile",
+		Timeline::IsRecording()
+			? std::to_string(tile.x) + ", " + std::to_string(tile.y)
+			: std::string());
+
+	std::optional<Instrumentation::HardwareReading> hardwareStart;
+	if(configuration.hardwareCounters)
+		hardwareStart = Instrumentation::ReadHardwareCounters();
+
+	shadowOccluderCache.enabled = pass.cacheShadowOccluders;
+
 	Camera const &camera = scene.Camera();
 	Vector2st const &screenSize = camera.ScreenSize();
 	Camera::Frustum const frustum = camera.SceneFrustum();
@@ -214,19 +745,93 @@ void RayTracer::TraceChunk(
 
 	Matrix4x4 const camToWorld = camera.Transform().Matrix();
 
-	for(std::size_t y = chunkStartY; y < chunkStartY + chunkLength; ++y)
+	// Counted per chunk, so the threads only share the totals.
+	std::vector<std::uint64_t> raysPerBounce;
+	if(pass.raysPerBounce)
+		raysPerBounce.resize(std::size_t(configuration.maxReflectionBounces) + 1, 0);
+
+	// The planes of the AOVs to fill, nullptr for the ones not asked for.
+	Observer<float> depthPlane = nullptr;
+	std::array<Observer<float>, 3> normalPlanes{};
+	std::array<Observer<float>, 3> albedoPlanes{};
+	Observer<float> shapeIdPlane = nullptr;
+	Observer<float> bounceCountPlane = nullptr;
+	Observer<float> nodeVisitsPlane = nullptr;
+	Observer<float> primitiveTestsPlane = nullptr;
+	std::array<Observer<float>, rayTypeCount> rayPlanes{};
+	Observer<float> timePlane = nullptr;
+
+	// Whether any of the costs of the pixels are counted.
+	bool countCosts = false;
+
+	if(pass.aovs)
+	{
+		depthPlane = pass.aovs->Plane(AOV::Depth, 0);
+		shapeIdPlane = pass.aovs->Plane(AOV::ShapeId, 0);
+		bounceCountPlane = pass.aovs->Plane(AOV::BounceCount, 0);
+		nodeVisitsPlane = pass.aovs->Plane(AOV::NodeVisits, 0);
+		primitiveTestsPlane = pass.aovs->Plane(AOV::PrimitiveTests, 0);
+		timePlane = pass.aovs->Plane(AOV::Time, 0);
+
+		for(std::size_t type = 0; type < rayTypeCount; ++type)
+			rayPlanes[type] = pass.aovs->Plane(AOV::Rays, type);
+
+		for(AOV const aov: pass.aovs->AOVs())
+			countCosts = countCosts || AOVBuffer::IsCost(aov);
+
+		for(std::size_t c = 0; c < 3; ++c)
+		{
+			normalPlanes[c] = pass.aovs->Plane(AOV::Normal, c);
+			albedoPlanes[c] = pass.aovs->Plane(AOV::Albedo, c);
+		}
+	}
+
+	for(std::size_t y = tile.y; y < tile.y + tile.height; ++y)
 	{
-		for(std::size_t x = chunkStartX; x < chunkStartX + chunkWidth; ++x)
+		// Hand the bottom half of the remaining rows to another thread when
+		// one runs dry, so expensive tiles don't stall the end of the frame.
+		std::size_t const remainingRows = tile.y + tile.height - y;
+		if(remainingRows >= 2 && taskProcessor->HasIdleWorkers())
+		{
+			Threading::Tile tail = tile;
+			tail.y = y + remainingRows / 2;
+			tail.height = remainingRows - remainingRows / 2;
+
+			tile.height -= tail.height;
+
+			taskProcessor->Spawn(MakeChunkTask(pass, tail));
+		}
+
+		for(std::size_t x = tile.x; x < tile.x + tile.width; ++x)
 		{
 			Color pixel = Color::Black();
-			size_t const sampleCount = size_t(configuration.aaMode);
+			std::uint32_t const sampleEnd = pass.sampleStart + pass.sampleCount;
+
+			// Sums of the AOVs of the samples.
+			std::optional<Intersection> primaryHit;
+			float depth = 0.f;
+			Vector3 normal(0);
+			Color albedo = Color::Black();
+			float shapeId = -1.f;
+			float bounceCount = 0.f;
 
-			for(size_t i = 0; i < sampleCount; ++i)
+			PixelCost cost;
+			std::chrono::steady_clock::time_point pixelStart;
+
+			if(countCosts)
 			{
-				Vector2 const &steps = raySteps[i];
+				currentPixelCost = &cost;
+				pixelStart = std::chrono::steady_clock::now();
+			}
 
-				float const u = nearPlaneTopLeft.x + x * stepX + steps.x;
-				float const v = nearPlaneTopLeft.y - y * stepY - steps.y;
+			for(std::uint32_t i = pass.sampleStart; i < sampleEnd; ++i)
+			{
+				Vector2 const offset = sampler->Sample(x, y, i);
+
+				float const u =
+					nearPlaneTopLeft.x + (float(x) + offset.x) * stepX;
+				float const v =
+					nearPlaneTopLeft.y - (float(y) + offset.y) * stepY;
 
 				Vector3 rayTarget(u, v, -1);
 				rayTarget = glm::normalize(rayTarget);
@@ -235,15 +840,143 @@ void RayTracer::TraceChunk(
 					cameraPosition + rayTarget * frustum.nearPlaneDistance,
 					Transform::TransformDirection(camToWorld, rayTarget));
 
+				if(countCosts)
+					++cost.rays[std::size_t(RayType::Primary)];
+
+				Instrumentation::CountRay(RayType::Primary);
+
 				RayState state;
-				pixel += TraceRay(ray, state, false, worldFarDistance);
+				state.randomState = std::uint32_t(Hasher()
+					.Add(scene.Seed())
+					.Add(std::uint64_t(x))
+					.Add(std::uint64_t(y))
+					.Add(std::uint64_t(i))
+					.Value());
+
+				if(pass.raysPerBounce)
+					state.raysPerBounce = raysPerBounce.data();
+
+				if(pass.gbuffer)
+				{
+					GBuffer &gbuffer = *pass.gbuffer;
+					std::size_t const sample =
+						(y * screenSize.x + x) * gbuffer.samplesPerPixel + i;
+
+					state.gbufferHit = &gbuffer.hits[sample];
+					state.primaryLights = gbuffer.visibleLights.data()
+						+ sample * gbuffer.lightWordCount;
+					state.replayPrimary = pass.replayGBuffer;
+				}
+				else if(pass.aovs)
+					state.primaryHit = &primaryHit;
+
+				pixel += TraceRay(ray, state, false, pass.worldFarDistance);
+
+				if(pass.aovs)
+					bounceCount += float(state.deepestBounce);
+
+				if(pass.aovs && *state.primaryHit)
+				{
+					Intersection const &hit = **state.primaryHit;
+
+					depth += glm::length(hit.worldPosition - cameraPosition);
+					normal += hit.surfaceNormal;
+
+					if(shapeIdPlane && i == pass.sampleStart)
+						shapeId = float(scene.ShapeIndex(*hit.shape));
+
+					if(albedoPlanes[0])
+						albedo += hit.shape->Material().Shader().Albedo(hit);
+				}
+			}
+
+			std::size_t const index = y * screenSize.x + x;
+
+			pass.accumulation->pixels[index] += pixel;
+
+			if(countCosts)
+			{
+				std::chrono::duration<float, std::nano> const time =
+					std::chrono::steady_clock::now() - pixelStart;
+
+				currentPixelCost = nullptr;
+
+				if(nodeVisitsPlane)
+					nodeVisitsPlane[index] = float(cost.nodeVisits);
+
+				if(primitiveTestsPlane)
+					primitiveTestsPlane[index] = float(cost.primitiveTests);
+
+				for(std::size_t type = 0; type < rayTypeCount; ++type)
+				{
+					if(rayPlanes[type])
+						rayPlanes[type][index] = float(cost.rays[type]);
+				}
+
+				if(timePlane)
+					timePlane[index] = time.count();
 			}
 
-			pixel /= float(sampleCount);
+			if(pass.aovs)
+			{
+				float const inverseSampleCount = 1.f / float(pass.sampleCount);
+				std::array<float, 3> const albedoComponents{
+					albedo.r,
+					albedo.g,
+					albedo.b};
+
+				if(depthPlane)
+					depthPlane[index] = depth * inverseSampleCount;
+
+				if(shapeIdPlane)
+					shapeIdPlane[index] = shapeId;
+
+				if(bounceCountPlane)
+					bounceCountPlane[index] = bounceCount * inverseSampleCount;
+
+				for(std::size_t c = 0; c < 3; ++c)
+				{
+					if(normalPlanes[c])
+						normalPlanes[c][index] = normal[int(c)] * inverseSampleCount;
+
+					if(albedoPlanes[c])
+						albedoPlanes[c][index] = albedoComponents[c] * inverseSampleCount;
+				}
+			}
+		}
+	}
+
+	for(std::size_t i = 0; i < raysPerBounce.size(); ++i)
+		pass.raysPerBounce[i] += raysPerBounce[i];
+
+	if(configuration.hardwareCounters)
+	{
+		std::optional<Instrumentation::HardwareReading> const hardwareEnd =
+			hardwareStart ? Instrumentation::ReadHardwareCounters() : std::nullopt;
+
+		std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+		RenderStatistics &statistics = counters->statistics;
+
+		if(hardwareEnd)
+		{
+			HardwareCounts const counts =
+				Instrumentation::HardwareCountsBetween(*hardwareStart, *hardwareEnd);
+
+			statistics.hardware += counts;
+			statistics.hardwarePerPass.back() += counts;
+			statistics.hardwarePerTile.push_back({tile, counts});
+		}
+		else if(statistics.hardwareCountersError.empty())
+		{
+			std::string const error = Instrumentation::HardwareCountersError();
 
-			output.pixels[y * screenSize.x + x] = pixel;
+			statistics.hardwareCountersError = error.empty()
+				? "Unable to read the hardware counters"
+				: error;
 		}
 	}
+
+	FlushCounters();
 }
 
 Color RayTracer::TraceRay(
@@ -252,7 +985,22 @@ Color RayTracer::TraceRay(
 	bool debug,
 	float farPlaneDistance) const
 {
-	std::optional<Intersection> intersection = ShootRay(ray);
+	if(state.raysPerBounce)
+		++state.raysPerBounce[state.bounceCount];
+
+	state.deepestBounce = std::max(state.deepestBounce, state.bounceCount);
+
+	bool const gbufferHit = state.bounceCount == 0 && state.gbufferHit;
+
+	std::optional<Intersection> intersection = gbufferHit && state.replayPrimary
+		? ReplayHit(ray, *state.gbufferHit)
+		: ShootRay(ray);
+
+	if(gbufferHit && !state.replayPrimary)
+		*state.gbufferHit = RecordHit(intersection);
+
+	if(state.bounceCount == 0 && state.primaryHit)
+		*state.primaryHit = intersection;
 
 	if(!intersection)
 	{
@@ -334,7 +1082,7 @@ Color RayTracer::TraceRay(
 		return DoReflection(*intersection, ray, state, debug, farPlaneDistance);
 	}
 
-	Color const pixelColor = Shade(ray, *intersection, debug);
+	Color const pixelColor = Shade(ray, *intersection, state, debug);
 
 	if(debug)
 	{
@@ -347,6 +1095,53 @@ Color RayTracer::TraceRay(
 	return pixelColor;
 }
 
+Color RayTracer::TraceBranch(
+	Ray const &ray,
+	float weight,
+	RayType type,
+	RayState &state,
+	bool debug,
+	float farPlaneDistance) const
+{
+	float const minimumContribution = configuration.minimumContribution;
+	float const throughput = state.throughput * weight;
+
+	if(throughput < minimumContribution)
+	{
+		float const survivalProbability = throughput / minimumContribution;
+		if(state.NextRandom() >= survivalProbability)
+		{
+			if(debug)
+			{
+				std::cout << indent(state.bounceCount + 1)
+					<< "Ended by Russian roulette, throughput: " << throughput
+					<< "\n\n";
+			}
+
+			return Color::Black();
+		}
+
+		// Survivors make up for the rays that were ended.
+		weight /= survivalProbability;
+	}
+
+	if(Observer<PixelCost> const cost = currentPixelCost)
+		++cost->rays[std::size_t(type)];
+
+	Instrumentation::CountRay(type);
+
+	float const parentThroughput = state.throughput;
+	state.throughput *= weight;
+
+	++state.bounceCount;
+	Color const color = TraceRay(ray, state, debug, farPlaneDistance);
+	--state.bounceCount;
+
+	state.throughput = parentThroughput;
+
+	return color * weight;
+}
+
 Color RayTracer::DoReflection(
 	Intersection const &intersection,
 	Ray const &ray,
@@ -394,17 +1189,20 @@ Color RayTracer::DoReflection(
 			<< "},\n\n";
 	}
 
-	++state.bounceCount;
-	Color const reflectedColor =
-		TraceRay(reflectedRay, state, debug, farPlaneDistance);
-	--state.bounceCount;
-
 	Material const &material = intersection.shape->Material();
 	float const reflectiveness = material.Reflectiveness();
 
-	Color pixelColor = Shade(ray, intersection, debug);
+	Color const reflectedColor = TraceBranch(
+		reflectedRay,
+		reflectiveness,
+		RayType::Reflection,
+		state,
+		debug,
+		farPlaneDistance);
+
+	Color pixelColor = Shade(ray, intersection, state, debug);
 	pixelColor *= (1.f - reflectiveness);
-	pixelColor += reflectedColor * reflectiveness;
+	pixelColor += reflectedColor;
 
 	if(debug)
 	{
@@ -512,9 +1310,13 @@ Color RayTracer::DoRefraction(
 				std::cout << indent(state.bounceCount + 1) << "Leaving...\n";
 		}
 
-		++state.bounceCount;
-		refractedColor = TraceRay(refractedRay, state, debug, farPlaneDistance);
-		--state.bounceCount;
+		refractedColor = TraceBranch(
+			refractedRay,
+			1.f - fresnel,
+			RayType::Refraction,
+			state,
+			debug,
+			farPlaneDistance);
 
 		if(debug)
 		{
@@ -545,10 +1347,15 @@ Color RayTracer::DoRefraction(
 			<< "},\n\n";
 	}
 
-	++state.bounceCount;
-	Color const reflectedColor =
-		TraceRay(reflectedRay, state, debug, farPlaneDistance);
-	--state.bounceCount;
+	// The weights pick the branch to follow, at grazing angles the reflection
+	// dominates, head on the refraction does.
+	Color const reflectedColor = TraceBranch(
+		reflectedRay,
+		fresnel,
+		RayType::Reflection,
+		state,
+		debug,
+		farPlaneDistance);
 
 	if(debug)
 	{
@@ -556,8 +1363,7 @@ Color RayTracer::DoRefraction(
 			<< "Reflected color: " << reflectedColor << ",\n";
 	}
 
-	Color const pixelColor = reflectedColor * fresnel
-		+ refractedColor * (1.f - fresnel);
+	Color const pixelColor = reflectedColor + refractedColor;
 
 	if(debug)
 	{
@@ -573,14 +1379,56 @@ Color RayTracer::DoRefraction(
 Color RayTracer::Shade(
 	Ray const &ray,
 	Intersection const &intersection,
+	RayState const &state,
 	bool debug) const
 {
 	Vector3 const &cameraPosition = scene.Camera().Transform().Position();
 	Vector3 const &intersectionPos = intersection.worldPosition;
 	Vector3 const view = glm::normalize(cameraPosition - intersectionPos);
 
-	std::vector<Observer<Light const>> unobstructedLights =
-		LightsAtIntersection(intersection);
+	// Reused by every shade on this thread. Workers allocate it after being
+	// pinned, which keeps it on their own NUMA node.
+	static thread_local std::vector<Observer<Light const>> unobstructedLights;
+
+	std::vector<Light> const &lights = scene.Lights();
+	bool const primaryLights = state.bounceCount == 0 && state.primaryLights;
+
+	if(primaryLights)
+	{
+		if(!state.replayPrimary)
+		{
+			// Every light is shadow tested, however far it reaches now, so
+			// the replay can cull with the colors and intensities it has then.
+			static thread_local std::vector<Observer<Light const>> visibleLights;
+
+			visibleLights.clear();
+			for(Light const &light: lights)
+				visibleLights.push_back(&light);
+
+			UnobstructedLights(intersection, visibleLights);
+
+			for(Observer<Light const> const light: visibleLights)
+			{
+				std::size_t const i = std::size_t(light - lights.data());
+				state.primaryLights[i / 64] |= std::uint64_t(1) << (i % 64);
+			}
+		}
+
+		scene.LightTree().LightsAt(intersection.worldPosition, unobstructedLights);
+
+		unobstructedLights.erase(
+			std::remove_if(
+				unobstructedLights.begin(),
+				unobstructedLights.end(),
+				[&lights, &state](Observer<Light const> const light)
+				{
+					std::size_t const i = std::size_t(light - lights.data());
+					return !(state.primaryLights[i / 64] & (std::uint64_t(1) << (i % 64)));
+				}),
+			unobstructedLights.end());
+	}
+	else
+		LightsAtIntersection(intersection, unobstructedLights);
 
 	if(debug)
 		std::printf("\tLight count: %zu,\n", unobstructedLights.size());
@@ -590,6 +1438,8 @@ Color RayTracer::Shade(
 
 	std::pair<Color const &, float> ambientLight = scene.AmbientLight();
 
+	Instrumentation::CountShaderInvocation(shader);
+
 	Color const pixelColor = shader.Run(
 			intersection,
 			view,
@@ -634,7 +1484,7 @@ Vector3 RayTracer::Refract(
 float RayTracer::FresnelFactor(
 	float cosTheta,
 	float iorA,
-	float iorB) const
+	float iorB)
 {
 	float cosThetaI = Math::Clamp(cosTheta, -1.f, 1.f);
 
@@ -695,6 +1545,42 @@ Ray RayTracer::MakeMouseRay(int x, int y) const
 	return ray;
 }
 
+void RayTracer::FlushCounters() const
+{
+	ShadowOccluderCache &cache = shadowOccluderCache;
+
+	if(cache.lookups > 0)
+	{
+		counters->shadowCacheLookups += cache.lookups;
+		counters->shadowCacheHits += cache.hits;
+
+		cache.lookups = 0;
+		cache.hits = 0;
+	}
+
+	if constexpr(Instrumentation::enabled)
+	{
+		std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+		Instrumentation::FlushThreadCounters(counters->statistics);
+	}
+}
+
+RenderStatistics RayTracer::Statistics() const
+{
+	std::lock_guard<std::mutex> const lock(counters->statisticsMutex);
+
+	return counters->statistics;
+}
+
+RayTracer::CacheStatistics RayTracer::ShadowCacheStatistics() const
+{
+	CacheStatistics statistics;
+	statistics.lookups = counters->shadowCacheLookups;
+	statistics.hits = counters->shadowCacheHits;
+
+	return statistics;
+}
+
 std::optional<Intersection> RayTracer::ShootRay(Ray const &ray) const
 {
 	Containers::BVH<Shape> const &bvh = scene.BoundingVolumeHierarchy();
@@ -708,8 +1594,13 @@ std::optional<Intersection> RayTracer::ShootRay(Ray const &ray) const
 		closestDistance = glm::length2(intersectionToOrigin);
 	}
 
+	Observer<PixelCost> const cost = currentPixelCost;
+
 	for(auto const &shape: scene.UnboundableShapes())
 	{
+		if(cost)
+			++cost->primitiveTests;
+
 		std::optional<Intersection> const intersection = shape->Intersects(ray);
 		if(intersection)
 		{
@@ -736,17 +1627,91 @@ std::optional<Intersection> RayTracer::ShootRay(Ray const &ray) const
 	return closestIntersection;
 }
 
-std::vector<Observer<Light const>> RayTracer::LightsAtIntersection(
-	Intersection const &intersection) const
+std::optional<Intersection> RayTracer::ReplayHit(
+	Ray const &ray,
+	GBuffer::Hit const &hit) const
 {
-	std::vector<Light> const &lights = scene.Lights();
-	std::vector<Observer<Light const>> unobstructedLights;
+	if(hit.shape == GBuffer::noIndex)
+		return std::nullopt;
 
-	for(Light const &light: lights)
+	Shape const &shape = *scene.Shapes()[hit.shape];
+
+	// Only models record a triangle. The triangle sees the same ray in the
+	// space of the model as when the model was traversed.
+	std::optional<Intersection> const intersection =
+		hit.triangle == GBuffer::noIndex
+			? shape.Intersects(ray)
+			: static_cast<Model const &>(shape)
+				.Triangle(hit.triangle)
+				.IntersectsWorld(ray);
+
+	return intersection ? intersection : ShootRay(ray);
+}
+
+GBuffer::Hit RayTracer::RecordHit(
+	std::optional<Intersection> const &intersection) const
+{
+	GBuffer::Hit hit{GBuffer::noIndex, GBuffer::noIndex};
+
+	if(intersection)
 	{
-		Vector3 const biasedOrigin = intersection.worldPosition
-			+ intersection.surfaceNormal
-			* bias;
+		hit.shape = std::uint32_t(scene.ShapeIndex(*intersection->shape));
+
+		if(intersection->triangle)
+		{
+			hit.triangle = std::uint32_t(
+				static_cast<Model const &>(*intersection->shape)
+					.TriangleIndex(*intersection->triangle));
+		}
+	}
+
+	return hit;
+}
+
+void RayTracer::LightsAtIntersection(
+	Intersection const &intersection,
+	std::vector<Observer<Light const>> &unobstructedLights) const
+{
+	// Only lights close enough to matter are considered.
+	scene.LightTree().LightsAt(intersection.worldPosition, unobstructedLights);
+	UnobstructedLights(intersection, unobstructedLights);
+}
+
+void RayTracer::UnobstructedLights(
+	Intersection const &intersection,
+	std::vector<Observer<Light const>> &lights) const
+{
+	Vector3 const biasedOrigin = intersection.worldPosition
+		+ intersection.surfaceNormal
+		* bias;
+
+	std::size_t unobstructedCount = 0;
+
+	ShadowOccluderCache &cache = shadowOccluderCache;
+	if(cache.enabled && cache.sceneId != scene.Id())
+	{
+		cache.sceneId = scene.Id();
+		cache.occluders.assign(scene.Lights().size(), {});
+	}
+
+	Observer<PixelCost> const cost = currentPixelCost;
+
+	for(Observer<Light const> const lightPointer: lights)
+	{
+		Light const &light = *lightPointer;
+
+		// A light behind the surface can't light it, skip its shadow ray.
+		if(glm::dot(
+			intersection.surfaceNormal,
+			light.Position() - intersection.worldPosition) <= 0.f)
+		{
+			continue;
+		}
+
+		if(cost)
+			++cost->rays[std::size_t(RayType::Shadow)];
+
+		Instrumentation::CountRay(RayType::Shadow);
 
 		Ray const lightRay(
 			biasedOrigin,
@@ -755,10 +1720,39 @@ std::vector<Observer<Light const>> RayTracer::LightsAtIntersection(
 		float const lightDistance =
 			glm::length2(light.Position() - biasedOrigin);
 
+		Observer<ShadowOccluderCache::Occluder> occluder = nullptr;
+
+		if(cache.enabled)
+		{
+			occluder =
+				&cache.occluders[std::size_t(&light - scene.Lights().data())];
+
+			if(occluder->shape)
+			{
+				++cache.lookups;
+
+				if(cost)
+					++cost->primitiveTests;
+
+				std::optional<Intersection> const cachedIntersection =
+					occluder->triangle
+						? occluder->triangle->IntersectsWorld(lightRay)
+						: occluder->shape->Intersects(lightRay);
+
+				if(cachedIntersection
+					&& glm::length2(cachedIntersection->worldPosition - biasedOrigin)
+						< lightDistance)
+				{
+					++cache.hits;
+					continue;
+				}
+			}
+		}
+
 		std::optional<Intersection> lightIntersection = ShootRay(lightRay);
 
 		if(!lightIntersection)
-			unobstructedLights.push_back(&light);
+			lights[unobstructedCount++] = &light;
 		else
 		{
 			Vector3 const intersectionToOrigin =
@@ -770,12 +1764,17 @@ std::vector<Observer<Light const>> RayTracer::LightsAtIntersection(
 			float const ior = material.RefractiveIndexInside();
 
 			if(intersectionDistance > lightDistance)
-				unobstructedLights.push_back(&light);
+				lights[unobstructedCount++] = &light;
 			else if(ior > 0.f)
-					unobstructedLights.push_back(&light);
+				lights[unobstructedCount++] = &light;
+			else if(occluder)
+			{
+				occluder->shape = lightIntersection->shape;
+				occluder->triangle = lightIntersection->triangle;
+			}
 		}
 	}
 
-	return unobstructedLights;
+	lights.resize(unobstructedCount);
 }
 } // namespace LibRay
@@ -1,13 +1,26 @@
 #ifndef ef875083_56da_287e_58f0_a7a130757a7d
 #define ef875083_56da_287e_58f0_a7a130757a7d
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <type_traits>
 #include <vector>
 
 #include "Math/Vector.hpp"
+#include "Sampling/Sampler.hpp"
+#include "Threading/TaskProcessor.hpp"
+#include "Threading/Tile.hpp"
 #include "API.hpp"
+#include "GBuffer.hpp"
+#include "Image.hpp"
+#include "PixelCost.hpp"
+#include "Statistics.hpp"
 #include "Utilites.hpp"
 
 namespace LibRay
@@ -22,30 +35,45 @@ namespace Materials
 class Color;
 } // namespace Materials
 
-class Image;
+class AOVBuffer;
+struct CheckpointConfiguration;
 class Intersection;
 class Light;
 class Scene;
 
 struct LIBRAY_API RayTracerConfiguration final
 {
-	enum class AntiAliasingMode: size_t
-	{
-		AA1  =  1,
-		AA2  =  2,
-		AA4  =  4,
-		AA8  =  8,
-		AA16 = 16
-	};
-
 	RayTracerConfiguration(
 		std::uint8_t maxReflectionBounces,
-		std::uint8_t threadCount,
-		AntiAliasingMode aaMode);
+		std::uint32_t threadCount,
+		std::uint32_t samplesPerPixel,
+		Sampling::SamplerType samplerType = Sampling::SamplerType::Sobol);
 
 	std::uint8_t maxReflectionBounces;
-	std::uint8_t threadCount;
-	AntiAliasingMode aaMode;
+	std::uint32_t threadCount;
+	std::uint32_t samplesPerPixel;
+	Sampling::SamplerType samplerType;
+	Threading::ThreadPlacement threadPlacement;
+
+	// Rays contributing less than this to their pixel are ended with Russian
+	// roulette, survivors are weighted up to keep the image unbiased. 0 traces
+	// every reflection and refraction up to maxReflectionBounces.
+	float minimumContribution;
+
+	// Test the object that blocked the last shadow ray to the same light on
+	// this thread before searching the whole scene. Ignored for scenes with
+	// refractive materials, where the closest hit decides whether a light is
+	// blocked, so the image never depends on the cache.
+	bool cacheShadowOccluders;
+
+	// Tiles are split further while rendering when threads run out of work.
+	std::uint32_t tileSize;
+	Threading::TileOrder tileOrder;
+
+	// Count cycles, instructions, cache misses, and branch mispredictions of
+	// every tile with the hardware counters of the workers, see
+	// RenderStatistics::hardware. Costs two system calls per tile.
+	bool hardwareCounters;
 };
 
 static_assert(std::is_copy_constructible_v<RayTracerConfiguration>);
@@ -63,8 +91,32 @@ public:
 	public:
 		RayState() = default;
 
+		// Returns a number in [0, 1), the sequence only depends on the
+		// starting randomState.
+		float NextRandom();
+
 	public:
 		std::uint8_t bounceCount = 0;
+
+		// The deepest bounceCount reached by the ray tree so far.
+		std::uint8_t deepestBounce = 0;
+
+		// How much of the pixel color this ray carries.
+		float throughput = 1.f;
+
+		std::uint32_t randomState = 0;
+
+		// When set, counts the rays traced at every bounce depth.
+		Observer<std::uint64_t> raysPerBounce = nullptr;
+
+		// Set for primary rays rendering AOVs, receives the hit.
+		Observer<std::optional<Intersection>> primaryHit = nullptr;
+
+		// Set for primary rays rendered with a G-buffer, which keeps the hit
+		// and the unobstructed lights of the sample, or replays them.
+		Observer<GBuffer::Hit> gbufferHit = nullptr;
+		Observer<std::uint64_t> primaryLights = nullptr;
+		bool replayPrimary = false;
 	};
 
 	static_assert(std::is_copy_constructible_v<RayState>);
@@ -74,10 +126,132 @@ public:
 	static_assert(std::is_move_constructible_v<RayState>);
 	static_assert(std::is_move_assignable_v<RayState>);
 
+	class Progress
+	{
+	public:
+		Progress() = default;
+
+	public:
+		std::uint32_t pass = 0;
+		std::uint32_t sampleCount = 0;
+		std::uint32_t targetSampleCount = 0;
+	};
+
+	static_assert(std::is_copy_constructible_v<Progress>);
+	static_assert(std::is_copy_assignable_v<Progress>);
+	static_assert(std::is_trivially_copyable_v<Progress>);
+
+	static_assert(std::is_move_constructible_v<Progress>);
+	static_assert(std::is_move_assignable_v<Progress>);
+
+	class CacheStatistics
+	{
+	public:
+		CacheStatistics() = default;
+
+	public:
+		std::uint64_t lookups = 0;
+		std::uint64_t hits = 0;
+	};
+
+	static_assert(std::is_copy_constructible_v<CacheStatistics>);
+	static_assert(std::is_copy_assignable_v<CacheStatistics>);
+	static_assert(std::is_trivially_copyable_v<CacheStatistics>);
+
+	static_assert(std::is_move_constructible_v<CacheStatistics>);
+	static_assert(std::is_move_assignable_v<CacheStatistics>);
+
+	class TimeBudgetResult
+	{
+	public:
+		explicit TimeBudgetResult(Image &&image);
+
+	public:
+		Image image;
+
+		// The quality the budget allowed.
+		std::uint32_t samplesPerPixel = 0;
+		std::uint8_t maxReflectionBounces = 0;
+
+		float seconds = 0.f;
+	};
+
+	static_assert(std::is_copy_constructible_v<TimeBudgetResult>);
+	static_assert(std::is_copy_assignable_v<TimeBudgetResult>);
+	static_assert(!std::is_trivially_copyable_v<TimeBudgetResult>);
+
+	static_assert(std::is_move_constructible_v<TimeBudgetResult>);
+	static_assert(std::is_move_assignable_v<TimeBudgetResult>);
+
+	// Called after every pass with the image so far, return false to stop
+	// refining the image.
+	using ProgressCallback =
+		std::function<bool(Image const &snapshot, Progress const &progress)>;
+
 public:
+	// Creates a task processor with configuration.threadCount workers, placed
+	// as configuration.threadPlacement says.
 	RayTracer(Scene const &scene, RayTracerConfiguration &&config);
 
+	// Renders on a task processor shared with other ray tracers or subsystems,
+	// the workers are kept alive between frames.
+	RayTracer(
+		Scene const &scene,
+		RayTracerConfiguration &&config,
+		std::shared_ptr<Threading::TaskProcessor> taskProcessor);
+
+	RayTracerConfiguration const &Configuration() const;
+
+	// The render threads, for post-processing on the same workers.
+	std::shared_ptr<Threading::TaskProcessor> const &SharedTaskProcessor() const;
+
 	Image Trace() const;
+
+	// Renders one sample per pixel for the whole frame first, then keeps
+	// refining the image in passes until all samples are taken.
+	Image TraceProgressive(ProgressCallback const &callback) const;
+
+	// Renders a first sample per pixel to measure the speed of the scene,
+	// then picks the sample count and bounce depth, at most the configured
+	// ones, that finish within the budget. Prefers lowering the sample count,
+	// the bounce depth is only lowered when too few samples would fit. When
+	// the estimate was off, stops after the pass that ran out of time.
+	TimeBudgetResult TraceWithTimeBudget(std::chrono::duration<float> budget) const;
+
+	// Renders like Trace, keeping the primary hit and the unobstructed lights
+	// of every sample in gbuffer. When gbuffer was filled for this scene with
+	// the same camera, geometry, light positions, and sampling, those are
+	// replayed instead, so changes to materials, light colors and
+	// intensities, or ambient light are shaded without tracing primary and
+	// shadow rays. Reflections and refractions are still traced. Filling
+	// shadow tests every light at the primary hits, not only the ones the
+	// light tree keeps, so the lights are culled with their brightness at
+	// replay. Making a material refractive or opaque changes which lights are
+	// blocked, so gbuffer is filled again then, other refractive index
+	// changes are replayed.
+	Image TraceWithGBuffer(GBuffer &gbuffer) const;
+
+	// Renders like Trace, and fills the AOVs in aovs, which has to be the size
+	// of the screen, from the primary hits.
+	Image TraceWithAOVs(AOVBuffer &aovs) const;
+
+	// Saves the finished tiles every checkpoint.interval, and skips the tiles
+	// already in the checkpoint file when resuming. Returns std::nullopt when
+	// stopped through checkpoint.stopRequested, after saving.
+	std::optional<Image> TraceWithCheckpoints(
+		CheckpointConfiguration const &checkpoint) const;
+
+	// Identifies the scene and every setting that changes the rendered image.
+	std::uint64_t Fingerprint() const;
+
+	// Adds the sum of samples [sampleStart, sampleStart + sampleCount) of
+	// every pixel in the tiles to accumulation, which covers the whole screen.
+	void TraceTiles(
+		Image &accumulation,
+		std::vector<Threading::Tile> const &tiles,
+		std::uint32_t sampleStart,
+		std::uint32_t sampleCount) const;
+
 	Materials::Color TraceRay(
 		Math::Ray const &ray,
 		RayState &state,
@@ -86,19 +260,117 @@ public:
 
 	Math::Ray MakeMouseRay(int x, int y) const;
 
+	// The fraction of light reflected where a ray crosses from refractive
+	// index iorA into iorB, unpolarized.
+	static float FresnelFactor(float cosTheta, float iorA, float iorB);
+
+	// Counted over every frame rendered by this ray tracer and its copies,
+	// a hit saves the traversal of a shadow ray.
+	CacheStatistics ShadowCacheStatistics() const;
+
+	// The rays, tests, shader runs, and texture samples of every frame
+	// rendered by this ray tracer and its copies. Only counted when built
+	// with LIBRAY_STATISTICS, see RenderStatistics::enabled.
+	RenderStatistics Statistics() const;
+
 private:
-	void TraceChunk(
-		Image &output,
-		std::size_t chunkLength,
-		std::size_t chunkWidth,
-		std::size_t chunkStartX,
-		std::size_t chunkStartY,
-		float worldFarDistance) const;
+	// Rendering threads add their counts when done with a chunk.
+	struct Counters
+	{
+		std::atomic<std::uint64_t> shadowCacheLookups{0};
+		std::atomic<std::uint64_t> shadowCacheHits{0};
+
+		// The threads count on their own, and merge their counts in here.
+		std::mutex statisticsMutex;
+		RenderStatistics statistics;
+	};
+
+	// What the tasks of a pass share, the tasks only carry their tile.
+	struct PassContext
+	{
+		Observer<RayTracer const> rayTracer;
+		Observer<Image> accumulation;
+		std::uint32_t sampleStart;
+		std::uint32_t sampleCount;
+		float worldFarDistance;
+
+		// Indexed by bounce depth, may be nullptr.
+		Observer<std::atomic<std::uint64_t>> raysPerBounce;
+
+		// Primary hits are stored in gbuffer, or read from it when replaying.
+		Observer<GBuffer> gbuffer;
+		bool replayGBuffer;
+
+		// Filled with the primary hits and ray tree depths of every pixel, may
+		// be nullptr.
+		Observer<AOVBuffer> aovs;
+
+		// Whether the workers use their shadow occluder caches this pass.
+		bool cacheShadowOccluders;
+	};
+
+	PassContext MakePassContext(
+		Image &accumulation,
+		std::uint32_t sampleStart,
+		std::uint32_t sampleCount) const;
+
+	Image BlankImage() const;
+
+	// Adds the sum of samples [sampleStart, sampleStart + sampleCount) of
+	// every pixel to accumulation.
+	void TracePass(
+		Image &accumulation,
+		std::uint32_t sampleStart,
+		std::uint32_t sampleCount,
+		Observer<std::atomic<std::uint64_t>> raysPerBounce = nullptr) const;
+
+	void TraceTiles(
+		PassContext const &pass,
+		std::vector<Threading::Tile> const &tiles) const;
+
+	static Threading::Task MakeChunkTask(
+		PassContext const &pass,
+		Threading::Tile const &tile);
+
+	static void RunChunkTask(
+		Observer<void> context,
+		Threading::Task::Arguments const &arguments);
+
+	void TraceChunk(PassContext const &pass, Threading::Tile tile) const;
 
 	std::optional<Intersection> ShootRay(Math::Ray const &ray) const;
 
-	std::vector<Observer<Light const>> LightsAtIntersection(
-		Intersection const &intersection) const;
+	// Intersects ray with the primitive hit recorded for it, or shoots it
+	// when that misses now.
+	std::optional<Intersection> ReplayHit(
+		Math::Ray const &ray,
+		GBuffer::Hit const &hit) const;
+
+	GBuffer::Hit RecordHit(std::optional<Intersection> const &intersection) const;
+
+	// Adds the counts of the calling thread to counters.
+	void FlushCounters() const;
+
+	// Fills unobstructedLights with the lights visible from the intersection.
+	void LightsAtIntersection(
+		Intersection const &intersection,
+		std::vector<Observer<Light const>> &unobstructedLights) const;
+
+	// Filters lights down to the ones in front of the intersection that no
+	// opaque shape blocks, in place.
+	void UnobstructedLights(
+		Intersection const &intersection,
+		std::vector<Observer<Light const>> &lights) const;
+
+	// Traces a child ray carrying weight of the color of its parent, and
+	// returns its weighted color.
+	Materials::Color TraceBranch(
+		Math::Ray const &ray,
+		float weight,
+		RayType type,
+		RayState &state,
+		bool debug,
+		float farPlaneDistance) const;
 
 	Materials::Color DoReflection(
 		Intersection const &intersection,
@@ -117,6 +389,7 @@ private:
 	Materials::Color Shade(
 		Math::Ray const &ray,
 		Intersection const &intersection,
+		RayState const &state,
 		bool debug) const;
 
 	Math::Ray ReflectRay(
@@ -129,12 +402,12 @@ private:
 		Math::Vector3 const &normal,
 		float refractionRatio) const;
 
-	float FresnelFactor(float cosTheta, float iorA, float iorB) const;
-
 private:
 	Scene const &scene;
 	RayTracerConfiguration configuration;
-	std::vector<Math::Vector2> raySteps;
+	std::shared_ptr<Sampling::Sampler const> sampler;
+	std::shared_ptr<Threading::TaskProcessor> taskProcessor;
+	std::shared_ptr<Counters> counters;
 };
 
 static_assert(std::is_copy_constructible_v<RayTracer>);
@@ -0,0 +1,44 @@
+#include "BlueNoiseSampler.hpp"
+
+#include <cmath>
+
+#include "../Math/MathUtils.hpp"
+
+namespace LibRay::Sampling
+{
+using namespace Math;
+
+// 1 / g and 1 / g², where g is the plastic number.
+constexpr double const alpha1 = 0.7548776662466927;
+constexpr double const alpha2 = 0.5698402909980532;
+
+static float Fraction(double value)
+{
+	float const result = float(value - std::floor(value));
+
+	// Guard against rounding up to exactly 1.
+	return result < 1.f ? result : 0.f;
+}
+
+Vector2 BlueNoiseSampler::Sample(
+	std::size_t x,
+	std::size_t y,
+	std::uint32_t sampleIndex) const
+{
+	// The per image shift keeps the mask from being the same for every seed.
+	double const shiftX = double(ToUnitFloat(PixelHash(0, 0, 0)));
+	double const shiftY = double(ToUnitFloat(PixelHash(0, 0, 1)));
+
+	double const pixelX = double(x);
+	double const pixelY = double(y);
+
+	double const offsetU = shiftX + alpha1 * pixelX + alpha2 * pixelY;
+	double const offsetV = shiftY + alpha2 * pixelX + alpha1 * pixelY;
+
+	double const index = double(sampleIndex);
+
+	return Vector2(
+		Fraction(offsetU + alpha1 * index),
+		Fraction(offsetV + alpha2 * index));
+}
+} // namespace LibRay::Sampling
@@ -0,0 +1,36 @@
+#ifndef b7b20519_c774_4674_a267_cbd5496f4ccd
+#define b7b20519_c774_4674_a267_cbd5496f4ccd
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+#include "Sampler.hpp"
+
+namespace LibRay::Sampling
+{
+// The R2 sequence (Roberts 2018) within a pixel, rotated per pixel by an R2
+// dither mask. Neighbouring pixels get maximally different rotations, which
+// pushes the remaining error into high frequencies (blue noise).
+class LIBRAY_API BlueNoiseSampler final: public Sampler
+{
+public:
+	using Sampler::Sampler;
+
+	Math::Vector2 Sample(
+		std::size_t x,
+		std::size_t y,
+		std::uint32_t sampleIndex) const override;
+};
+
+static_assert(std::is_copy_constructible_v<BlueNoiseSampler>);
+static_assert(std::is_copy_assignable_v<BlueNoiseSampler>);
+static_assert(!std::is_trivially_copyable_v<BlueNoiseSampler>);
+
+static_assert(std::is_move_constructible_v<BlueNoiseSampler>);
+static_assert(std::is_move_assignable_v<BlueNoiseSampler>);
+} // namespace LibRay::Sampling
+
+#endif // b7b20519_c774_4674_a267_cbd5496f4ccd
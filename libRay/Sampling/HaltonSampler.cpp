@@ -0,0 +1,50 @@
+#include "HaltonSampler.hpp"
+
+#include <algorithm>
+
+#include "../Math/MathUtils.hpp"
+
+namespace LibRay::Sampling
+{
+using namespace Math;
+
+static float RadicalInverse(std::uint32_t index, std::uint32_t base)
+{
+	float const inverseBase = 1.f / float(base);
+	float factor = inverseBase;
+	float result = 0.f;
+
+	while(index)
+	{
+		result += float(index % base) * factor;
+		index /= base;
+		factor *= inverseBase;
+	}
+
+	return result;
+}
+
+static float Rotate(float value, float offset)
+{
+	value += offset;
+
+	// Guard against rounding up to exactly 1.
+	return value >= 1.f ? std::max(0.f, value - 1.f) : value;
+}
+
+Vector2 HaltonSampler::Sample(
+	std::size_t x,
+	std::size_t y,
+	std::uint32_t sampleIndex) const
+{
+	float const u = Rotate(
+		RadicalInverse(sampleIndex, 2),
+		ToUnitFloat(PixelHash(x, y, 0)));
+
+	float const v = Rotate(
+		RadicalInverse(sampleIndex, 3),
+		ToUnitFloat(PixelHash(x, y, 1)));
+
+	return Vector2(u, v);
+}
+} // namespace LibRay::Sampling
@@ -0,0 +1,35 @@
+#ifndef ddf8dc20_7f06_44ac_a280_3116a716aa71
+#define ddf8dc20_7f06_44ac_a280_3116a716aa71
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+#include "Sampler.hpp"
+
+namespace LibRay::Sampling
+{
+// The base 2 and base 3 Halton sequence, with a per pixel Cranley-Patterson
+// rotation.
+class LIBRAY_API HaltonSampler final: public Sampler
+{
+public:
+	using Sampler::Sampler;
+
+	Math::Vector2 Sample(
+		std::size_t x,
+		std::size_t y,
+		std::uint32_t sampleIndex) const override;
+};
+
+static_assert(std::is_copy_constructible_v<HaltonSampler>);
+static_assert(std::is_copy_assignable_v<HaltonSampler>);
+static_assert(!std::is_trivially_copyable_v<HaltonSampler>);
+
+static_assert(std::is_move_constructible_v<HaltonSampler>);
+static_assert(std::is_move_assignable_v<HaltonSampler>);
+} // namespace LibRay::Sampling
+
+#endif // ddf8dc20_7f06_44ac_a280_3116a716aa71
@@ -0,0 +1,60 @@
+#include "Sampler.hpp"
+
+#include "BlueNoiseSampler.hpp"
+#include "HaltonSampler.hpp"
+#include "SobolSampler.hpp"
+
+namespace LibRay::Sampling
+{
+static std::uint64_t Mix(std::uint64_t value)
+{
+	// SplitMix64 finalizer
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	value ^= value >> 31;
+
+	return value;
+}
+
+Sampler::Sampler(std::uint64_t seed)
+: seed(seed)
+{
+}
+
+Sampler::~Sampler() noexcept = default;
+
+std::uint64_t Sampler::Seed() const
+{
+	return seed;
+}
+
+std::unique_ptr<Sampler> Sampler::Create(SamplerType type, std::uint64_t seed)
+{
+	switch(type)
+	{
+	case SamplerType::Sobol:
+		return std::make_unique<SobolSampler>(seed);
+	case SamplerType::Halton:
+		return std::make_unique<HaltonSampler>(seed);
+	case SamplerType::BlueNoise:
+		return std::make_unique<BlueNoiseSampler>(seed);
+	}
+
+	return std::make_unique<SobolSampler>(seed);
+}
+
+std::uint32_t Sampler::PixelHash(
+	std::size_t x,
+	std::size_t y,
+	std::uint32_t dimension) const
+{
+	std::uint64_t hash = Mix(seed + 0x9e3779b97f4a7c15ull);
+	hash = Mix(hash ^ std::uint64_t(x));
+	hash = Mix(hash ^ (std::uint64_t(y) << 32));
+	hash = Mix(hash + dimension);
+
+	return std::uint32_t(hash >> 32);
+}
+} // namespace LibRay::Sampling
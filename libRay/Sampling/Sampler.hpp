@@ -0,0 +1,59 @@
+#ifndef f28d6a10_93b6_4c7a_9818_760c9bede5f2
+#define f28d6a10_93b6_4c7a_9818_760c9bede5f2
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+
+namespace LibRay::Sampling
+{
+enum class SamplerType
+{
+	Sobol,
+	Halton,
+	BlueNoise
+};
+
+// Samplers are stateless, a sample is fully defined by the pixel and the
+// sample index. This keeps renders reproducible and allows any worker to
+// render any range of samples for any pixel.
+class LIBRAY_API Sampler
+{
+public:
+	explicit Sampler(std::uint64_t seed);
+	virtual ~Sampler() noexcept;
+
+	// Returns the sub-pixel position in [0, 1)² of the given sample.
+	virtual Math::Vector2 Sample(
+		std::size_t x,
+		std::size_t y,
+		std::uint32_t sampleIndex) const = 0;
+
+	std::uint64_t Seed() const;
+
+	static std::unique_ptr<Sampler> Create(SamplerType type, std::uint64_t seed);
+
+protected:
+	// Decorrelates the sequences of neighbouring pixels.
+	std::uint32_t PixelHash(
+		std::size_t x,
+		std::size_t y,
+		std::uint32_t dimension) const;
+
+private:
+	std::uint64_t seed;
+};
+
+static_assert(!std::is_copy_constructible_v<Sampler>);
+static_assert(std::is_copy_assignable_v<Sampler>);
+static_assert(!std::is_trivially_copyable_v<Sampler>);
+
+static_assert(!std::is_move_constructible_v<Sampler>);
+static_assert(std::is_move_assignable_v<Sampler>);
+} // namespace LibRay::Sampling
+
+#endif // f28d6a10_93b6_4c7a_9818_760c9bede5f2
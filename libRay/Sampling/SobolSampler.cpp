@@ -0,0 +1,91 @@
+#include "SobolSampler.hpp"
+
+#include <array>
+
+#include "../Math/MathUtils.hpp"
+
+namespace LibRay::Sampling
+{
+using namespace Math;
+
+static std::uint32_t ReverseBits(std::uint32_t value)
+{
+	value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+	value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+	value = ((value >> 4) & 0x0f0f0f0fu) | ((value & 0x0f0f0f0fu) << 4);
+	value = ((value >> 8) & 0x00ff00ffu) | ((value & 0x00ff00ffu) << 8);
+
+	return (value >> 16) | (value << 16);
+}
+
+// Laine and Karras style hash, only ever propagates bits upwards.
+static std::uint32_t LaineKarrasPermutation(
+	std::uint32_t value,
+	std::uint32_t seed)
+{
+	value += seed;
+	value ^= value * 0x6c50b47cu;
+	value ^= value * 0xb82f1e52u;
+	value ^= value * 0xc7afe638u;
+	value ^= value * 0x8d22f6e6u;
+
+	return value;
+}
+
+static std::uint32_t NestedUniformScramble(
+	std::uint32_t value,
+	std::uint32_t seed)
+{
+	value = ReverseBits(value);
+	value = LaineKarrasPermutation(value, seed);
+
+	return ReverseBits(value);
+}
+
+static std::array<std::uint32_t, 32> MakeSecondDimension()
+{
+	std::array<std::uint32_t, 32> directions{};
+
+	directions[0] = 1u << 31;
+	for(std::size_t i = 1; i < directions.size(); ++i)
+		directions[i] = directions[i - 1] ^ (directions[i - 1] >> 1);
+
+	return directions;
+}
+
+static std::uint32_t Sobol(std::uint32_t index, std::uint32_t dimension)
+{
+	if(dimension == 0)
+		return ReverseBits(index);
+
+	static std::array<std::uint32_t, 32> const directions =
+		MakeSecondDimension();
+
+	std::uint32_t result = 0;
+	for(std::size_t bit = 0; index; index >>= 1, ++bit)
+	{
+		if(index & 1u)
+			result ^= directions[bit];
+	}
+
+	return result;
+}
+
+Vector2 SobolSampler::Sample(
+	std::size_t x,
+	std::size_t y,
+	std::uint32_t sampleIndex) const
+{
+	// Shuffle the sample order per pixel, this keeps any prefix of the
+	// sequence well distributed, while decorrelating neighbouring pixels.
+	std::uint32_t const index =
+		NestedUniformScramble(sampleIndex, PixelHash(x, y, 0));
+
+	std::uint32_t const u =
+		NestedUniformScramble(Sobol(index, 0), PixelHash(x, y, 1));
+	std::uint32_t const v =
+		NestedUniformScramble(Sobol(index, 1), PixelHash(x, y, 2));
+
+	return Vector2(ToUnitFloat(u), ToUnitFloat(v));
+}
+} // namespace LibRay::Sampling
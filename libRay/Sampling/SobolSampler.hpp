@@ -0,0 +1,35 @@
+#ifndef fe6357cc_43c4_4f32_86a6_57ddf20112bf
+#define fe6357cc_43c4_4f32_86a6_57ddf20112bf
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+#include "Sampler.hpp"
+
+namespace LibRay::Sampling
+{
+// The first two dimensions of the Sobol sequence, Owen scrambled per pixel
+// using hash based nested uniform scrambling (Burley 2020).
+class LIBRAY_API SobolSampler final: public Sampler
+{
+public:
+	using Sampler::Sampler;
+
+	Math::Vector2 Sample(
+		std::size_t x,
+		std::size_t y,
+		std::uint32_t sampleIndex) const override;
+};
+
+static_assert(std::is_copy_constructible_v<SobolSampler>);
+static_assert(std::is_copy_assignable_v<SobolSampler>);
+static_assert(!std::is_trivially_copyable_v<SobolSampler>);
+
+static_assert(std::is_move_constructible_v<SobolSampler>);
+static_assert(std::is_move_assignable_v<SobolSampler>);
+} // namespace LibRay::Sampling
+
+#endif // fe6357cc_43c4_4f32_86a6_57ddf20112bf
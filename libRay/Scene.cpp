@@ -1,16 +1,16 @@
 #include "Scene.hpp"
 
+#include <atomic>
 #include <cassert>
 
 #include "Material/Material.hpp"
+#include "Math/Matrix.hpp"
 #include "Math/Vector.hpp"
-#include "Math/MathUtils.hpp"
-#include "Shaders/BlinnPhong.hpp"
-#include "Shaders/BlinnPhongBump.hpp"
-#include "Shaders/EnvironmentMapping.hpp"
+#include "Shaders/Shader.hpp"
 #include "Shapes/Model/Model.hpp"
-#include "Shapes/Plane.hpp"
-#include "Shapes/Sphere.hpp"
+#include "Shapes/Model/ModelInstance.hpp"
+#include "Scenes.hpp"
+#include "Timeline.hpp"
 #include "Utilites.hpp"
 
 namespace LibRay
@@ -21,131 +21,60 @@ using namespace Shapes;
 
 Scene::Scene(
 	class Camera&& camera,
-	std::uint64_t,
+	std::uint64_t seed,
 	Color const &ambientLight,
-	float ambientIntensity)
+	float ambientIntensity,
+	float lightCutoff)
+: Scene(
+	std::move(camera),
+	seed,
+	ambientLight,
+	ambientIntensity,
+	Scenes::Nanosuit,
+	lightCutoff)
+{
+}
+
+Scene::Scene(
+	class Camera&& camera,
+	std::uint64_t seed,
+	Color const &ambientLight,
+	float ambientIntensity,
+	SceneLoader const &load,
+	float lightCutoff)
 : camera(std::move(camera))
+, seed(seed)
+, id(0)
+, meshes()
 , shapes()
 , unboundableShapes()
+, shapeIndices()
 , bvh()
 , lights()
+, lightCutoff(lightCutoff)
+, lightTree()
 , ambientLight(ambientLight)
 , ambientIntensity(ambientIntensity)
 , shaderStore()
 , materialStore()
 , modelLoader(materialStore)
+, loadSeconds(0.)
+, buildSeconds(0.)
 {
+	// 0 is never used, so it can mean no scene.
+	static std::atomic<std::uint64_t> lastId(0);
+	id = ++lastId;
+
 	Stopwatch watch;
 	watch.Start();
 
-	lights.emplace_back(Vector3(0.f, 24.f, 0.f), Color::White(), 300.0f);
-	lights.emplace_back(Vector3(0.f, 0.f, 50.f), Color::White(), 1000.0f);
-
-	Shader const &blinnPhong = shaderStore.AddShader(
-		"Blinn-Phong",
-		std::make_unique<BlinnPhongShader>());
-
-	Shader const &blinnPhongBump = shaderStore.AddShader(
-		"Blinn-Phong Bump",
-		std::make_unique<BlinnPhongShaderBump>());
-
-	Shader const &envMap = shaderStore.AddShader(
-		"Environment Mapping",
-		std::make_unique<EnvironmentMappingShader>());
-
-	//constexpr float const eggshell = 10;
-	constexpr float const mildlyShiny = 100;
-	//constexpr float const shiny = 1000;
-	//constexpr float const veryShiny = 10'000;
-
-	Texture planeTex("Resources/Textures/seamless_tileable_grass.jpg");
-
-	Material material(blinnPhong, 0.001f, 0.f);
-	material.UpdateFloatProperty("phong exponent", mildlyShiny);
-	material.UpdateTextureProperty("diffuse", planeTex);
-	material.UpdateTextureProperty("specular", Texture::White());
-
-	MaterialStore::IndexType const planeMat =
-		materialStore.AddMaterial("Plane", std::move(material));
-
-	Material material3(envMap);
-	Texture envMapTex("Resources/Textures/blue_grotto_4k.hdr");
-	material3.UpdateTextureProperty("diffuse", envMapTex);
-
-	MaterialStore::IndexType const envMapMat =
-		materialStore.AddMaterial("Environment Map", std::move(material3));
-
-	Material material2(blinnPhongBump, 0.002f, 0.f);
-	material2.UpdateColorProperty("specular", Color::White());
-	material2.UpdateFloatProperty("phong exponent", mildlyShiny);
-	material2.UpdateFloatProperty("bump strength", 0.5f);
-
-	Texture armTex("Resources/Textures/NanoSuit/arm_dif.png");
-	material2.UpdateTextureProperty("diffuse", armTex);
-	Texture armBumpTex("Resources/Textures/NanoSuit/arm_showroom_ddn.png");
-	material2.UpdateTextureProperty("bump map", armBumpTex);
-	Texture armSpecTex("Resources/Textures/NanoSuit/arm_showroom_spec.png");
-	material2.UpdateTextureProperty("specular", armSpecTex);
-	materialStore.AddMaterial("Arm", material2);
-
-	Texture bodyTex("Resources/Textures/NanoSuit/body_dif.png");
-	material2.UpdateTextureProperty("diffuse", bodyTex);
-	Texture bodyBumpTex("Resources/Textures/NanoSuit/body_showroom_ddn.png");
-	material2.UpdateTextureProperty("bump map", bodyBumpTex);
-	Texture bodySpecTex("Resources/Textures/NanoSuit/body_showroom_spec.png");
-	material2.UpdateTextureProperty("specular", bodySpecTex);
-	materialStore.AddMaterial("Body", material2);
-
-	Texture glassTex("Resources/Textures/NanoSuit/glass_dif.png");
-	material2.UpdateTextureProperty("diffuse", glassTex);
-	Texture glassBumpTex("Resources/Textures/NanoSuit/glass_ddn.png");
-	material2.UpdateTextureProperty("bump map", glassBumpTex);
-	material2.UpdateTextureProperty("specular", Texture::White());
-	materialStore.AddMaterial("Glass", material2);
-
-	Texture handTex("Resources/Textures/NanoSuit/hand_dif.png");
-	material2.UpdateTextureProperty("diffuse", handTex);
-	Texture handBumpTex("Resources/Textures/NanoSuit/hand_showroom_ddn.png");
-	material2.UpdateTextureProperty("bump map", handBumpTex);
-	Texture handSpecTex("Resources/Textures/NanoSuit/hand_showroom_spec.png");
-	material2.UpdateTextureProperty("specular", handSpecTex);
-	materialStore.AddMaterial("Hand", material2);
-
-	Texture helmetTex("Resources/Textures/NanoSuit/helmet_dif.png");
-	material2.UpdateTextureProperty("diffuse", helmetTex);
-	Texture helmetBumpTex("Resources/Textures/NanoSuit/helmet_showroom_ddn.png");
-	material2.UpdateTextureProperty("bump map", helmetBumpTex);
-	Texture helmetSpecTex("Resources/Textures/NanoSuit/helmet_showroom_spec.png");
-	material2.UpdateTextureProperty("specular", helmetSpecTex);
-	materialStore.AddMaterial("Helmet", material2);
-
-	Texture legTex("Resources/Textures/NanoSuit/leg_dif.png");
-	material2.UpdateTextureProperty("diffuse", legTex);
-	Texture legBumpTex("Resources/Textures/NanoSuit/leg_showroom_ddn.png");
-	material2.UpdateTextureProperty("bump map", legBumpTex);
-	Texture legSpecTex("Resources/Textures/NanoSuit/leg_showroom_spec.png");
-	material2.UpdateTextureProperty("specular", legSpecTex);
-	materialStore.AddMaterial("Leg", material2);
-
-	LoadModel(
-		"Resources/Models/nanosuit.obj",
-		Transform(Vector3(0, -10, 0), Vector3(0), Vector3(1)));
-
-	auto plane = std::make_unique<Plane>(
-		Transform(Vector3(0, -10, 0)),
-		materialStore,
-		planeMat);
-
-	shapes.push_back(std::move(plane));
-
-	auto environment = std::make_unique<Sphere>(
-		Transform(camera.Transform().Position(), Vector3(0, Math::PI * 0.5f, 0), Vector3(100)),
-		materialStore,
-		envMapMat);
-
-	shapes.push_back(std::move(environment));
+	{
+		Timeline::Span const span("Load scene");
+		load(*this);
+	}
 
 	watch.Stop();
+	loadSeconds = watch.Seconds();
 
 	std::printf(
 		"Loading scene took %s to place %zu objects\n",
@@ -155,25 +84,16 @@ Scene::Scene(
 
 	watch.Start();
 
-	std::vector<Observer<BaseShape<Shape> const>> shapesForBVH;
-	shapesForBVH.reserve(shapes.size());
-
-	for(std::unique_ptr<Shape> &shape: shapes)
-		shape->Transform().RecalculateMatrix();
-
-	for(std::unique_ptr<Shape> const &shape: shapes)
 	{
-		if(shape->IsBoundable())
-			shapesForBVH.push_back(shape.get());
-		else
-			unboundableShapes.push_back(shape.get());
+		Timeline::Span const span("Build scene");
+		Build();
 	}
 
-	bvh = std::make_unique<Containers::BVH<Shape>>(std::move(shapesForBVH));
-
 	watch.Stop();
+	buildSeconds = watch.Seconds();
 
 	std::printf("BVH creation took %s\n", watch.Value().c_str());
+	std::printf("%s", Memory().Summary().c_str());
 	std::fflush(stdout);
 }
 
@@ -199,22 +119,288 @@ Containers::BVH<Shape> const &Scene::BoundingVolumeHierarchy() const
 	return *bvh;
 }
 
+std::size_t Scene::ShapeIndex(Shape const &shape) const
+{
+	auto const it = shapeIndices.find(&shape);
+	assert(it != shapeIndices.end());
+
+	return it->second;
+}
+
 std::vector<Light> const &Scene::Lights() const
 {
 	return lights;
 }
 
+void Scene::UpdateLight(std::size_t index, Light const &light)
+{
+	assert(index < lights.size());
+
+	lights[index] = light;
+	lightTree = std::make_unique<Containers::LightTree>(lights, lightCutoff);
+}
+
+Material &Scene::MaterialByName(std::string const &name)
+{
+	return materialStore.MaterialByIndex(
+		materialStore.MaterialIndexByName(name));
+}
+
+bool Scene::HasRefractiveMaterials() const
+{
+	for(auto const &[name, material]: materialStore.Materials())
+	{
+		if(material.RefractiveIndexInside() > 0.f)
+			return true;
+	}
+
+	return false;
+}
+
+void Scene::UpdateCameraTransform(class Transform const &transform)
+{
+	camera.UpdateTransform(transform);
+}
+
+void Scene::UpdateCameraScreenSize(Vector2st const &screenSize)
+{
+	camera.UpdateScreenSize(screenSize);
+}
+
+void Scene::UpdateShapeTransform(
+	std::size_t index,
+	class Transform const &transform)
+{
+	assert(index < shapes.size());
+
+	class Transform &shapeTransform = shapes[index]->Transform();
+	shapeTransform = transform;
+	shapeTransform.RecalculateMatrix();
+}
+
+void Scene::RefitBoundingVolumeHierarchy()
+{
+	assert(bvh);
+
+	bvh->Refit();
+}
+
+Containers::LightTree const &Scene::LightTree() const
+{
+	assert(lightTree);
+
+	return *lightTree;
+}
+
 std::pair<Materials::Color const &, float> Scene::AmbientLight() const
 {
 	return {ambientLight, ambientIntensity};
 }
 
+std::uint64_t Scene::Id() const
+{
+	return id;
+}
+
+std::uint64_t Scene::Seed() const
+{
+	return seed;
+}
+
+std::uint64_t Scene::Fingerprint() const
+{
+	Hasher hasher;
+	hasher.Add(GeometryFingerprint());
+
+	for(Light const &light: lights)
+	{
+		hasher.Add(light.Color().r).Add(light.Color().g).Add(light.Color().b);
+		hasher.Add(light.Intensity());
+	}
+
+	hasher.Add(lightCutoff);
+
+	hasher.Add(ambientLight.r).Add(ambientLight.g).Add(ambientLight.b);
+	hasher.Add(ambientIntensity);
+
+	hasher.Add(std::uint64_t(materialStore.Materials().size()));
+	for(auto const &[name, material]: materialStore.Materials())
+		hasher.Add(name).Add(material.Fingerprint());
+
+	for(std::unique_ptr<Shape> const &shape: shapes)
+		hasher.Add(std::uint64_t(shape->MaterialIndex()));
+
+	return hasher.Value();
+}
+
+std::uint64_t Scene::GeometryFingerprint() const
+{
+	Hasher hasher;
+
+	auto const addVector = [&hasher](Vector3 const &vector)
+	{
+		hasher.Add(vector.x).Add(vector.y).Add(vector.z);
+	};
+
+	auto const addMatrix = [&hasher](Matrix4x4 const &matrix)
+	{
+		for(int i = 0; i < 4; ++i)
+		{
+			for(int j = 0; j < 4; ++j)
+				hasher.Add(matrix[i][j]);
+		}
+	};
+
+	Camera::Frustum const frustum = camera.SceneFrustum();
+
+	hasher
+		.Add(seed)
+		.Add(std::uint64_t(camera.ScreenSize().x))
+		.Add(std::uint64_t(camera.ScreenSize().y))
+		.Add(frustum.fovY)
+		.Add(frustum.nearPlaneDistance)
+		.Add(frustum.farPlaneDistance);
+
+	addMatrix(camera.Transform().Matrix());
+
+	hasher.Add(std::uint64_t(shapes.size()));
+	for(std::unique_ptr<Shape> const &shape: shapes)
+	{
+		addMatrix(shape->Transform().Matrix());
+
+		if(shape->IsBoundable())
+		{
+			Containers::BoundingBox const box = shape->CalculateBoundingBox();
+			addVector(box.Position());
+			addVector(box.HalfBoundaries());
+		}
+	}
+
+	hasher.Add(std::uint64_t(lights.size()));
+	for(Light const &light: lights)
+		addVector(light.Position());
+
+	return hasher.Value();
+}
+
+std::uint64_t Scene::ShadowFingerprint() const
+{
+	Hasher hasher;
+
+	for(auto const &[name, material]: materialStore.Materials())
+		hasher.Add(std::uint64_t(material.RefractiveIndexInside() > 0.f));
+
+	return hasher.Value();
+}
+
+double Scene::LoadSeconds() const
+{
+	return loadSeconds;
+}
+
+double Scene::BuildSeconds() const
+{
+	return buildSeconds;
+}
+
+MemoryReport Scene::Memory() const
+{
+	MemoryReport report;
+
+	for(auto const &[materialName, material]: materialStore.Materials())
+	{
+		for(auto const &[property, texture]: material.TextureProperties())
+		{
+			report.textures.push_back({
+				materialName,
+				property,
+				texture.Dimensions(),
+				texture.MemorySize()});
+		}
+	}
+
+	for(std::size_t i = 0; i < shapes.size(); ++i)
+		shapes[i]->AddMemory(report, i);
+
+	// Past the indices of the shapes, the instances don't count them again.
+	for(std::size_t i = 0; i < meshes.size(); ++i)
+		meshes[i]->AddMemory(report, shapes.size() + i);
+
+	if(bvh)
+		report.sceneBVH = bvh->Memory();
+
+	Vector2st const &screenSize = camera.ScreenSize();
+	report.framebufferBytes = screenSize.x * screenSize.y * sizeof(Color);
+
+	report.peakResidentBytes = PeakResidentBytes();
+
+	return report;
+}
+
+Shader const &Scene::AddShader(
+	std::string const &name,
+	std::unique_ptr<Shader> shader)
+{
+	return shaderStore.AddShader(name, std::move(shader));
+}
+
+MaterialStore::IndexType Scene::AddMaterial(
+	std::string const &name,
+	Material material)
+{
+	return materialStore.AddMaterial(name, std::move(material));
+}
+
+void Scene::AddLight(Light const &light)
+{
+	assert(!lightTree);
+
+	lights.push_back(light);
+}
+
+void Scene::AddShape(std::unique_ptr<Shape> shape)
+{
+	assert(!bvh);
+
+	shapes.push_back(std::move(shape));
+}
+
+Model const &Scene::AddMesh(std::vector<ModelTriangle::Vertex> vertices)
+{
+	assert(!bvh);
+
+	meshes.push_back(std::make_unique<Model>(
+		std::move(vertices),
+		Transform(Vector3(0)),
+		materialStore,
+		0));
+
+	Model &mesh = *meshes.back();
+	mesh.Transform().RecalculateMatrix();
+
+	return mesh;
+}
+
+void Scene::AddModelInstance(
+	Model const &mesh,
+	Transform const &transform,
+	MaterialStore::IndexType materialIndex)
+{
+	AddShape(std::make_unique<ModelInstance>(
+		&mesh,
+		transform,
+		materialStore,
+		materialIndex));
+}
+
 void Scene::LoadModel(
 	std::string const &fileName,
 	Transform const &transform,
 	MaterialStore::IndexType materialIndex,
 	bool invertNormalZ)
 {
+	assert(!bvh);
+
 	std::vector<std::unique_ptr<Model>> models = modelLoader.LoadObj(
 		fileName,
 		transform,
@@ -227,4 +413,27 @@ void Scene::LoadModel(
 		std::make_move_iterator(models.begin()),
 		std::make_move_iterator(models.end()));
 }
+
+void Scene::Build()
+{
+	std::vector<Observer<BaseShape<Shape> const>> shapesForBVH;
+	shapesForBVH.reserve(shapes.size());
+
+	for(std::unique_ptr<Shape> &shape: shapes)
+		shape->Transform().RecalculateMatrix();
+
+	for(std::size_t i = 0; i < shapes.size(); ++i)
+		shapeIndices.emplace(shapes[i].get(), i);
+
+	for(std::unique_ptr<Shape> const &shape: shapes)
+	{
+		if(shape->IsBoundable())
+			shapesForBVH.push_back(shape.get());
+		else
+			unboundableShapes.push_back(shape.get());
+	}
+
+	bvh = std::make_unique<Containers::BVH<Shape>>(std::move(shapesForBVH));
+	lightTree = std::make_unique<Containers::LightTree>(lights, lightCutoff);
+}
 } // namespace LibRay
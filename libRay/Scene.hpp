@@ -2,18 +2,23 @@
 #define b0731c79_ae35_830e_9bd9_1c6eba4e3426
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "Containers/BoundingVolumeHierarchy.hpp"
+#include "Containers/LightTree.hpp"
 #include "Material/MaterialStore.hpp"
 #include "Shaders/ShaderStore.hpp"
 #include "Shapes/Model/ModelLoader.hpp"
 #include "API.hpp"
 #include "Camera.hpp"
 #include "Light.hpp"
+#include "MemoryReport.hpp"
 
 namespace LibRay
 {
@@ -22,16 +27,33 @@ namespace Shapes
 class Shape;
 } // namespace Shapes
 
+class Scene;
+class Shader;
 class Transform;
 
+// Fills a scene with its shaders, materials, lights, and shapes, through the
+// loading functions of Scene. See Scenes.hpp for the built-in ones.
+using SceneLoader = std::function<void(Scene &scene)>;
+
 class LIBRAY_API Scene final
 {
 public:
+	// Loads the nanosuit scene.
+	Scene(
+		class Camera&& camera,
+		std::uint64_t seed,
+		Materials::Color const &ambientLight,
+		float ambientIntensity,
+		float lightCutoff = 1.f / 1024.f);
+
+	// Calls load, then builds the BVH and light tree over what it added.
 	Scene(
 		class Camera&& camera,
 		std::uint64_t seed,
 		Materials::Color const &ambientLight,
-		float ambientIntensity);
+		float ambientIntensity,
+		SceneLoader const &load,
+		float lightCutoff = 1.f / 1024.f);
 
 	Scene(Scene &&other) = default;
 	Scene(Scene const &) = delete;
@@ -45,25 +67,116 @@ public:
 	std::vector<std::unique_ptr<Shapes::Shape>> const &Shapes() const;
 	Containers::BVH<Shapes::Shape> const &BoundingVolumeHierarchy() const;
 
+	// The index of shape in Shapes.
+	std::size_t ShapeIndex(Shapes::Shape const &shape) const;
+
 	std::vector<Light> const &Lights() const;
 
+	// Don't change lights or materials while rendering.
+	void UpdateLight(std::size_t index, Light const &light);
+	Materials::Material &MaterialByName(std::string const &name);
+
+	// Whether any material lets shadow rays through, checks every material.
+	bool HasRefractiveMaterials() const;
+
+	// Don't move the camera or shapes while rendering either. Call
+	// RefitBoundingVolumeHierarchy after moving shapes, before rendering.
+	void UpdateCameraTransform(class Transform const &transform);
+	void UpdateCameraScreenSize(Math::Vector2st const &screenSize);
+	void UpdateShapeTransform(std::size_t index, class Transform const &transform);
+	void RefitBoundingVolumeHierarchy();
+
+	// Finds the lights that add more than the light cutoff at a position.
+	Containers::LightTree const &LightTree() const;
+
 	std::pair<Materials::Color const &, float> AmbientLight() const;
 
-private:
+	std::uint64_t Seed() const;
+
+	// Unique among the scenes created by this process, for caches that might
+	// outlive a scene.
+	std::uint64_t Id() const;
+
+	// Changes whenever the camera, geometry, lights, ambient light, seed,
+	// materials, their shaders and textures, or which shape has which
+	// material change. Hashes every texture, so it's not free.
+	std::uint64_t Fingerprint() const;
+
+	// Like Fingerprint, but only covers what decides which surfaces and
+	// lights are visible, not light colors and intensities, or ambient light.
+	std::uint64_t GeometryFingerprint() const;
+
+	// Changes whenever a material starts or stops letting shadow rays
+	// through, by becoming refractive or opaque.
+	std::uint64_t ShadowFingerprint() const;
+
+	// How long the loader and building the BVH and light tree took.
+	double LoadSeconds() const;
+	double BuildSeconds() const;
+
+	// What the textures, models, and hierarchies of the scene take, and a
+	// framebuffer of the size of the camera. Walks every hierarchy, so
+	// it's not free.
+	MemoryReport Memory() const;
+
+	// Only for SceneLoaders, while the scene is loading.
+	Shader const &AddShader(
+		std::string const &name,
+		std::unique_ptr<Shader> shader);
+
+	Materials::MaterialStore::IndexType AddMaterial(
+		std::string const &name,
+		Materials::Material material);
+
+	void AddLight(Light const &light);
+
+	// Creates a T from transform and the material at materialIndex.
+	template<typename T>
+	T &AddShape(
+		class Transform const &transform,
+		Materials::MaterialStore::IndexType materialIndex);
+
+	void AddShape(std::unique_ptr<Shapes::Shape> shape);
+
+	// Builds a model of vertices, three per triangle, that's only rendered
+	// through the instances added with AddModelInstance. The model stays
+	// with the scene.
+	Shapes::Model const &AddMesh(std::vector<Shapes::ModelTriangle::Vertex> vertices);
+
+	// Renders mesh, from AddMesh, once more with its own transform and
+	// material, without copying its triangles.
+	void AddModelInstance(
+		Shapes::Model const &mesh,
+		class Transform const &transform,
+		Materials::MaterialStore::IndexType materialIndex);
+
+	// Adds every object in the file as a model, the materials the file names
+	// have to be added first.
 	void LoadModel(
 		std::string const &fileName,
-		Transform const &transform,
+		class Transform const &transform,
 		Materials::MaterialStore::IndexType materialIndex = 0,
 		bool invertNormalZ = false);
 
+private:
+	void Build();
+
 private:
 	class Camera camera;
+	std::uint64_t seed;
+	std::uint64_t id;
+
+	// Instanced by shapes, not rendered on their own.
+	std::vector<std::unique_ptr<Shapes::Model>> meshes;
 
 	std::vector<std::unique_ptr<Shapes::Shape>> shapes;
 	std::vector<Observer<Shapes::Shape const>> unboundableShapes;
+	std::unordered_map<Observer<Shapes::Shape const>, std::size_t> shapeIndices;
 	std::unique_ptr<Containers::BVH<Shapes::Shape>> bvh;
 
 	std::vector<Light> lights;
+	float lightCutoff;
+	std::unique_ptr<Containers::LightTree> lightTree;
 
 	Materials::Color ambientLight;
 	float ambientIntensity;
@@ -72,6 +185,9 @@ private:
 	Materials::MaterialStore materialStore;
 
 	Shapes::ModelLoader modelLoader;
+
+	double loadSeconds;
+	double buildSeconds;
 };
 
 static_assert(!std::is_copy_constructible_v<Scene>);
@@ -82,4 +198,8 @@ static_assert(std::is_move_constructible_v<Scene>);
 static_assert(!std::is_move_assignable_v<Scene>);
 } // namespace LibRay
 
+#if !defined(VIM_WORKAROUND)
+#include "Scene_impl.hpp"
+#endif
+
 #endif // b0731c79_ae35_830e_9bd9_1c6eba4e3426
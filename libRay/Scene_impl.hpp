@@ -0,0 +1,24 @@
+#ifndef e7df1c48_b350_4307_ac75_53f4f93bbb2d
+#define e7df1c48_b350_4307_ac75_53f4f93bbb2d
+
+#ifdef VIM_WORKAROUND
+#include "Scene.hpp"
+#endif
+
+namespace LibRay
+{
+template<typename T>
+T &Scene::AddShape(
+	class Transform const &transform,
+	Materials::MaterialStore::IndexType materialIndex)
+{
+	auto shape = std::make_unique<T>(transform, materialStore, materialIndex);
+	T &added = *shape;
+
+	AddShape(std::move(shape));
+
+	return added;
+}
+} // namespace LibRay
+
+#endif // e7df1c48_b350_4307_ac75_53f4f93bbb2d
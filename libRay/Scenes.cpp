@@ -0,0 +1,1061 @@
+#include "Scenes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Material/Color.hpp"
+#include "Material/Material.hpp"
+#include "Material/Texture.hpp"
+#include "Math/MathUtils.hpp"
+#include "Math/Vector.hpp"
+#include "Shaders/BlinnPhong.hpp"
+#include "Shaders/BlinnPhongBump.hpp"
+#include "Shaders/EnvironmentMapping.hpp"
+#include "Shapes/Model/Model.hpp"
+#include "Shapes/Box.hpp"
+#include "Shapes/Plane.hpp"
+#include "Shapes/Rectangle.hpp"
+#include "Shapes/Sphere.hpp"
+#include "Light.hpp"
+
+namespace LibRay::Scenes
+{
+using namespace Materials;
+using namespace Math;
+using namespace Shapes;
+
+constexpr float const mildlyShiny = 100;
+constexpr float const shiny = 1000;
+
+constexpr float const glassIndex = 1.5f;
+
+static Texture SolidColor(Color const &color)
+{
+	return Texture(Vector2st(1, 1), std::vector<Color>{color});
+}
+
+static Material Plastic(
+	Shader const &shader,
+	Texture const &diffuse,
+	float phongExponent = mildlyShiny,
+	float reflectiveness = 0.f)
+{
+	Material material(shader, reflectiveness);
+	material.UpdateFloatProperty("phong exponent", phongExponent);
+	material.UpdateTextureProperty("diffuse", diffuse);
+	material.UpdateTextureProperty("specular", Texture::White());
+
+	return material;
+}
+
+// The materials named by nanosuit.obj.
+static void AddNanosuitMaterials(Scene &scene, Shader const &blinnPhongBump)
+{
+	Material material(blinnPhongBump, 0.002f, 0.f);
+	material.UpdateColorProperty("specular", Color::White());
+	material.UpdateFloatProperty("phong exponent", mildlyShiny);
+	material.UpdateFloatProperty("bump strength", 0.5f);
+
+	Texture armTex("Resources/Textures/NanoSuit/arm_dif.png");
+	material.UpdateTextureProperty("diffuse", armTex);
+	Texture armBumpTex("Resources/Textures/NanoSuit/arm_showroom_ddn.png");
+	material.UpdateTextureProperty("bump map", armBumpTex);
+	Texture armSpecTex("Resources/Textures/NanoSuit/arm_showroom_spec.png");
+	material.UpdateTextureProperty("specular", armSpecTex);
+	scene.AddMaterial("Arm", material);
+
+	Texture bodyTex("Resources/Textures/NanoSuit/body_dif.png");
+	material.UpdateTextureProperty("diffuse", bodyTex);
+	Texture bodyBumpTex("Resources/Textures/NanoSuit/body_showroom_ddn.png");
+	material.UpdateTextureProperty("bump map", bodyBumpTex);
+	Texture bodySpecTex("Resources/Textures/NanoSuit/body_showroom_spec.png");
+	material.UpdateTextureProperty("specular", bodySpecTex);
+	scene.AddMaterial("Body", material);
+
+	Texture glassTex("Resources/Textures/NanoSuit/glass_dif.png");
+	material.UpdateTextureProperty("diffuse", glassTex);
+	Texture glassBumpTex("Resources/Textures/NanoSuit/glass_ddn.png");
+	material.UpdateTextureProperty("bump map", glassBumpTex);
+	material.UpdateTextureProperty("specular", Texture::White());
+	scene.AddMaterial("Glass", material);
+
+	Texture handTex("Resources/Textures/NanoSuit/hand_dif.png");
+	material.UpdateTextureProperty("diffuse", handTex);
+	Texture handBumpTex("Resources/Textures/NanoSuit/hand_showroom_ddn.png");
+	material.UpdateTextureProperty("bump map", handBumpTex);
+	Texture handSpecTex("Resources/Textures/NanoSuit/hand_showroom_spec.png");
+	material.UpdateTextureProperty("specular", handSpecTex);
+	scene.AddMaterial("Hand", material);
+
+	Texture helmetTex("Resources/Textures/NanoSuit/helmet_dif.png");
+	material.UpdateTextureProperty("diffuse", helmetTex);
+	Texture helmetBumpTex("Resources/Textures/NanoSuit/helmet_showroom_ddn.png");
+	material.UpdateTextureProperty("bump map", helmetBumpTex);
+	Texture helmetSpecTex("Resources/Textures/NanoSuit/helmet_showroom_spec.png");
+	material.UpdateTextureProperty("specular", helmetSpecTex);
+	scene.AddMaterial("Helmet", material);
+
+	Texture legTex("Resources/Textures/NanoSuit/leg_dif.png");
+	material.UpdateTextureProperty("diffuse", legTex);
+	Texture legBumpTex("Resources/Textures/NanoSuit/leg_showroom_ddn.png");
+	material.UpdateTextureProperty("bump map", legBumpTex);
+	Texture legSpecTex("Resources/Textures/NanoSuit/leg_showroom_spec.png");
+	material.UpdateTextureProperty("specular", legSpecTex);
+	scene.AddMaterial("Leg", material);
+}
+
+void Nanosuit(Scene &scene)
+{
+	scene.AddLight(Light(Vector3(0.f, 24.f, 0.f), Color::White(), 300.0f));
+	scene.AddLight(Light(Vector3(0.f, 0.f, 50.f), Color::White(), 1000.0f));
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	Shader const &blinnPhongBump = scene.AddShader(
+		"Blinn-Phong Bump",
+		std::make_unique<BlinnPhongShaderBump>());
+
+	Shader const &envMap = scene.AddShader(
+		"Environment Mapping",
+		std::make_unique<EnvironmentMappingShader>());
+
+	Texture planeTex("Resources/Textures/seamless_tileable_grass.jpg");
+
+	Material material(blinnPhong, 0.001f, 0.f);
+	material.UpdateFloatProperty("phong exponent", mildlyShiny);
+	material.UpdateTextureProperty("diffuse", planeTex);
+	material.UpdateTextureProperty("specular", Texture::White());
+
+	MaterialStore::IndexType const planeMat =
+		scene.AddMaterial("Plane", std::move(material));
+
+	Material material3(envMap);
+	Texture envMapTex("Resources/Textures/blue_grotto_4k.hdr");
+	material3.UpdateTextureProperty("diffuse", envMapTex);
+
+	MaterialStore::IndexType const envMapMat =
+		scene.AddMaterial("Environment Map", std::move(material3));
+
+	AddNanosuitMaterials(scene, blinnPhongBump);
+
+	scene.LoadModel(
+		"Resources/Models/nanosuit.obj",
+		Transform(Vector3(0, -10, 0), Vector3(0), Vector3(1)));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, -10, 0)), planeMat);
+
+	scene.AddShape<Sphere>(
+		Transform(
+			scene.Camera().Transform().Position(),
+			Vector3(0, Math::PI * 0.5f, 0),
+			Vector3(100)),
+		envMapMat);
+}
+
+void Spheres(Scene &scene)
+{
+	std::uint64_t random = scene.Seed();
+
+	scene.AddLight(Light(Vector3(-20.f, 40.f, 10.f), Color::White(), 1500.f));
+	scene.AddLight(Light(Vector3(20.f, 30.f, -50.f), Color::White(), 1500.f));
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	std::vector<MaterialStore::IndexType> colors;
+	for(std::size_t i = 0; i < 8; ++i)
+	{
+		Color const color(
+			RandomRange(random, 0.2f, 1.f),
+			RandomRange(random, 0.2f, 1.f),
+			RandomRange(random, 0.2f, 1.f));
+
+		colors.push_back(scene.AddMaterial(
+			"Sphere " + std::to_string(i),
+			Plastic(blinnPhong, SolidColor(color))));
+	}
+
+	MaterialStore::IndexType const ground = scene.AddMaterial(
+		"Ground",
+		Plastic(blinnPhong, SolidColor(Color(0.5f, 0.5f, 0.5f))));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, -1, 0)), ground);
+
+	// A jittered 16 by 16 by 16 grid.
+	constexpr std::size_t const side = 16;
+	for(std::size_t x = 0; x < side; ++x)
+	{
+		for(std::size_t y = 0; y < side; ++y)
+		{
+			for(std::size_t z = 0; z < side; ++z)
+			{
+				Vector3 const position(
+					-24.f + 3.f * float(x) + RandomRange(random, -1.f, 1.f),
+					1.f * float(y) + RandomRange(random, 0.f, 1.f),
+					-10.f - 3.f * float(z) + RandomRange(random, -1.f, 1.f));
+
+				float const radius = RandomRange(random, 0.2f, 0.6f);
+				std::size_t const color =
+					std::size_t(NextRandom(random) * float(colors.size()));
+
+				scene.AddShape<Sphere>(
+					Transform(position, Vector3(0), Vector3(radius)),
+					colors[color]);
+			}
+		}
+	}
+}
+
+void Mesh(Scene &scene)
+{
+	scene.AddLight(Light(Vector3(0.f, 30.f, 10.f), Color::White(), 1000.f));
+	scene.AddLight(Light(Vector3(-20.f, 10.f, 20.f), Color::White(), 500.f));
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	Shader const &blinnPhongBump = scene.AddShader(
+		"Blinn-Phong Bump",
+		std::make_unique<BlinnPhongShaderBump>());
+
+	AddNanosuitMaterials(scene, blinnPhongBump);
+
+	MaterialStore::IndexType const ground = scene.AddMaterial(
+		"Ground",
+		Plastic(blinnPhong, SolidColor(Color(0.4f, 0.4f, 0.4f))));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, 0, 0)), ground);
+
+	for(std::size_t i = 0; i < 4; ++i)
+	{
+		Vector3 const position(
+			i % 2 == 0 ? -5.f : 5.f,
+			0.f,
+			i / 2 == 0 ? -2.f : -14.f);
+
+		scene.LoadModel(
+			"Resources/Models/nanosuit.obj",
+			Transform(position, Vector3(0, Math::PI * 0.25f * float(i), 0)));
+	}
+}
+
+void Glass(Scene &scene)
+{
+	scene.AddLight(Light(Vector3(0.f, 20.f, 0.f), Color::White(), 800.f));
+	scene.AddLight(Light(Vector3(-15.f, 8.f, 10.f), Color::White(), 400.f));
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	Texture const checker("Resources/Textures/1024x1024 Texel Density Texture 1.png");
+
+	MaterialStore::IndexType const floor = scene.AddMaterial(
+		"Floor",
+		Plastic(blinnPhong, checker));
+
+	Material glass = Plastic(
+		blinnPhong,
+		SolidColor(Color(0.9f, 0.95f, 1.f)),
+		shiny);
+	glass.RefractiveIndexInside(glassIndex);
+
+	MaterialStore::IndexType const glassMat =
+		scene.AddMaterial("Glass", std::move(glass));
+
+	MaterialStore::IndexType const mirror = scene.AddMaterial(
+		"Mirror",
+		Plastic(blinnPhong, SolidColor(Color(0.8f, 0.8f, 0.8f)), shiny, 0.9f));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, -1, 0)), floor);
+
+	// Mirrors behind and to the side, so refracted rays keep bouncing.
+	scene.AddShape<Rectangle>(
+		Transform(Vector3(0, 5, -22), Vector3(0), Vector3(40, 12, 1)),
+		mirror);
+
+	scene.AddShape<Rectangle>(
+		Transform(
+			Vector3(-18, 5, -8),
+			Vector3(0, Math::PI * 0.5f, 0),
+			Vector3(30, 12, 1)),
+		mirror);
+
+	for(std::size_t x = 0; x < 5; ++x)
+	{
+		for(std::size_t z = 0; z < 5; ++z)
+		{
+			Vector3 const position(-10.f + 5.f * float(x), 1.f, -2.f - 4.f * float(z));
+
+			if((x + z) % 2 == 0)
+			{
+				scene.AddShape<Sphere>(
+					Transform(position, Vector3(0), Vector3(1.8f)),
+					glassMat);
+			}
+			else
+			{
+				scene.AddShape<Box>(
+					Transform(
+						position,
+						Vector3(0, Math::PI * 0.2f * float(x + z), 0),
+						Vector3(2.5f)),
+					(x + z) % 4 == 1 ? mirror : glassMat);
+			}
+		}
+	}
+}
+
+void Lights(Scene &scene)
+{
+	std::uint64_t random = scene.Seed();
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	MaterialStore::IndexType const ground = scene.AddMaterial(
+		"Ground",
+		Plastic(blinnPhong, SolidColor(Color(0.6f, 0.6f, 0.6f))));
+
+	MaterialStore::IndexType const boxes = scene.AddMaterial(
+		"Boxes",
+		Plastic(blinnPhong, SolidColor(Color(0.8f, 0.7f, 0.5f))));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, 0, 0)), ground);
+
+	// Small lights that only reach their neighbours, on a 16 by 16 grid.
+	for(std::size_t x = 0; x < 16; ++x)
+	{
+		for(std::size_t z = 0; z < 16; ++z)
+		{
+			Color const color(
+				RandomRange(random, 0.3f, 1.f),
+				RandomRange(random, 0.3f, 1.f),
+				RandomRange(random, 0.3f, 1.f));
+
+			scene.AddLight(Light(
+				Vector3(-45.f + 6.f * float(x), 3.f, 5.f - 6.f * float(z)),
+				color,
+				4.f));
+		}
+	}
+
+	for(std::size_t i = 0; i < 400; ++i)
+	{
+		Vector3 const position(
+			RandomRange(random, -48.f, 48.f),
+			0.5f,
+			RandomRange(random, -90.f, 8.f));
+
+		scene.AddShape<Box>(
+			Transform(
+				position,
+				Vector3(0, RandomRange(random, 0.f, Math::PI), 0),
+				Vector3(1.f, RandomRange(random, 1.f, 3.f), 1.f)),
+			boxes);
+	}
+}
+
+void Textures(Scene &scene)
+{
+	scene.AddLight(Light(Vector3(0.f, 20.f, 10.f), Color::White(), 1000.f));
+	scene.AddLight(Light(Vector3(15.f, 5.f, 5.f), Color::White(), 300.f));
+
+	Shader const &blinnPhong = scene.AddShader(
+		"Blinn-Phong",
+		std::make_unique<BlinnPhongShader>());
+
+	Shader const &blinnPhongBump = scene.AddShader(
+		"Blinn-Phong Bump",
+		std::make_unique<BlinnPhongShaderBump>());
+
+	using Wrap = Texture::WrappingMethod;
+
+	Texture const checker(
+		"Resources/Textures/1024x1024 Texel Density Texture 1.png",
+		false,
+		Wrap::MirrorRepeat,
+		Wrap::MirrorRepeat);
+
+	Texture const earth(
+		"Resources/Textures/2k_earth_daymap.jpg",
+		true,
+		Wrap::Repeat,
+		Wrap::Clamp);
+
+	Texture const container(
+		"Resources/Textures/container.jpg",
+		false,
+		Wrap::Clamp,
+		Wrap::Clamp);
+
+	Texture const sky("Resources/Textures/sky.jpg");
+
+	MaterialStore::IndexType const floor = scene.AddMaterial(
+		"Floor",
+		Plastic(blinnPhong, checker));
+
+	MaterialStore::IndexType const earthMat = scene.AddMaterial(
+		"Earth",
+		Plastic(blinnPhong, earth));
+
+	MaterialStore::IndexType const containerMat = scene.AddMaterial(
+		"Container",
+		Plastic(blinnPhong, container));
+
+	MaterialStore::IndexType const skyMat = scene.AddMaterial(
+		"Sky",
+		Plastic(blinnPhong, sky));
+
+	// Bump and specular mapped too, three textures per hit.
+	Material armor(blinnPhongBump);
+	armor.UpdateFloatProperty("phong exponent", mildlyShiny);
+	armor.UpdateFloatProperty("bump strength", 1.f);
+	armor.UpdateTextureProperty(
+		"diffuse",
+		Texture("Resources/Textures/NanoSuit/body_dif.png"));
+	armor.UpdateTextureProperty(
+		"bump map",
+		Texture("Resources/Textures/NanoSuit/body_showroom_ddn.png"));
+	armor.UpdateTextureProperty(
+		"specular",
+		Texture("Resources/Textures/NanoSuit/body_showroom_spec.png"));
+
+	MaterialStore::IndexType const armorMat =
+		scene.AddMaterial("Armor", std::move(armor));
+
+	scene.AddShape<Plane>(Transform(Vector3(0, -1, 0)), floor);
+
+	scene.AddShape<Rectangle>(
+		Transform(Vector3(0, 8, -30), Vector3(0), Vector3(70, 20, 1)),
+		skyMat);
+
+	std::vector<MaterialStore::IndexType> const materials =
+		{earthMat, containerMat, armorMat};
+
+	for(std::size_t x = 0; x < 6; ++x)
+	{
+		for(std::size_t z = 0; z < 4; ++z)
+		{
+			Vector3 const position(-12.5f + 5.f * float(x), 1.f, -4.f - 6.f * float(z));
+			MaterialStore::IndexType const material = materials[(x + z) % 3];
+
+			if(material == containerMat)
+			{
+				scene.AddShape<Box>(
+					Transform(position, Vector3(0, 0.3f * float(x), 0), Vector3(3.f)),
+					material);
+			}
+			else
+			{
+				scene.AddShape<Sphere>(
+					Transform(position, Vector3(0, 0.5f * float(z), 0), Vector3(2.f)),
+					material);
+			}
+		}
+	}
+}
+
+SyntheticConfiguration::SyntheticConfiguration()
+: spheres(1000)
+, boxes(0)
+, triangles(0)
+, meshInstances(0)
+, meshTriangles(1024)
+, lights(4)
+, distribution(SyntheticDistribution::Uniform)
+, clusters(8)
+, glassFraction(0.f)
+, mirrorFraction(0.f)
+, extent(50.f)
+{
+}
+
+std::size_t SyntheticConfiguration::PrimitiveCount() const
+{
+	return spheres + boxes + triangles + meshInstances * meshTriangles;
+}
+
+SyntheticConfiguration ParseSyntheticConfiguration(std::string const &description)
+{
+	SyntheticConfiguration config;
+
+	std::size_t start = 0;
+	while(start < description.size())
+	{
+		std::size_t end = description.find(',', start);
+		if(end == std::string::npos)
+			end = description.size();
+
+		std::string const pair = description.substr(start, end - start);
+		start = end + 1;
+
+		std::size_t const equals = pair.find('=');
+		if(equals == std::string::npos)
+			throw std::invalid_argument("Expected <key>=<value>, got <" + pair + ">");
+
+		std::string const key = pair.substr(0, equals);
+		std::string const value = pair.substr(equals + 1);
+
+		auto const count = [&value]()
+		{
+			return std::size_t(std::stoull(value));
+		};
+
+		auto const fraction = [&value, &pair]()
+		{
+			float const parsed = std::stof(value);
+			if(parsed < 0.f || parsed > 1.f)
+				throw std::invalid_argument("Fractions are from 0 to 1, got <" + pair + ">");
+
+			return parsed;
+		};
+
+		if(key == "spheres")
+			config.spheres = count();
+		else if(key == "boxes")
+			config.boxes = count();
+		else if(key == "triangles")
+			config.triangles = count();
+		else if(key == "meshInstances")
+			config.meshInstances = count();
+		else if(key == "meshTriangles")
+			config.meshTriangles = count();
+		else if(key == "lights")
+			config.lights = count();
+		else if(key == "clusters")
+			config.clusters = std::max(count(), std::size_t(1));
+		else if(key == "glass")
+			config.glassFraction = fraction();
+		else if(key == "mirror")
+			config.mirrorFraction = fraction();
+		else if(key == "extent")
+		{
+			config.extent = std::stof(value);
+			if(!(config.extent > 0.f))
+				throw std::invalid_argument("The extent has to be positive");
+		}
+		else if(key == "distribution")
+		{
+			if(value == "uniform")
+				config.distribution = SyntheticDistribution::Uniform;
+			else if(value == "clustered")
+				config.distribution = SyntheticDistribution::Clustered;
+			else if(value == "sphereflake")
+				config.distribution = SyntheticDistribution::Sphereflake;
+			else
+			{
+				throw std::invalid_argument(
+					"Unknown distribution <" + value + ">, expected uniform, "
+					"clustered, or sphereflake");
+			}
+		}
+		else
+			throw std::invalid_argument("Unknown synthetic scene key <" + key + ">");
+	}
+
+	if(config.glassFraction + config.mirrorFraction > 1.f)
+		throw std::invalid_argument("More glass and mirrors than primitives");
+
+	return config;
+}
+
+// The start of the random sequence of one kind of primitive.
+static std::uint64_t RandomStream(std::uint64_t seed, std::uint64_t stream)
+{
+	return seed + stream * 0x632be59bd9b4e019ull;
+}
+
+// Roughly normal, from -3 to 3.
+static float RandomNormal(std::uint64_t &state)
+{
+	return RandomRange(state, -1.f, 1.f)
+		+ RandomRange(state, -1.f, 1.f)
+		+ RandomRange(state, -1.f, 1.f);
+}
+
+static Vector3 RandomRotation(std::uint64_t &state)
+{
+	return Vector3(
+		RandomRange(state, 0.f, 2.f * Math::PI),
+		RandomRange(state, 0.f, 2.f * Math::PI),
+		RandomRange(state, 0.f, 2.f * Math::PI));
+}
+
+// Places the primitives of one kind.
+class SyntheticPlacement final
+{
+public:
+	SyntheticPlacement(
+		SyntheticConfiguration const &config,
+		std::uint64_t seed,
+		std::uint64_t stream,
+		std::size_t count)
+	: random(RandomStream(seed, stream))
+	, extent(config.extent)
+	, clusterSpread(config.extent * 0.1f)
+	, clusterCenters()
+	, spacing(2.f * config.extent / std::cbrt(float(std::max(count, std::size_t(1)))))
+	{
+		if(config.distribution != SyntheticDistribution::Clustered)
+			return;
+
+		// Shared by every kind, so they cluster together.
+		std::uint64_t clusterRandom = RandomStream(seed, 0);
+		for(std::size_t i = 0; i < config.clusters; ++i)
+			clusterCenters.push_back(Uniform(clusterRandom));
+
+		// The same count in clusters about 4 spreads across.
+		spacing = 4.f * clusterSpread * std::cbrt(float(config.clusters))
+			/ std::cbrt(float(std::max(count, std::size_t(1))));
+	}
+
+	Vector3 Next()
+	{
+		if(clusterCenters.empty())
+			return Uniform(random);
+
+		std::size_t const cluster =
+			std::size_t(NextRandom(random) * float(clusterCenters.size()));
+
+		return clusterCenters[cluster] + Vector3(
+			RandomNormal(random),
+			RandomNormal(random),
+			RandomNormal(random)) * clusterSpread;
+	}
+
+	// The average distance between primitives, which sizes them.
+	float Spacing() const
+	{
+		return spacing;
+	}
+
+	std::uint64_t &Random()
+	{
+		return random;
+	}
+
+private:
+	Vector3 Uniform(std::uint64_t &state) const
+	{
+		return Vector3(
+			RandomRange(state, -extent, extent),
+			RandomRange(state, -extent, extent),
+			RandomRange(state, -extent, extent));
+	}
+
+	std::uint64_t random;
+	float extent;
+	float clusterSpread;
+	std::vector<Vector3> clusterCenters;
+	float spacing;
+};
+
+// Picks the material of a primitive by the glass and mirror fractions.
+class SyntheticMaterials final
+{
+public:
+	SyntheticMaterials(Scene &scene, SyntheticConfiguration const &config)
+	: plastics()
+	, glass(0)
+	, mirror(0)
+	, glassFraction(config.glassFraction)
+	, mirrorFraction(config.mirrorFraction)
+	{
+		Shader const &blinnPhong = scene.AddShader(
+			"Blinn-Phong",
+			std::make_unique<BlinnPhongShader>());
+
+		std::uint64_t random = RandomStream(scene.Seed(), 1);
+		for(std::size_t i = 0; i < 8; ++i)
+		{
+			Color const color(
+				RandomRange(random, 0.2f, 1.f),
+				RandomRange(random, 0.2f, 1.f),
+				RandomRange(random, 0.2f, 1.f));
+
+			plastics.push_back(scene.AddMaterial(
+				"Plastic " + std::to_string(i),
+				Plastic(blinnPhong, SolidColor(color))));
+		}
+
+		Material glassMaterial = Plastic(
+			blinnPhong,
+			SolidColor(Color(0.9f, 0.95f, 1.f)),
+			shiny);
+		glassMaterial.RefractiveIndexInside(glassIndex);
+
+		glass = scene.AddMaterial("Glass", std::move(glassMaterial));
+
+		mirror = scene.AddMaterial(
+			"Mirror",
+			Plastic(blinnPhong, SolidColor(Color(0.8f, 0.8f, 0.8f)), shiny, 0.9f));
+
+		MaterialStore::IndexType const ground = scene.AddMaterial(
+			"Ground",
+			Plastic(blinnPhong, SolidColor(Color(0.5f, 0.5f, 0.5f))));
+
+		scene.AddShape<Plane>(Transform(Vector3(0, -config.extent, 0)), ground);
+	}
+
+	MaterialStore::IndexType Pick(std::uint64_t &random) const
+	{
+		float const choice = NextRandom(random);
+
+		if(choice < glassFraction)
+			return glass;
+		if(choice < glassFraction + mirrorFraction)
+			return mirror;
+
+		return RandomPlastic(random);
+	}
+
+	MaterialStore::IndexType RandomPlastic(std::uint64_t &random) const
+	{
+		return plastics[std::size_t(NextRandom(random) * float(plastics.size()))];
+	}
+
+private:
+	std::vector<MaterialStore::IndexType> plastics;
+	MaterialStore::IndexType glass;
+	MaterialStore::IndexType mirror;
+	float glassFraction;
+	float mirrorFraction;
+};
+
+static void AddSphereflake(
+	Scene &scene,
+	SyntheticMaterials const &materials,
+	std::uint64_t &random,
+	Vector3 const &position,
+	Vector3 const &axis,
+	float radius,
+	std::size_t depth)
+{
+	scene.AddShape<Sphere>(
+		Transform(position, Vector3(0), Vector3(radius)),
+		materials.Pick(random));
+
+	if(depth == 0)
+		return;
+
+	// Any two directions perpendicular to the axis and each other.
+	Vector3 const helper =
+		std::abs(axis.y) < 0.9f ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
+	Vector3 const u = glm::normalize(glm::cross(axis, helper));
+	Vector3 const v = glm::cross(axis, u);
+
+	float const childRadius = radius / 3.f;
+
+	// Six around the equator, and three above them, touching the parent.
+	for(std::size_t i = 0; i < 9; ++i)
+	{
+		bool const equator = i < 6;
+
+		float const azimuth = equator
+			? float(i) * Math::PI / 3.f
+			: Math::PI / 6.f + float(i - 6) * Math::PI * 2.f / 3.f;
+		float const elevation = equator ? 0.f : Math::PI / 3.f;
+
+		Vector3 const direction =
+			(u * std::cos(azimuth) + v * std::sin(azimuth)) * std::cos(elevation)
+			+ axis * std::sin(elevation);
+
+		AddSphereflake(
+			scene,
+			materials,
+			random,
+			position + direction * (radius + childRadius),
+			direction,
+			childRadius,
+			depth - 1);
+	}
+}
+
+// The deepest complete sphereflake of at most count spheres.
+static std::size_t SphereflakeDepth(std::size_t count)
+{
+	std::size_t depth = 0;
+	std::size_t total = 1;
+	std::size_t level = 1;
+
+	while(total + level * 9 <= count)
+	{
+		level *= 9;
+		total += level;
+		++depth;
+	}
+
+	return depth;
+}
+
+// A torus of about triangleCount triangles, one unit across, with the tube a
+// quarter of the ring.
+static std::vector<ModelTriangle::Vertex> Torus(std::size_t triangleCount)
+{
+	std::size_t const tube = std::max(
+		std::size_t(std::sqrt(float(triangleCount) / 8.f)),
+		std::size_t(3));
+	std::size_t const ring = std::max(triangleCount / (2 * tube), std::size_t(3));
+
+	constexpr float const ringRadius = 0.4f;
+	constexpr float const tubeRadius = 0.1f;
+
+	auto const vertex = [&](std::size_t i, std::size_t j)
+	{
+		float const u = float(i) / float(ring);
+		float const v = float(j) / float(tube);
+
+		float const ringAngle = u * 2.f * Math::PI;
+		float const tubeAngle = v * 2.f * Math::PI;
+
+		Vector3 const center(
+			std::cos(ringAngle) * ringRadius,
+			0.f,
+			std::sin(ringAngle) * ringRadius);
+
+		Vector3 const normal(
+			std::cos(ringAngle) * std::cos(tubeAngle),
+			std::sin(tubeAngle),
+			std::sin(ringAngle) * std::cos(tubeAngle));
+
+		return ModelTriangle::Vertex{center + normal * tubeRadius, normal, Vector2(u, v)};
+	};
+
+	std::vector<ModelTriangle::Vertex> vertices;
+	vertices.reserve(ring * tube * 6);
+
+	for(std::size_t i = 0; i < ring; ++i)
+	{
+		for(std::size_t j = 0; j < tube; ++j)
+		{
+			ModelTriangle::Vertex const a = vertex(i, j);
+			ModelTriangle::Vertex const b = vertex(i + 1, j);
+			ModelTriangle::Vertex const c = vertex(i + 1, j + 1);
+			ModelTriangle::Vertex const d = vertex(i, j + 1);
+
+			vertices.insert(vertices.end(), {a, c, b, a, d, c});
+		}
+	}
+
+	return vertices;
+}
+
+static void AddSyntheticTriangles(
+	Scene &scene,
+	SyntheticConfiguration const &config,
+	SyntheticMaterials const &materials)
+{
+	SyntheticPlacement placement(config, scene.Seed(), 4, config.triangles);
+	std::uint64_t &random = placement.Random();
+
+	std::vector<ModelTriangle::Vertex> vertices;
+	vertices.reserve(config.triangles * 3);
+
+	for(std::size_t i = 0; i < config.triangles; ++i)
+	{
+		Vector3 const center = placement.Next();
+		float const size = placement.Spacing() * 0.5f;
+
+		std::array<Vector3, 3> const positions =
+		{
+			center + Vector3(
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size)),
+			center + Vector3(
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size)),
+			center + Vector3(
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size),
+				RandomRange(random, -size, size))
+		};
+
+		Vector3 normal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+		normal = glm::dot(normal, normal) > 0.f ? glm::normalize(normal) : Vector3(0, 1, 0);
+
+		vertices.push_back({positions[0], normal, Vector2(0, 0)});
+		vertices.push_back({positions[1], normal, Vector2(1, 0)});
+		vertices.push_back({positions[2], normal, Vector2(0, 1)});
+	}
+
+	Model const &soup = scene.AddMesh(std::move(vertices));
+	scene.AddModelInstance(soup, Transform(Vector3(0)), materials.RandomPlastic(random));
+}
+
+static void AddSyntheticInstances(
+	Scene &scene,
+	SyntheticConfiguration const &config,
+	SyntheticMaterials const &materials)
+{
+	SyntheticPlacement placement(config, scene.Seed(), 5, config.meshInstances);
+	std::uint64_t &random = placement.Random();
+
+	Model const &torus = scene.AddMesh(Torus(config.meshTriangles));
+
+	for(std::size_t i = 0; i < config.meshInstances; ++i)
+	{
+		Vector3 const position = placement.Next();
+		float const size = placement.Spacing() * RandomRange(random, 0.6f, 1.f);
+
+		scene.AddModelInstance(
+			torus,
+			Transform(position, RandomRotation(random), Vector3(size)),
+			materials.Pick(random));
+	}
+}
+
+static void LoadSynthetic(Scene &scene, SyntheticConfiguration const &config)
+{
+	SyntheticMaterials const materials(scene, config);
+
+	if(config.distribution == SyntheticDistribution::Sphereflake)
+	{
+		if(config.spheres > 0)
+		{
+			std::uint64_t random = RandomStream(scene.Seed(), 2);
+
+			AddSphereflake(
+				scene,
+				materials,
+				random,
+				Vector3(0),
+				Vector3(0, 1, 0),
+				config.extent * 0.5f,
+				SphereflakeDepth(config.spheres));
+		}
+	}
+	else
+	{
+		SyntheticPlacement placement(config, scene.Seed(), 2, config.spheres);
+		std::uint64_t &random = placement.Random();
+
+		for(std::size_t i = 0; i < config.spheres; ++i)
+		{
+			Vector3 const position = placement.Next();
+			float const radius = placement.Spacing() * RandomRange(random, 0.1f, 0.3f);
+
+			scene.AddShape<Sphere>(
+				Transform(position, Vector3(0), Vector3(radius)),
+				materials.Pick(random));
+		}
+	}
+
+	// Only the spheres make up the sphereflake.
+	SyntheticConfiguration others = config;
+	if(others.distribution == SyntheticDistribution::Sphereflake)
+		others.distribution = SyntheticDistribution::Uniform;
+
+	SyntheticPlacement boxPlacement(others, scene.Seed(), 3, config.boxes);
+	std::uint64_t &boxRandom = boxPlacement.Random();
+
+	for(std::size_t i = 0; i < config.boxes; ++i)
+	{
+		Vector3 const position = boxPlacement.Next();
+		float const size = boxPlacement.Spacing() * 0.5f;
+
+		scene.AddShape<Box>(
+			Transform(
+				position,
+				RandomRotation(boxRandom),
+				Vector3(
+					size * RandomRange(boxRandom, 0.3f, 1.f),
+					size * RandomRange(boxRandom, 0.3f, 1.f),
+					size * RandomRange(boxRandom, 0.3f, 1.f))),
+			materials.Pick(boxRandom));
+	}
+
+	if(config.triangles > 0)
+		AddSyntheticTriangles(scene, others, materials);
+
+	if(config.meshInstances > 0)
+		AddSyntheticInstances(scene, others, materials);
+
+	SyntheticPlacement lightPlacement(others, scene.Seed(), 6, config.lights);
+	std::uint64_t &lightRandom = lightPlacement.Random();
+
+	// Dimmer the more there are, so the scene is about as bright with any
+	// count, at full strength as far as the next light.
+	float const intensity = lightPlacement.Spacing() * lightPlacement.Spacing();
+
+	for(std::size_t i = 0; i < config.lights; ++i)
+	{
+		Color const color(
+			RandomRange(lightRandom, 0.5f, 1.f),
+			RandomRange(lightRandom, 0.5f, 1.f),
+			RandomRange(lightRandom, 0.5f, 1.f));
+
+		scene.AddLight(Light(lightPlacement.Next(), color, intensity));
+	}
+}
+
+std::vector<StandardScene> BenchmarkScenes()
+{
+	Vector3 const lookingDown(-Math::PI * 0.1f, 0, 0);
+
+	return
+	{
+		{"spheres", Transform(Vector3(0, 12, 14), lookingDown), Spheres},
+		{"mesh", Transform(Vector3(0, 9, 10), lookingDown), Mesh},
+		{"glass", Transform(Vector3(0, 6, 10), lookingDown), Glass},
+		{"lights", Transform(Vector3(0, 12, 14), lookingDown), Lights},
+		{"textures", Transform(Vector3(0, 8, 12), lookingDown), Textures}
+	};
+}
+
+std::vector<StandardScene> PickScenes(
+	std::vector<StandardScene> const &scenes,
+	std::vector<std::string> const &names)
+{
+	std::vector<StandardScene> picked;
+	picked.reserve(names.size());
+
+	for(std::string const &name: names)
+	{
+		auto const it = std::find_if(
+			scenes.begin(),
+			scenes.end(),
+			[&name](StandardScene const &scene)
+			{
+				return scene.name == name;
+			});
+
+		if(it == scenes.end())
+			throw std::invalid_argument("Unknown scene <" + name + ">");
+
+		picked.push_back(*it);
+	}
+
+	return picked;
+}
+
+StandardScene Synthetic(SyntheticConfiguration const &config)
+{
+	float const extent = config.extent;
+
+	return
+	{
+		"synthetic",
+		Transform(
+			Vector3(0, extent * 0.6f, extent * 2.2f),
+			Vector3(-Math::PI * 0.1f, 0, 0)),
+		[config](Scene &scene)
+		{
+			LoadSynthetic(scene, config);
+		}
+	};
+}
+} // namespace LibRay::Scenes
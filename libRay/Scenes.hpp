@@ -0,0 +1,136 @@
+#ifndef f1c4b594_d522_41a5_8b7a_7a40bcc6f07d
+#define f1c4b594_d522_41a5_8b7a_7a40bcc6f07d
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "API.hpp"
+#include "Scene.hpp"
+#include "Transform.hpp"
+
+namespace LibRay::Scenes
+{
+// SceneLoaders for Scene, reading their assets from Resources/ relative to
+// the working directory. Whatever they place at random is placed the same
+// for the same Scene::Seed, on every platform.
+
+// The nanosuit on a grass plane, inside an environment map.
+LIBRAY_API void Nanosuit(Scene &scene);
+
+// Four thousand spheres of random sizes and colors, for traversing the scene
+// BVH over analytic shapes.
+LIBRAY_API void Spheres(Scene &scene);
+
+// Four nanosuits, 76 thousand triangles, for the model BVHs and the triangle
+// test.
+LIBRAY_API void Mesh(Scene &scene);
+
+// Glass spheres and boxes in front of mirrors, where most rays are
+// refractions and reflections.
+LIBRAY_API void Glass(Scene &scene);
+
+// 256 small lights over a field of boxes, for light culling and shadow rays.
+LIBRAY_API void Lights(Scene &scene);
+
+// Shapes with large, bump mapped textures in every wrapping mode, for
+// texture sampling.
+LIBRAY_API void Textures(Scene &scene);
+
+enum class SyntheticDistribution
+{
+	// Anywhere in the cube.
+	Uniform,
+
+	// Around a few random points, for BVHs over very uneven densities.
+	Clustered,
+
+	// The spheres are a sphereflake, each sphere carrying 9 a third its size,
+	// nested as deep as the sphere count allows. Everything else is uniform.
+	Sphereflake
+};
+
+// What Synthetic generates. Everything is placed at random, seeded by
+// Scene::Seed, in a cube of 2 * extent around the origin, over a ground plane.
+// Every kind of primitive has a random sequence of its own, so changing the
+// count of one doesn't move the others.
+struct LIBRAY_API SyntheticConfiguration final
+{
+	SyntheticConfiguration();
+
+	// Spheres, boxes, and instances are a shape each, with a transform of
+	// their own, a few hundred bytes apiece. Instancing is how to reach
+	// hundreds of millions of triangles in memory.
+	std::size_t spheres;
+	std::size_t boxes;
+
+	// Triangles of random orientation and size, in a single model.
+	std::size_t triangles;
+
+	// Copies of a single torus of meshTriangles triangles, sharing its BVH.
+	std::size_t meshInstances;
+	std::size_t meshTriangles;
+
+	// Point lights of random colors, bright enough to reach a few neighbours.
+	std::size_t lights;
+
+	SyntheticDistribution distribution;
+	std::size_t clusters;
+
+	// Of the spheres, boxes, and instances, the rest are plastic of random
+	// colors. The triangles are all plastic.
+	float glassFraction;
+	float mirrorFraction;
+
+	float extent;
+
+	// Spheres, boxes, triangles, and the triangles of every instance.
+	std::size_t PrimitiveCount() const;
+};
+
+static_assert(std::is_copy_constructible_v<SyntheticConfiguration>);
+static_assert(std::is_copy_assignable_v<SyntheticConfiguration>);
+static_assert(std::is_trivially_copyable_v<SyntheticConfiguration>);
+
+static_assert(std::is_move_constructible_v<SyntheticConfiguration>);
+static_assert(std::is_move_assignable_v<SyntheticConfiguration>);
+
+// Reads a comma separated list of key=value pairs, like
+// "spheres=100000,lights=64,distribution=clustered,glass=0.2", over the
+// defaults. The keys are the members of SyntheticConfiguration, with glass
+// and mirror for the fractions. Throws std::invalid_argument on unknown keys
+// and bad values.
+LIBRAY_API SyntheticConfiguration ParseSyntheticConfiguration(
+	std::string const &description);
+
+struct LIBRAY_API StandardScene final
+{
+	std::string name;
+	Transform camera;
+	SceneLoader load;
+};
+
+static_assert(std::is_copy_constructible_v<StandardScene>);
+static_assert(std::is_copy_assignable_v<StandardScene>);
+static_assert(!std::is_trivially_copyable_v<StandardScene>);
+
+static_assert(std::is_move_constructible_v<StandardScene>);
+static_assert(std::is_move_assignable_v<StandardScene>);
+
+// The scenes benchmarks render, in a fixed order, with a camera looking at
+// each.
+LIBRAY_API std::vector<StandardScene> BenchmarkScenes();
+
+// The scenes called names, in the order of names. Throws
+// std::invalid_argument for a name none of scenes has.
+LIBRAY_API std::vector<StandardScene> PickScenes(
+	std::vector<StandardScene> const &scenes,
+	std::vector<std::string> const &names);
+
+// A generated scene, needing nothing from Resources/, named "synthetic", with
+// a camera that sees the whole cube.
+LIBRAY_API StandardScene Synthetic(SyntheticConfiguration const &config);
+} // namespace LibRay::Scenes
+
+#endif // f1c4b594_d522_41a5_8b7a_7a40bcc6f07d
@@ -74,4 +74,18 @@ Color BlinnPhongShader::Run(
 
 	return result;
 }
+
+Color BlinnPhongShader::Albedo(Intersection const &intersection) const
+{
+	Vector2 const &uv = intersection.uv;
+
+	return intersection.shape->Material()
+		.TexturePropertyByName("diffuse")
+		.Sample(uv.x, uv.y);
+}
+
+char const *BlinnPhongShader::Name() const
+{
+	return "BlinnPhong";
+}
 } // namespace LibRay
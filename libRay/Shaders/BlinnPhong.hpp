@@ -33,6 +33,10 @@ public:
 		std::vector<Observer<Light const>> const &lights,
 		Materials::Color const &ambientLight,
 		float ambientIntensity) const override;
+
+	Materials::Color Albedo(Intersection const &intersection) const override;
+
+	char const *Name() const override;
 };
 
 static_assert(std::is_copy_constructible_v<BlinnPhongShader>);
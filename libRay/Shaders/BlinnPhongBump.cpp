@@ -89,4 +89,18 @@ Color BlinnPhongShaderBump::Run(
 
 	return result;
 }
+
+Color BlinnPhongShaderBump::Albedo(Intersection const &intersection) const
+{
+	Vector2 const &uv = intersection.uv;
+
+	return intersection.shape->Material()
+		.TexturePropertyByName("diffuse")
+		.Sample(uv.x, uv.y);
+}
+
+char const *BlinnPhongShaderBump::Name() const
+{
+	return "BlinnPhongBump";
+}
 } // namespace LibRay
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../Math/Vector.hpp"
+#include "../API.hpp"
 #include "../Utilites.hpp"
 #include "Shader.hpp"
 
@@ -23,7 +24,7 @@ class Color;
 class Intersection;
 class Light;
 
-class BlinnPhongShaderBump: public Shader
+class LIBRAY_API BlinnPhongShaderBump: public Shader
 {
 public:
 	Materials::Color Run(
@@ -33,6 +34,10 @@ public:
 		std::vector<Observer<Light const>> const &lights,
 		Materials::Color const &ambientLight,
 		float ambientIntensity) const override;
+
+	Materials::Color Albedo(Intersection const &intersection) const override;
+
+	char const *Name() const override;
 };
 
 static_assert(std::is_copy_constructible_v<BlinnPhongShaderBump>);
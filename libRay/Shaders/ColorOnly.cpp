@@ -19,4 +19,14 @@ Color ColorOnlyShader::Run(
 {
 	return intersection.shape->Material().ColorPropertyByName("Color");
 }
+
+Color ColorOnlyShader::Albedo(Intersection const &intersection) const
+{
+	return intersection.shape->Material().ColorPropertyByName("Color");
+}
+
+char const *ColorOnlyShader::Name() const
+{
+	return "ColorOnly";
+}
 } // namespace LibRay
@@ -23,4 +23,18 @@ Color EnvironmentMappingShader::Run(
 
 	return diffuse.Sample(uv.x, uv.y);
 }
+
+Color EnvironmentMappingShader::Albedo(Intersection const &intersection) const
+{
+	Vector2 const &uv = intersection.uv;
+
+	return intersection.shape->Material()
+		.TexturePropertyByName("diffuse")
+		.Sample(uv.x, uv.y);
+}
+
+char const *EnvironmentMappingShader::Name() const
+{
+	return "EnvironmentMapping";
+}
 } // namespace LibRay
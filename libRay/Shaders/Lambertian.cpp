@@ -53,4 +53,18 @@ Color LambertianShader::Run(
 
 	return result;
 }
+
+Color LambertianShader::Albedo(Intersection const &intersection) const
+{
+	Vector2 const &uv = intersection.uv;
+
+	return intersection.shape->Material()
+		.TexturePropertyByName("diffuse")
+		.Sample(uv.x, uv.y);
+}
+
+char const *LambertianShader::Name() const
+{
+	return "Lambertian";
+}
 } // namespace LibRay
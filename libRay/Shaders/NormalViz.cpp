@@ -26,4 +26,9 @@ Color NormalVizShader::Run(
 
 	return Color(col.x, col.y, col.z);
 }
+
+char const *NormalVizShader::Name() const
+{
+	return "NormalViz";
+}
 } // namespace LibRay
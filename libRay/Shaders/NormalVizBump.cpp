@@ -47,4 +47,9 @@ Color NormalVizShaderBump::Run(
 
 	return Color(col.x, col.y, col.z);
 }
+
+char const *NormalVizShaderBump::Name() const
+{
+	return "NormalVizBump";
+}
 } // namespace LibRay
@@ -33,6 +33,8 @@ public:
 		std::vector<Observer<Light const>> const &lights,
 		Materials::Color const &ambientLight,
 		float ambientIntensity) const override;
+
+	char const *Name() const override;
 };
 
 static_assert(std::is_copy_constructible_v<NormalVizShaderBump>);
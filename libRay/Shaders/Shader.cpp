@@ -1,6 +1,13 @@
 #include "Shader.hpp"
 
+#include "../Material/Color.hpp"
+
 namespace LibRay
 {
 Shader::~Shader() noexcept = default;
+
+Materials::Color Shader::Albedo(Intersection const &) const
+{
+	return Materials::Color::White();
+}
 } // namespace LibRay
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../Math/Vector.hpp"
+#include "../API.hpp"
 #include "../Utilites.hpp"
 
 namespace LibRay
@@ -22,7 +23,7 @@ class Color;
 class Intersection;
 class Light;
 
-class Shader
+class LIBRAY_API Shader
 {
 public:
 	virtual ~Shader() noexcept;
@@ -34,6 +35,12 @@ public:
 		std::vector<Observer<Light const>> const &lights,
 		Materials::Color const &ambientLight,
 		float ambientIntensity) const = 0;
+
+	// The surface color without lighting, guides denoising. White by default.
+	virtual Materials::Color Albedo(Intersection const &intersection) const;
+
+	// Identifies the type of shader in statistics.
+	virtual char const *Name() const = 0;
 };
 
 static_assert(!std::is_copy_constructible_v<Shader>);
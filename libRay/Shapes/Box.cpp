@@ -8,6 +8,7 @@
 #include "../Math/Ray.hpp"
 #include "../Math/Vector.hpp"
 #include "../Intersection.hpp"
+#include "../Statistics.hpp"
 #include "../Transform.hpp"
 
 namespace LibRay
@@ -51,6 +52,8 @@ static Vector2 UV(Vector3 const &modelPos, Vector3 const &normal)
 
 std::optional<Intersection> Box::IntersectsInternal(Math::Ray const &ray) const
 {
+	Instrumentation::CountAnalyticTest();
+
 	Matrix4x4 const worldToModel = transform.InverseMatrix();
 	Ray const modelRay(
 		Transform::TransformTranslation(worldToModel, ray.Origin()),
@@ -6,6 +6,7 @@
 #include "../Math/Matrix.hpp"
 #include "../Math/Ray.hpp"
 #include "../Intersection.hpp"
+#include "../Statistics.hpp"
 
 using namespace LibRay::Materials;
 using namespace LibRay::Math;
@@ -14,6 +15,8 @@ namespace LibRay::Shapes
 {
 std::optional<Intersection> Disc::IntersectsInternal(Ray const &ray) const
 {
+	Instrumentation::CountAnalyticTest();
+
 	Matrix4x4 const worldToModel = transform.InverseMatrix();
 
 	Ray const modelRay(
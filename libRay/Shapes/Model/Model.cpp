@@ -1,10 +1,12 @@
 #include "Model.hpp"
 
 #include <array>
+#include <cassert>
 
 #include "../../Math/Matrix.hpp"
 #include "../../Math/Ray.hpp"
 #include "../../Intersection.hpp"
+#include "../../MemoryReport.hpp"
 
 using namespace LibRay::Math;
 
@@ -89,6 +91,34 @@ Containers::BoundingBox Model::CalculateBoundingBoxInternal() const
 		transform.Position() + bvh.RootBoundingBox().Position());
 }
 
+void Model::AddMemory(MemoryReport &report, std::size_t shapeIndex) const
+{
+	MemoryReport::ModelMemory model;
+	model.shapeIndex = shapeIndex;
+	model.triangleCount = triangles.size();
+	model.vertexBytes = triangles.size() * sizeof(std::array<ModelTriangle::Vertex, 3>);
+	model.triangleBytes =
+		triangles.capacity() * sizeof(ModelTriangle) - model.vertexBytes;
+	model.bvh = bvh.Memory();
+
+	report.models.push_back(model);
+}
+
+ModelTriangle const &Model::Triangle(std::size_t index) const
+{
+	assert(index < triangles.size());
+
+	return triangles[index];
+}
+
+std::size_t Model::TriangleIndex(ModelTriangle const &triangle) const
+{
+	assert(&triangle >= triangles.data()
+		&& &triangle < triangles.data() + triangles.size());
+
+	return std::size_t(&triangle - triangles.data());
+}
+
 std::vector<Observer<BaseShape<ModelTriangle> const>>
 Model::Load(std::vector<ModelTriangle::Vertex> vertices)
 {
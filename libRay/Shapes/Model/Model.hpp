@@ -43,6 +43,13 @@ public:
 
 	Containers::BoundingBox CalculateBoundingBoxInternal() const override;
 
+	void AddMemory(MemoryReport &report, std::size_t shapeIndex) const override;
+
+	// Triangles are numbered in the order of the vertices they were loaded
+	// from, so an index stays valid as long as the model.
+	ModelTriangle const &Triangle(std::size_t index) const;
+	std::size_t TriangleIndex(ModelTriangle const &triangle) const;
+
 private:
 	std::vector<Observer<BaseShape<ModelTriangle> const>> Load(
 		std::vector<ModelTriangle::Vertex> vertices);
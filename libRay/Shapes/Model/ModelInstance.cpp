@@ -0,0 +1,76 @@
+#include "ModelInstance.hpp"
+
+#include <limits>
+
+#include "../../Containers/BoundingBox.hpp"
+#include "../../Math/Matrix.hpp"
+#include "../../Math/Ray.hpp"
+#include "../../Intersection.hpp"
+#include "Model.hpp"
+
+using namespace LibRay::Math;
+
+namespace LibRay::Shapes
+{
+ModelInstance::ModelInstance(
+	Observer<Model const> model,
+	class Transform const &transform,
+	Materials::MaterialStore const &materialStore,
+	Materials::MaterialStore::IndexType materialIndex)
+: Shape(transform, materialStore, materialIndex)
+, model(model)
+{
+}
+
+std::optional<Intersection> ModelInstance::IntersectsInternal(Ray const &ray) const
+{
+	Matrix4x4 const &worldToInstance = transform.InverseMatrix();
+
+	Ray const instanceRay(
+		Transform::TransformTranslation(worldToInstance, ray.Origin()),
+		Transform::TransformDirection(worldToInstance, ray.Direction()));
+
+	// In the space of the instance, the model itself isn't transformed.
+	std::optional<Intersection> const hit = model->Intersects(instanceRay);
+	if(!hit)
+		return std::nullopt;
+
+	Matrix4x4 const &matrix = transform.Matrix();
+
+	return Intersection(
+		*this,
+		Transform::TransformDirection(matrix, hit->surfaceNormal),
+		Transform::TransformDirection(matrix, hit->surfaceTangent),
+		Transform::TransformTranslation(matrix, hit->worldPosition),
+		hit->uv);
+}
+
+Containers::BoundingBox ModelInstance::CalculateBoundingBoxInternal() const
+{
+	Containers::BoundingBox const modelBox = model->CalculateBoundingBox();
+
+	Vector3 const &half = modelBox.HalfBoundaries();
+	Vector3 const &center = modelBox.Position();
+
+	Matrix4x4 const &matrix = transform.Matrix();
+
+	Vector3 min(std::numeric_limits<float>::max());
+	Vector3 max(std::numeric_limits<float>::lowest());
+
+	for(std::size_t corner = 0; corner < 8; ++corner)
+	{
+		Vector3 const offset(
+			corner & 1 ? half.x : -half.x,
+			corner & 2 ? half.y : -half.y,
+			corner & 4 ? half.z : -half.z);
+
+		Vector3 const world =
+			Transform::TransformTranslation(matrix, center + offset);
+
+		min = glm::min(min, world);
+		max = glm::max(max, world);
+	}
+
+	return Containers::BoundingBox((max - min) * 0.5f, (min + max) * 0.5f);
+}
+} // namespace LibRay::Shapes
@@ -0,0 +1,64 @@
+#ifndef e3378d2d_a3fb_4acc_8aa0_dc0d496de06f
+#define e3378d2d_a3fb_4acc_8aa0_dc0d496de06f
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+#include "../../Material/MaterialStore.hpp"
+#include "../../API.hpp"
+#include "../../Transform.hpp"
+#include "../../Utilites.hpp"
+#include "../Shape.hpp"
+
+namespace LibRay
+{
+namespace Containers
+{
+class BoundingBox;
+} // namespace Containers
+
+namespace Math
+{
+class Ray;
+} // namespace Math
+
+class Intersection;
+
+namespace Shapes
+{
+class Model;
+
+// Another copy of a model, sharing its triangles and BVH, with a transform
+// and material of its own. The model has to outlive the instance and not
+// move, see Scene::AddMesh.
+class LIBRAY_API ModelInstance final: public Shape
+{
+public:
+	ModelInstance(
+		Observer<Model const> model,
+		class Transform const &transform,
+		Materials::MaterialStore const &materialStore,
+		Materials::MaterialStore::IndexType materialIndex);
+
+	// Hits are of the instance, without the triangle, which can't be tested
+	// on its own in the space of the instance.
+	std::optional<Intersection> IntersectsInternal(
+		Math::Ray const &ray) const override;
+
+	Containers::BoundingBox CalculateBoundingBoxInternal() const override;
+
+private:
+	Observer<Model const> model;
+};
+
+static_assert(std::is_copy_constructible_v<ModelInstance>);
+static_assert(!std::is_copy_assignable_v<ModelInstance>);
+static_assert(!std::is_trivially_copyable_v<ModelInstance>);
+
+static_assert(std::is_move_constructible_v<ModelInstance>);
+static_assert(!std::is_move_assignable_v<ModelInstance>);
+} // namespace Shapes
+} // namespace LibRay
+
+#endif // e3378d2d_a3fb_4acc_8aa0_dc0d496de06f
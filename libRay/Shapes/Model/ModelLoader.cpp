@@ -8,6 +8,7 @@
 #include <tinyobjloader/tiny_obj_loader.hpp>
 
 #include "../../Math/Vector.hpp"
+#include "../../Timeline.hpp"
 
 using namespace LibRay::Materials;
 using namespace LibRay::Math;
@@ -32,14 +33,19 @@ std::vector<std::unique_ptr<Model>> ModelLoader::LoadObj(
 
 	std::string warnings, errors;
 
-	bool const result = tinyobj::LoadObj(
-		&attributes,
-		&shapes,
-		&materials,
-		&warnings,
-		&errors,
-		fileName.c_str(),
-		materialDir.c_str());
+	bool result;
+	{
+		Timeline::Span const span("Parse OBJ", fileName);
+
+		result = tinyobj::LoadObj(
+			&attributes,
+			&shapes,
+			&materials,
+			&warnings,
+			&errors,
+			fileName.c_str(),
+			materialDir.c_str());
+	}
 
 	if(!result)
 	{
@@ -7,6 +7,7 @@
 #include "../../Math/Ray.hpp"
 #include "../../Math/Vector.hpp"
 #include "../../Intersection.hpp"
+#include "../../Statistics.hpp"
 #include "Model.hpp"
 
 using namespace LibRay::Math;
@@ -37,6 +38,8 @@ ModelTriangle::ModelTriangle(
 std::optional<Intersection> ModelTriangle::IntersectsInternal(
 	Ray const &modelRay) const
 {
+	Instrumentation::CountTriangleTest();
+
 	// Compute plane normal
 	Vector3 const v1v0 = vertices[1].position - vertices[0].position;
 	Vector3 const v2v0 = vertices[2].position - vertices[0].position;
@@ -70,17 +73,33 @@ std::optional<Intersection> ModelTriangle::IntersectsInternal(
 
 		Matrix4x4 const &matrix = parent->Transform().Matrix();
 
-		return Intersection(
+		Intersection intersection(
 			*parent,
 			Transform::TransformDirection(matrix, normal),
 			Transform::TransformDirection(matrix, tangent),
 			Transform::TransformTranslation(matrix, pos),
 			uv);
+
+		intersection.triangle = this;
+
+		return intersection;
 	}
 
 	return std::nullopt;
 }
 
+std::optional<Intersection> ModelTriangle::IntersectsWorld(
+	Ray const &worldRay) const
+{
+	Matrix4x4 const &worldToModel = parent->Transform().InverseMatrix();
+
+	Ray const modelRay(
+		Transform::TransformTranslation(worldToModel, worldRay.Origin()),
+		Transform::TransformDirection(worldToModel, worldRay.Direction()));
+
+	return IntersectsInternal(modelRay);
+}
+
 Containers::BoundingBox ModelTriangle::CalculateBoundingBoxInternal() const
 {
 	Vector3 const min = glm::min(
@@ -29,7 +29,7 @@ namespace Shapes
 {
 class Model;
 
-class ModelTriangle final: public BaseShape<ModelTriangle>
+class LIBRAY_API ModelTriangle final: public BaseShape<ModelTriangle>
 {
 public:
 	struct Vertex
@@ -52,6 +52,10 @@ public:
 
 	std::optional<Intersection> IntersectsInternal(Math::Ray const &ray) const;
 
+	// Intersects a ray in world space instead of the space of the model, to
+	// test a single triangle without going through the model.
+	std::optional<Intersection> IntersectsWorld(Math::Ray const &worldRay) const;
+
 	Containers::BoundingBox CalculateBoundingBoxInternal() const;
 
 private:
@@ -7,6 +7,7 @@
 #include "../Math/Ray.hpp"
 #include "../Math/Vector.hpp"
 #include "../Intersection.hpp"
+#include "../Statistics.hpp"
 #include "../Transform.hpp"
 
 using namespace LibRay::Math;
@@ -20,6 +21,8 @@ bool Plane::IsBoundableInternal() const
 
 std::optional<Intersection> Plane::IntersectsInternal(Ray const &ray) const
 {
+	Instrumentation::CountAnalyticTest();
+
 	Matrix4x4 const worldToModel = transform.InverseMatrix();
 	Ray const modelRay(
 		Transform::TransformTranslation(worldToModel, ray.Origin()),
@@ -23,6 +23,11 @@ class Material const &Shape::Material() const
 	return materialStore.MaterialByIndex(materialIndex);
 }
 
+MaterialStore::IndexType Shape::MaterialIndex() const
+{
+	return materialIndex;
+}
+
 Transform const &Shape::Transform() const
 {
 	return transform;
@@ -42,4 +47,8 @@ bool Shape::IsBoundableInternal() const
 {
 	return true;
 }
+
+void Shape::AddMemory(MemoryReport &, std::size_t) const
+{
+}
 } // namespace LibRay::Shapes
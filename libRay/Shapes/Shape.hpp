@@ -1,6 +1,7 @@
 #ifndef f4ffcf96_123c_4559_9031_f794398a0fe5
 #define f4ffcf96_123c_4559_9031_f794398a0fe5
 
+#include <cstddef>
 #include <optional>
 #include <type_traits>
 
@@ -18,6 +19,8 @@ namespace Math
 class Ray;
 } // namespace Math
 
+struct MemoryReport;
+
 namespace Shapes
 {
 template<typename T>
@@ -58,6 +61,7 @@ public:
 	virtual ~Shape() noexcept;
 
 	Materials::Material const &Material() const;
+	Materials::MaterialStore::IndexType MaterialIndex() const;
 
 	class Transform const &Transform() const;
 	class Transform &Transform();
@@ -69,6 +73,10 @@ public:
 
 	virtual Containers::BoundingBox CalculateBoundingBoxInternal() const = 0;
 
+	// Adds what the shape allocated besides itself to report, shapeIndex is
+	// its index in the scene. Nothing by default.
+	virtual void AddMemory(MemoryReport &report, std::size_t shapeIndex) const;
+
 private:
 	Math::Vector3 const PositionInternal() const;
 	friend class BaseShape<Shape>;
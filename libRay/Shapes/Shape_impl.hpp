@@ -28,7 +28,7 @@ BaseShape<T>::~BaseShape() noexcept = default;
 template<typename T>
 bool BaseShape<T>::IsBoundable() const
 {
-	return true;
+	return Derived().IsBoundableInternal();
 }
 
 template<typename T>
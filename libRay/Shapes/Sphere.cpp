@@ -11,6 +11,7 @@
 #include "../Math/Ray.hpp"
 #include "../Math/Vector.hpp"
 #include "../Intersection.hpp"
+#include "../Statistics.hpp"
 
 using namespace LibRay::Materials;
 using namespace LibRay::Math;
@@ -30,6 +31,8 @@ static Vector2 UV(Math::Vector3 const &normal)
 
 std::optional<Intersection> Sphere::IntersectsInternal(Ray const &ray) const
 {
+	Instrumentation::CountAnalyticTest();
+
 	// Implicit sphere surface = (point - center)² - radius² = 0
 	// Need to find point
 	// point is defined as: ray.Origin() + t * ray.Direction()
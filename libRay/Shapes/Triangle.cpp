@@ -7,6 +7,7 @@
 #include "../Math/Ray.hpp"
 #include "../Math/Vector.hpp"
 #include "../Intersection.hpp"
+#include "../Statistics.hpp"
 #include "../Transform.hpp"
 
 using namespace LibRay::Math;
@@ -15,6 +16,8 @@ namespace LibRay::Shapes
 {
 std::optional<Intersection> Triangle::IntersectsInternal(Ray const &ray) const
 {
+	Instrumentation::CountTriangleTest();
+
 	// o + t * d = v0 + beta * (v1-v0) + gamma * (v2-v0)
 	// -t * d +  beta * (v1-v0) + gamma * (v2-v0) = o - v0
 	// M * (-t, beta, gamma) = o - v0
@@ -0,0 +1,258 @@
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Shaders/Shader.hpp"
+
+namespace LibRay
+{
+static std::string Format(char const *format, double value)
+{
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), format, value);
+
+	return buffer;
+}
+
+// JSON has no way to write NaN or infinity, rates over no time are 0.
+static double Rate(std::uint64_t count, double seconds)
+{
+	return seconds > 0. ? double(count) / seconds : 0.;
+}
+
+static std::string HardwareJSON(HardwareCounts const &counts)
+{
+	return "{\"cycles\": " + std::to_string(counts.cycles)
+		+ ", \"instructions\": " + std::to_string(counts.instructions)
+		+ ", \"cacheReferences\": " + std::to_string(counts.cacheReferences)
+		+ ", \"cacheMisses\": " + std::to_string(counts.cacheMisses)
+		+ ", \"branches\": " + std::to_string(counts.branches)
+		+ ", \"branchMisses\": " + std::to_string(counts.branchMisses)
+		+ ", \"instructionsPerCycle\": " + Format("%.4g", counts.InstructionsPerCycle())
+		+ "}";
+}
+
+static std::string HardwareReport(RenderStatistics const &statistics)
+{
+	if(statistics.hardwarePerPass.empty())
+	{
+		return statistics.hardwareCountersError.empty()
+			? std::string()
+			: "Hardware counters unavailable: "
+				+ statistics.hardwareCountersError + "\n";
+	}
+
+	HardwareCounts const &counts = statistics.hardware;
+
+	std::string report =
+		"Hardware counters over " + std::to_string(statistics.hardwarePerPass.size())
+		+ " passes\n"
+		+ Format("  cycles                  %14.0f\n", double(counts.cycles))
+		+ Format("  instructions            %14.0f", double(counts.instructions))
+		+ Format("%10.2f IPC\n", counts.InstructionsPerCycle())
+		+ Format("  cache misses            %14.0f", double(counts.cacheMisses))
+		+ Format("%10.2f%% of references\n", 100. * counts.CacheMissRate())
+		+ Format("  branch misses           %14.0f", double(counts.branchMisses))
+		+ Format("%10.2f%% of branches\n", 100. * counts.BranchMissRate());
+
+	// The spread over the tiles of the last pass shows where the image is
+	// expensive to render.
+	if(!statistics.hardwarePerTile.empty())
+	{
+		double lowest = statistics.hardwarePerTile.front().counts.InstructionsPerCycle();
+		double highest = lowest;
+
+		for(TileHardwareCounts const &tile: statistics.hardwarePerTile)
+		{
+			lowest = std::min(lowest, tile.counts.InstructionsPerCycle());
+			highest = std::max(highest, tile.counts.InstructionsPerCycle());
+		}
+
+		report += "  tile IPC of the last pass from "
+			+ Format("%.2f", lowest) + " to " + Format("%.2f", highest)
+			+ " over " + std::to_string(statistics.hardwarePerTile.size())
+			+ " tiles\n";
+	}
+
+	if(!statistics.hardwareCountersError.empty())
+		report += "  some workers didn't count: " + statistics.hardwareCountersError + "\n";
+
+	return report;
+}
+
+RenderStatistics::RenderStatistics()
+#ifdef LIBRAY_STATISTICS
+: enabled(true)
+#else
+: enabled(false)
+#endif
+, seconds(0.)
+, rays()
+, boxTests(0)
+, triangleTests(0)
+, analyticTests(0)
+, textureSamples(0)
+, shaderInvocations()
+, hardware()
+, hardwarePerPass()
+, hardwarePerTile()
+, hardwareCountersError()
+{
+}
+
+std::uint64_t RenderStatistics::RayCount() const
+{
+	std::uint64_t count = 0;
+	for(std::uint64_t const typeCount: rays)
+		count += typeCount;
+
+	return count;
+}
+
+double RenderStatistics::MegaraysPerSecond(RayType type) const
+{
+	return Rate(rays[std::size_t(type)], seconds) / 1e6;
+}
+
+double RenderStatistics::MegaraysPerSecond() const
+{
+	return Rate(RayCount(), seconds) / 1e6;
+}
+
+std::string RenderStatistics::Report() const
+{
+	if(!enabled)
+	{
+		return "Statistics weren't compiled in, define LIBRAY_STATISTICS\n"
+			+ HardwareReport(*this);
+	}
+
+	auto const line = [this](std::string const &name, std::uint64_t count)
+	{
+		std::string text = "  " + name;
+		text.resize(std::max(text.size(), std::size_t(26)), ' ');
+
+		return text
+			+ Format("%14.0f", double(count))
+			+ Format("%10.2f M/s\n", Rate(count, seconds) / 1e6);
+	};
+
+	std::string report =
+		"Traced " + std::to_string(RayCount()) + " rays in "
+		+ Format("%.2fs", seconds) + ", "
+		+ Format("%.2f Mrays/s\n", MegaraysPerSecond());
+
+	for(std::size_t type = 0; type < rayTypeCount; ++type)
+		report += line(std::string(RayTypeName(RayType(type))) + " rays", rays[type]);
+
+	report += line("box tests", boxTests);
+	report += line("triangle tests", triangleTests);
+	report += line("analytic shape tests", analyticTests);
+	report += line("texture samples", textureSamples);
+
+	for(auto const &[name, count]: shaderInvocations)
+		report += line(name + " shader", count);
+
+	return report + HardwareReport(*this);
+}
+
+std::string RenderStatistics::ToJSON() const
+{
+	auto const object = [](std::map<std::string, std::string> const &members)
+	{
+		std::string json = "{";
+		for(auto const &[name, value]: members)
+		{
+			if(json.size() > 1)
+				json += ", ";
+
+			json += "\"" + name + "\": " + value;
+		}
+
+		return json + "}";
+	};
+
+	std::map<std::string, std::string> rayCounts;
+	std::map<std::string, std::string> rayRates;
+
+	for(std::size_t type = 0; type < rayTypeCount; ++type)
+	{
+		char const *const name = RayTypeName(RayType(type));
+
+		rayCounts[name] = std::to_string(rays[type]);
+		rayRates[name] = Format("%.6g", MegaraysPerSecond(RayType(type)));
+	}
+
+	rayCounts["total"] = std::to_string(RayCount());
+	rayRates["total"] = Format("%.6g", MegaraysPerSecond());
+
+	std::map<std::string, std::string> shaders;
+	for(auto const &[name, count]: shaderInvocations)
+		shaders[name] = std::to_string(count);
+
+	std::string passes = "[";
+	for(HardwareCounts const &pass: hardwarePerPass)
+		passes += (passes.size() > 1 ? ", " : "") + HardwareJSON(pass);
+
+	std::string tiles = "[";
+	for(TileHardwareCounts const &tile: hardwarePerTile)
+	{
+		tiles += (tiles.size() > 1 ? ", " : "") + object({
+			{"x", std::to_string(tile.tile.x)},
+			{"y", std::to_string(tile.tile.y)},
+			{"width", std::to_string(tile.tile.width)},
+			{"height", std::to_string(tile.tile.height)},
+			{"counts", HardwareJSON(tile.counts)}});
+	}
+
+	// Errors are made of strerror and fixed text, without quotes.
+	std::string const hardwareCounters = object({
+		{"counted", hardwarePerPass.empty() ? "false" : "true"},
+		{"error", "\"" + hardwareCountersError + "\""},
+		{"total", HardwareJSON(hardware)},
+		{"passes", passes + "]"},
+		{"lastPassTiles", tiles + "]"}});
+
+	return object({
+		{"enabled", enabled ? "true" : "false"},
+		{"seconds", Format("%.6g", seconds)},
+		{"rays", object(rayCounts)},
+		{"megaraysPerSecond", object(rayRates)},
+		{"boxTests", std::to_string(boxTests)},
+		{"triangleTests", std::to_string(triangleTests)},
+		{"analyticTests", std::to_string(analyticTests)},
+		{"textureSamples", std::to_string(textureSamples)},
+		{"shaderInvocations", object(shaders)},
+		{"hardwareCounters", hardwareCounters}});
+}
+
+namespace Instrumentation
+{
+void FlushThreadCounters([[maybe_unused]] RenderStatistics &statistics)
+{
+#ifdef LIBRAY_STATISTICS
+	ThreadCounters &counters = threadCounters;
+
+	for(std::size_t type = 0; type < rayTypeCount; ++type)
+		statistics.rays[type] += counters.rays[type];
+
+	statistics.boxTests += counters.boxTests;
+	statistics.triangleTests += counters.triangleTests;
+	statistics.analyticTests += counters.analyticTests;
+	statistics.textureSamples += counters.textureSamples;
+
+	for(std::size_t i = 0; i < maxShaders && counters.shaders[i]; ++i)
+	{
+		statistics.shaderInvocations[counters.shaders[i]->Name()] +=
+			counters.shaderInvocations[i];
+	}
+
+	if(counters.otherShaderInvocations > 0)
+		statistics.shaderInvocations["other"] += counters.otherShaderInvocations;
+
+	counters = ThreadCounters();
+#endif
+}
+} // namespace Instrumentation
+} // namespace LibRay
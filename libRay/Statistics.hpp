@@ -0,0 +1,173 @@
+#ifndef ffeb47ef_0637_4a3c_b8f0_2068fb4bb757
+#define ffeb47ef_0637_4a3c_b8f0_2068fb4bb757
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "API.hpp"
+#include "HardwareCounters.hpp"
+#include "PixelCost.hpp"
+#include "Utilites.hpp"
+
+namespace LibRay
+{
+class Shader;
+
+// What rendering took, summed over the threads. Only counted when libRay is
+// built with LIBRAY_STATISTICS defined, as counting costs a few percent.
+struct LIBRAY_API RenderStatistics final
+{
+	RenderStatistics();
+
+	std::uint64_t RayCount() const;
+
+	// Millions of rays of type, or of every type, per second of tracing.
+	double MegaraysPerSecond(RayType type) const;
+	double MegaraysPerSecond() const;
+
+	// One category per line.
+	std::string Report() const;
+
+	// A JSON object with the counts, and the rays per second per type.
+	std::string ToJSON() const;
+
+	// Whether libRay was built to count, the counts stay 0 otherwise.
+	bool enabled;
+
+	// Wall clock time spent tracing, from the start to the end of every pass.
+	double seconds;
+
+	// Indexed by RayType.
+	std::array<std::uint64_t, rayTypeCount> rays;
+
+	std::uint64_t boxTests;
+	std::uint64_t triangleTests;
+
+	// Spheres, boxes, planes, and the other shapes tested with a formula.
+	std::uint64_t analyticTests;
+
+	std::uint64_t textureSamples;
+
+	// Keyed by Shader::Name.
+	std::map<std::string, std::uint64_t> shaderInvocations;
+
+	// Counted with RayTracerConfiguration::hardwareCounters, whether or not
+	// libRay is built with LIBRAY_STATISTICS.
+	HardwareCounts hardware;
+
+	// Every pass traced, a frame is a single pass unless it's rendered
+	// progressively or in batches.
+	std::vector<HardwareCounts> hardwarePerPass;
+
+	// Every tile of the last pass.
+	std::vector<TileHardwareCounts> hardwarePerTile;
+
+	// Why some worker couldn't count, empty when all could. The counts only
+	// cover the workers that could.
+	std::string hardwareCountersError;
+};
+
+static_assert(std::is_copy_constructible_v<RenderStatistics>);
+static_assert(std::is_copy_assignable_v<RenderStatistics>);
+static_assert(!std::is_trivially_copyable_v<RenderStatistics>);
+
+static_assert(std::is_move_constructible_v<RenderStatistics>);
+static_assert(std::is_move_assignable_v<RenderStatistics>);
+
+namespace Instrumentation
+{
+#ifdef LIBRAY_STATISTICS
+constexpr bool const enabled = true;
+#else
+constexpr bool const enabled = false;
+#endif
+
+#ifdef LIBRAY_STATISTICS
+// Distinct shaders a thread counts between flushes, the rest count as other.
+constexpr std::size_t const maxShaders = 16;
+
+// The counts of one thread since it last flushed them, aligned to a cache line
+// so the counters of two threads never share one.
+struct alignas(64) ThreadCounters
+{
+	std::array<std::uint64_t, rayTypeCount> rays;
+	std::uint64_t boxTests;
+	std::uint64_t triangleTests;
+	std::uint64_t analyticTests;
+	std::uint64_t textureSamples;
+
+	std::array<Observer<Shader const>, maxShaders> shaders;
+	std::array<std::uint64_t, maxShaders> shaderInvocations;
+	std::uint64_t otherShaderInvocations;
+};
+
+static_assert(std::is_trivially_copyable_v<ThreadCounters>);
+
+inline thread_local ThreadCounters threadCounters{};
+#endif // LIBRAY_STATISTICS
+
+inline void CountRay([[maybe_unused]] RayType type)
+{
+#ifdef LIBRAY_STATISTICS
+	++threadCounters.rays[std::size_t(type)];
+#endif
+}
+
+inline void CountBoxTests([[maybe_unused]] std::uint64_t count)
+{
+#ifdef LIBRAY_STATISTICS
+	threadCounters.boxTests += count;
+#endif
+}
+
+inline void CountTriangleTest()
+{
+#ifdef LIBRAY_STATISTICS
+	++threadCounters.triangleTests;
+#endif
+}
+
+inline void CountAnalyticTest()
+{
+#ifdef LIBRAY_STATISTICS
+	++threadCounters.analyticTests;
+#endif
+}
+
+inline void CountTextureSample()
+{
+#ifdef LIBRAY_STATISTICS
+	++threadCounters.textureSamples;
+#endif
+}
+
+inline void CountShaderInvocation([[maybe_unused]] Shader const &shader)
+{
+#ifdef LIBRAY_STATISTICS
+	ThreadCounters &counters = threadCounters;
+
+	for(std::size_t i = 0; i < maxShaders; ++i)
+	{
+		if(counters.shaders[i] == &shader || !counters.shaders[i])
+		{
+			counters.shaders[i] = &shader;
+			++counters.shaderInvocations[i];
+			return;
+		}
+	}
+
+	++counters.otherShaderInvocations;
+#endif
+}
+
+// Adds the counts of the calling thread to statistics, and starts them over.
+LIBRAY_API void FlushThreadCounters(RenderStatistics &statistics);
+} // namespace Instrumentation
+} // namespace LibRay
+
+#endif // ffeb47ef_0637_4a3c_b8f0_2068fb4bb757
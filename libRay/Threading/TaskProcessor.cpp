@@ -2,66 +2,347 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <string>
 #include <thread>
 
+#include "../HardwareCounters.hpp"
+#include "../Timeline.hpp"
+#include "../Utilites.hpp"
+
 namespace LibRay
 {
 namespace Threading
 {
-TaskProcessor::TaskProcessor(std::size_t threadCount)
-: threadCount(threadCount)
-, nextTask(0)
-#ifdef DEBUG
-, ready(false)
-#endif
-, tasks()
+// The processor and queue index of the worker running on this thread.
+static thread_local Observer<TaskProcessor> currentProcessor = nullptr;
+static thread_local std::size_t currentWorker = 0;
+// The batch of the task running on this thread, which spawned tasks join.
+static thread_local Observer<void> currentBatch = nullptr;
+
+TaskProcessor::TaskProcessor(std::size_t threadCount, ThreadPlacement placement)
+: threadCount(std::max<std::size_t>(threadCount, 1))
+, workerProcessors()
+, pinWorkers(false)
+, queuedTasks(0)
+, idleWorkers(0)
+, stateMutex()
+, wakeCondition()
+, doneCondition()
+, stopping(false)
+, queues(std::make_unique<WorkerQueue[]>(this->threadCount))
+, threads()
 {
+	workerProcessors.reserve(this->threadCount);
+
+	if(placement == ThreadPlacement::Topology)
+	{
+		Topology const topology = Topology::Detect();
+		std::vector<LogicalProcessor> const order = topology.PlacementOrder();
+
+		pinWorkers = topology.IsKnown();
+
+		// More workers than processors share them round robin.
+		for(std::size_t i = 0; i < this->threadCount; ++i)
+			workerProcessors.push_back(order[i % order.size()]);
+	}
+	else
+	{
+		for(std::size_t i = 0; i < this->threadCount; ++i)
+			workerProcessors.push_back({std::uint32_t(i), 0, std::uint32_t(i), 0, 0});
+	}
+
+	threads.reserve(this->threadCount);
+
+	for(std::size_t i = 0; i < this->threadCount; ++i)
+	{
+		threads.emplace_back([this, i]() { Work(i); });
+	}
 }
 
-void TaskProcessor::AddTask(std::function<void()> func)
+TaskProcessor::~TaskProcessor() noexcept
 {
-	tasks.push_back(std::move(func));
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = true;
+	}
+
+	wakeCondition.notify_all();
+
+	for(std::thread &thread: threads)
+	{
+		if(thread.joinable())
+			thread.join();
+	}
 }
 
-void TaskProcessor::Run()
+std::size_t TaskProcessor::ThreadCount() const
 {
-	auto const taskProcessor =
-		[this]()
+	return threadCount;
+}
+
+bool TaskProcessor::PinsWorkers() const
+{
+	return pinWorkers;
+}
+
+void TaskProcessor::Run(std::vector<Task> const &tasks)
+{
+	Execute(
+		tasks.size(),
+		[&tasks](std::size_t index)
 		{
-#ifdef DEBUG
-			while(!ready.load(std::memory_order_relaxed))
-				std::this_thread::yield();
-#endif
+			return tasks[index];
+		});
+}
 
-			while(true)
-			{
-				size_t next = nextTask.fetch_add(1, std::memory_order_relaxed);
-				if(next < tasks.size())
-					tasks[next]();
-				else
-					break;
-			}
-		};
-
-	std::vector<std::thread> threads;
-	threads.reserve(std::min(threadCount, tasks.size()));
-
-	for(std::size_t i = 0; i < threadCount && i < tasks.size(); ++i)
+void TaskProcessor::RunIndexed(
+	std::size_t count,
+	Task::Function function,
+	Observer<void> context)
+{
+	Execute(
+		count,
+		[function, context](std::size_t index)
+		{
+			return Task{function, context, {index, 0, 0, 0}};
+		});
+}
+
+template<typename MakeTask>
+void TaskProcessor::Execute(std::size_t count, MakeTask const &makeTask)
+{
+	if(count == 0)
+		return;
+
+	bool const nested = currentProcessor == this;
+
+	Batch batch{count, nested};
+
+	// Every worker gets a contiguous block, its queue is locked once for it.
+	std::size_t begin = 0;
+	for(std::size_t worker = 0; worker < threadCount; ++worker)
 	{
-		threads.emplace_back(taskProcessor);
+		std::size_t const end = (worker + 1) * count / threadCount;
+		if(begin == end)
+			continue;
+
+		// Counted before they can be taken, so the count never drops below 0.
+		queuedTasks.fetch_add(end - begin);
+
+		WorkerQueue &queue = queues[worker];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for(std::size_t i = begin; i < end; ++i)
+			queue.tasks.push_back({makeTask(i), &batch});
+
+		begin = end;
 	}
 
-#ifdef DEBUG
-	ready.store(true, std::memory_order_relaxed);
-#endif
+	WakeWorkers(true);
 
-	for(std::thread &thread: threads)
+	// A worker waiting idle could deadlock the pool, when every worker waits
+	// for tasks only workers can run.
+	if(nested)
 	{
-		if(thread.joinable())
-			thread.join();
+		WorkUntil(currentWorker, &batch);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(stateMutex);
+
+	doneCondition.wait(
+		lock,
+		[&batch]()
+		{
+			return batch.pendingTasks.load(std::memory_order_acquire) == 0;
+		});
+}
+
+void TaskProcessor::Spawn(Task const &task)
+{
+	assert(currentProcessor == this && currentBatch);
+
+	Observer<Batch> const batch = static_cast<Observer<Batch>>(currentBatch);
+
+	// The spawning task still runs, so the batch can't be done yet.
+	batch->pendingTasks.fetch_add(1, std::memory_order_relaxed);
+	queuedTasks.fetch_add(1);
+
+	{
+		WorkerQueue &queue = queues[currentWorker];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back({task, batch});
+	}
+
+	WakeWorkers(false);
+}
+
+bool TaskProcessor::HasIdleWorkers() const
+{
+	return idleWorkers.load(std::memory_order_relaxed) > 0
+		&& queuedTasks.load(std::memory_order_relaxed) == 0;
+}
+
+void TaskProcessor::WakeWorkers(bool all)
+{
+	// Workers count themselves idle before checking for queued tasks, and the
+	// tasks are counted before this, so either the worker sees the tasks or
+	// this sees the worker.
+	if(idleWorkers.load() == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(stateMutex);
+
+	if(all)
+		wakeCondition.notify_all();
+	else
+		wakeCondition.notify_one();
+}
+
+bool TaskProcessor::PopTask(std::size_t worker, QueuedTask &task)
+{
+	WorkerQueue &queue = queues[worker];
+
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if(queue.tasks.empty())
+		return false;
+
+	task = queue.tasks.front();
+	queue.tasks.pop_front();
+
+	queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+	return true;
+}
+
+bool TaskProcessor::StealTask(std::size_t thief, QueuedTask &task)
+{
+	std::uint32_t const thiefNode = workerProcessors[thief].node;
+
+	// Try the workers on the same node first, their tiles are close by.
+	for(bool const remote: {false, true})
+	{
+		for(std::size_t i = 1; i < threadCount; ++i)
+		{
+			std::size_t const victim = (thief + i) % threadCount;
+			if((workerProcessors[victim].node != thiefNode) != remote)
+				continue;
+
+			WorkerQueue &queue = queues[victim];
+
+			// Don't wait for the owner or other thieves, there are more queues.
+			std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+
+			if(!lock.owns_lock() || queue.tasks.empty())
+				continue;
+
+			// Take the work furthest away from what the owner is working on.
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+
+			queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TaskProcessor::Work(std::size_t worker)
+{
+	// Pin before touching any memory, so the worker's stack and the scratch
+	// memory it allocates are placed on its own node.
+	if(pinWorkers && !Topology::PinCurrentThread(workerProcessors[worker].id))
+	{
+		std::fprintf(
+			stderr,
+			"Failed to pin worker %zu to processor %u\n",
+			worker,
+			workerProcessors[worker].id);
 	}
 
-	tasks.clear();
+	currentProcessor = this;
+	currentWorker = worker;
+
+	Timeline::NameThread("Worker " + std::to_string(worker));
+
+	WorkUntil(worker, nullptr);
+
+	Instrumentation::CloseHardwareCounters();
+
+	currentProcessor = nullptr;
+}
+
+void TaskProcessor::WorkUntil(std::size_t worker, Observer<Batch const> batch)
+{
+	auto const batchDone = [batch]()
+	{
+		return batch && batch->pendingTasks.load(std::memory_order_acquire) == 0;
+	};
+
+	QueuedTask task;
+
+	while(!batchDone())
+	{
+		if(PopTask(worker, task) || StealTask(worker, task))
+		{
+			RunTask(task);
+			continue;
+		}
+
+		// The queued tasks are in queues other workers have locked.
+		if(queuedTasks.load() > 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Sleep until a task is queued, or the batch is done.
+		std::unique_lock<std::mutex> lock(stateMutex);
+
+		idleWorkers.fetch_add(1);
+
+		wakeCondition.wait(
+			lock,
+			[this, &batchDone]()
+			{
+				return stopping || queuedTasks.load() > 0 || batchDone();
+			});
+
+		idleWorkers.fetch_sub(1);
+
+		if(stopping && !batch)
+			break;
+	}
+}
+
+void TaskProcessor::RunTask(QueuedTask const &task)
+{
+	Observer<void> const outerBatch = currentBatch;
+	currentBatch = task.batch;
+
+	task.task.function(task.task.context, task.task.arguments);
+
+	currentBatch = outerBatch;
+
+	// The waiter may return and destroy the batch as soon as the count is 0.
+	bool const waiterIsWorker = task.batch->waiterIsWorker;
+
+	if(task.batch->pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// Taking the lock makes sure the waiter is either waiting or has not
+		// checked the count yet, so the notification is not lost.
+		std::lock_guard<std::mutex> lock(stateMutex);
+
+		if(waiterIsWorker)
+			wakeCondition.notify_all();
+		else
+			doneCondition.notify_all();
+	}
 }
 } // namespace Threading
 } // namespace LibRay
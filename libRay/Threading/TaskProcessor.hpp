@@ -1,37 +1,150 @@
 #ifndef ce567da0_3c8f_fa60_64ba_d496c09d6b21
 #define ce567da0_3c8f_fa60_64ba_d496c09d6b21
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
+#include "../API.hpp"
+#include "../Utilites.hpp"
+#include "Topology.hpp"
+
 namespace LibRay
 {
 namespace Threading
 {
-class TaskProcessor final
+// A plain function with a context pointer and a few arguments, so queueing
+// work never allocates.
+struct LIBRAY_API Task final
+{
+	using Arguments = std::array<std::size_t, 4>;
+	using Function = void (*)(Observer<void> context, Arguments const &arguments);
+
+	Function function;
+	Observer<void> context;
+	Arguments arguments;
+};
+
+static_assert(std::is_copy_constructible_v<Task>);
+static_assert(std::is_copy_assignable_v<Task>);
+static_assert(std::is_trivially_copyable_v<Task>);
+
+static_assert(std::is_move_constructible_v<Task>);
+static_assert(std::is_move_assignable_v<Task>);
+
+// A persistent pool of worker threads, which sleep while there is no work.
+// Every worker has its own task queue, which it works through from the front.
+// Workers that run out of work steal from the back of the queues of others,
+// trying workers on the same NUMA node first, and skipping queues that are
+// locked. Once nothing is queued anywhere they sleep until a task is.
+class LIBRAY_API TaskProcessor final
 {
 public:
-	TaskProcessor(std::size_t threadCount);
+	TaskProcessor(
+		std::size_t threadCount,
+		ThreadPlacement placement = ThreadPlacement::Default);
+	~TaskProcessor() noexcept;
+
+	std::size_t ThreadCount() const;
+
+	// Whether every worker is pinned to a processor, which keeps the memory it
+	// touches first on its node.
+	bool PinsWorkers() const;
+
+	// Runs the tasks, and any tasks they spawn, and waits until they are done.
+	// Tasks are handed to the workers in contiguous blocks, so tasks that are
+	// close together in the list stay on one worker. Batches from different
+	// threads run at the same time, each caller waits for its own. Called
+	// from a task, the worker runs queued tasks while it waits.
+	void Run(std::vector<Task> const &tasks);
+
+	// Like Run, with the tasks {function, context, {index, 0, 0, 0}} for every
+	// index in [0, count), without building a list of them.
+	void RunIndexed(std::size_t count, Task::Function function, Observer<void> context);
+
+	// Calls function(index) for every index in [0, count) on the workers.
+	template<typename Function>
+	void ParallelFor(std::size_t count, Function const &function);
+
+	// Adds a task to the queue of the calling worker, the Run it is part of
+	// waits for it too. Must be called from a task.
+	void Spawn(Task const &task);
 
-	void AddTask(std::function<void()> func);
+	// Whether any worker is asleep with nothing left to steal, this is a hint
+	// for running tasks to split off part of their work using Spawn.
+	bool HasIdleWorkers() const;
 
-	void Run();
+private:
+	// The tasks queued by one call of Run, and the ones they spawned.
+	struct Batch
+	{
+		std::atomic_size_t pendingTasks;
+		// A worker waiting for the batch sleeps on the wake condition, so it
+		// also wakes for tasks it can run meanwhile.
+		bool waiterIsWorker;
+	};
+
+	struct QueuedTask
+	{
+		Task task;
+		Observer<Batch> batch;
+	};
+
+	struct alignas(64) WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<QueuedTask> tasks;
+	};
+
+	template<typename Function>
+	static void InvokeIndexed(
+		Observer<void> context,
+		Task::Arguments const &arguments);
+
+	// Queues makeTask(index) for every index in [0, count), and waits until
+	// they are done.
+	template<typename MakeTask>
+	void Execute(std::size_t count, MakeTask const &makeTask);
+
+	bool PopTask(std::size_t worker, QueuedTask &task);
+	bool StealTask(std::size_t thief, QueuedTask &task);
+	void RunTask(QueuedTask const &task);
+
+	// Wakes a sleeping worker, or all of them, after queueing tasks.
+	void WakeWorkers(bool all);
+
+	void Work(std::size_t worker);
+
+	// Runs tasks until batch is done, or without a batch until stopping.
+	void WorkUntil(std::size_t worker, Observer<Batch const> batch);
 
 private:
 	std::size_t threadCount;
 
-	std::atomic_size_t nextTask;
+	// Where every worker runs, all on node 0 without a placement.
+	std::vector<LogicalProcessor> workerProcessors;
+	bool pinWorkers;
 
-#ifdef DEBUG
-	std::atomic_bool ready;
-#endif
+	// Tasks in the queues that no worker took yet.
+	std::atomic_size_t queuedTasks;
+	// Workers sleeping until a task is queued.
+	std::atomic_size_t idleWorkers;
 
-	std::vector<std::function<void()>> tasks;
+	std::mutex stateMutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+	bool stopping;
+
+	std::unique_ptr<WorkerQueue[]> queues;
+	std::vector<std::thread> threads;
 };
 
 static_assert(!std::is_copy_constructible_v<TaskProcessor>);
@@ -43,4 +156,8 @@ static_assert(!std::is_move_assignable_v<TaskProcessor>);
 } // namespace Threading
 } // namespace LibRay
 
+#if !defined(VIM_WORKAROUND)
+#include "TaskProcessor_impl.hpp"
+#endif
+
 #endif // ce567da0_3c8f_fa60_64ba_d496c09d6b21
@@ -0,0 +1,29 @@
+#ifndef ab711b81_a429_4fd8_9731_98f11afe640c
+#define ab711b81_a429_4fd8_9731_98f11afe640c
+
+#ifdef VIM_WORKAROUND
+#include "TaskProcessor.hpp"
+#endif
+
+namespace LibRay::Threading
+{
+template<typename Function>
+void TaskProcessor::ParallelFor(std::size_t count, Function const &function)
+{
+	RunIndexed(
+		count,
+		&TaskProcessor::InvokeIndexed<Function>,
+		const_cast<Observer<Function>>(&function));
+}
+
+template<typename Function>
+void TaskProcessor::InvokeIndexed(
+	Observer<void> context,
+	Task::Arguments const &arguments)
+{
+	Function const &function = *static_cast<Observer<Function const>>(context);
+	function(arguments[0]);
+}
+} // namespace LibRay::Threading
+
+#endif // ab711b81_a429_4fd8_9731_98f11afe640c
@@ -0,0 +1,114 @@
+#include "Tile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace LibRay::Threading
+{
+using namespace Math;
+
+static std::size_t HilbertIndex(std::size_t size, std::size_t x, std::size_t y)
+{
+	std::size_t index = 0;
+
+	for(std::size_t s = size / 2; s > 0; s /= 2)
+	{
+		std::size_t const rx = (x & s) > 0 ? 1 : 0;
+		std::size_t const ry = (y & s) > 0 ? 1 : 0;
+
+		index += s * s * ((3 * rx) ^ ry);
+
+		// Rotate the quadrant so the curve stays continuous.
+		if(ry == 0)
+		{
+			if(rx == 1)
+			{
+				x = size - 1 - x;
+				y = size - 1 - y;
+			}
+
+			std::swap(x, y);
+		}
+	}
+
+	return index;
+}
+
+std::vector<Tile> MakeTiles(
+	Vector2st const &imageSize,
+	std::size_t tileSize,
+	TileOrder order)
+{
+	tileSize = std::max<std::size_t>(tileSize, 1);
+
+	std::size_t const xCount = (imageSize.x + tileSize - 1) / tileSize;
+	std::size_t const yCount = (imageSize.y + tileSize - 1) / tileSize;
+
+	std::vector<Tile> tiles;
+	tiles.reserve(xCount * yCount);
+
+	for(std::size_t i = 0; i < yCount; ++i)
+	{
+		for(std::size_t j = 0; j < xCount; ++j)
+		{
+			std::size_t const x = j * tileSize;
+			std::size_t const y = i * tileSize;
+
+			tiles.push_back(
+				{
+					x,
+					y,
+					std::min(tileSize, imageSize.x - x),
+					std::min(tileSize, imageSize.y - y)
+				});
+		}
+	}
+
+	switch(order)
+	{
+	case TileOrder::Scanline:
+		break;
+	case TileOrder::Hilbert:
+	{
+		std::size_t curveSize = 1;
+		while(curveSize < xCount || curveSize < yCount)
+			curveSize *= 2;
+
+		std::stable_sort(
+			tiles.begin(),
+			tiles.end(),
+			[curveSize, tileSize](Tile const &a, Tile const &b)
+			{
+				return HilbertIndex(curveSize, a.x / tileSize, a.y / tileSize)
+					< HilbertIndex(curveSize, b.x / tileSize, b.y / tileSize);
+			});
+	} break;
+	case TileOrder::Spiral:
+	{
+		float const centerX = float(xCount) * 0.5f;
+		float const centerY = float(yCount) * 0.5f;
+
+		auto const polar = [centerX, centerY, tileSize](Tile const &tile)
+		{
+			float const dx = float(tile.x / tileSize) + 0.5f - centerX;
+			float const dy = float(tile.y / tileSize) + 0.5f - centerY;
+
+			float const ring = std::round(std::max(std::abs(dx), std::abs(dy)));
+
+			return std::make_pair(ring, std::atan2(dy, dx));
+		};
+
+		std::stable_sort(
+			tiles.begin(),
+			tiles.end(),
+			[&polar](Tile const &a, Tile const &b)
+			{
+				return polar(a) < polar(b);
+			});
+	} break;
+	}
+
+	return tiles;
+}
+} // namespace LibRay::Threading
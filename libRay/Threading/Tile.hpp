@@ -0,0 +1,44 @@
+#ifndef d26c2371_5bd1_4088_9d63_7089707fc27f
+#define d26c2371_5bd1_4088_9d63_7089707fc27f
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "../Math/Vector.hpp"
+#include "../API.hpp"
+
+namespace LibRay::Threading
+{
+enum class TileOrder
+{
+	// Row by row, from the top left.
+	Scanline,
+	// Along a Hilbert curve, neighbouring tiles are rendered close in time.
+	Hilbert,
+	// Outwards from the center of the image, usually the most interesting.
+	Spiral
+};
+
+struct LIBRAY_API Tile final
+{
+	std::size_t x, y;
+	std::size_t width, height;
+};
+
+static_assert(std::is_copy_constructible_v<Tile>);
+static_assert(std::is_copy_assignable_v<Tile>);
+static_assert(std::is_trivially_copyable_v<Tile>);
+
+static_assert(std::is_move_constructible_v<Tile>);
+static_assert(std::is_move_assignable_v<Tile>);
+
+// Cuts the image in square tiles of tileSize, the tiles on the right and
+// bottom edges are smaller if the image size isn't a multiple of tileSize.
+LIBRAY_API std::vector<Tile> MakeTiles(
+	Math::Vector2st const &imageSize,
+	std::size_t tileSize,
+	TileOrder order);
+} // namespace LibRay::Threading
+
+#endif // d26c2371_5bd1_4088_9d63_7089707fc27f
@@ -0,0 +1,246 @@
+#include "Topology.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace LibRay::Threading
+{
+#ifdef __linux__
+static bool ReadLine(std::string const &path, std::string &line)
+{
+	std::FILE *file = std::fopen(path.c_str(), "r");
+	if(!file)
+		return false;
+
+	char buffer[4096];
+	bool const success = std::fgets(buffer, sizeof(buffer), file) != nullptr;
+	std::fclose(file);
+
+	if(success)
+	{
+		line = buffer;
+		while(!line.empty() && (line.back() == '\n' || line.back() == ' '))
+			line.pop_back();
+	}
+
+	return success;
+}
+
+static bool ReadNumber(std::string const &path, std::uint32_t &number)
+{
+	std::string line;
+	if(!ReadLine(path, line) || line.empty())
+		return false;
+
+	number = std::uint32_t(std::stoul(line));
+	return true;
+}
+
+// Parses lists like "0-3,8,10-11".
+static std::vector<std::uint32_t> ParseList(std::string const &list)
+{
+	std::vector<std::uint32_t> values;
+
+	std::size_t start = 0;
+	while(start < list.size())
+	{
+		std::size_t end = list.find(',', start);
+		if(end == std::string::npos)
+			end = list.size();
+
+		std::string const range = list.substr(start, end - start);
+		std::size_t const dash = range.find('-');
+
+		if(!range.empty())
+		{
+			std::uint32_t const first = std::uint32_t(std::stoul(range));
+			std::uint32_t const last = dash == std::string::npos
+				? first
+				: std::uint32_t(std::stoul(range.substr(dash + 1)));
+
+			for(std::uint32_t i = first; i <= last; ++i)
+				values.push_back(i);
+		}
+
+		start = end + 1;
+	}
+
+	return values;
+}
+
+static std::vector<LogicalProcessor> ReadProcessors()
+{
+	std::vector<LogicalProcessor> processors;
+
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return processors;
+
+	std::string const cpuPath = "/sys/devices/system/cpu/cpu";
+
+	for(std::size_t i = 0; i < std::size_t(CPU_SETSIZE); ++i)
+	{
+		if(!CPU_ISSET(i, &allowed))
+			continue;
+
+		std::string const topologyPath = cpuPath + std::to_string(i) + "/topology/";
+
+		LogicalProcessor processor = {std::uint32_t(i), 0, std::uint32_t(i), 0, 0};
+		if(!ReadNumber(topologyPath + "physical_package_id", processor.package)
+			|| !ReadNumber(topologyPath + "core_id", processor.core))
+		{
+			return {};
+		}
+
+		processors.push_back(processor);
+	}
+
+	// Machines without NUMA support have no node directory, which leaves
+	// everything on node 0.
+	std::string nodes;
+	if(ReadLine("/sys/devices/system/node/online", nodes))
+	{
+		for(std::uint32_t node: ParseList(nodes))
+		{
+			std::string cpus;
+			std::string const nodePath =
+				"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+
+			if(!ReadLine(nodePath, cpus))
+				continue;
+
+			for(std::uint32_t id: ParseList(cpus))
+			{
+				for(LogicalProcessor &processor: processors)
+				{
+					if(processor.id == id)
+						processor.node = node;
+				}
+			}
+		}
+	}
+
+	// Number the hardware threads of every physical core.
+	std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> threadsPerCore;
+	for(LogicalProcessor &processor: processors)
+		processor.sibling = threadsPerCore[{processor.package, processor.core}]++;
+
+	return processors;
+}
+#endif
+
+Topology Topology::Detect()
+{
+#ifdef __linux__
+	try
+	{
+		std::vector<LogicalProcessor> processors = ReadProcessors();
+		if(!processors.empty())
+			return Topology(std::move(processors), true);
+	}
+	catch(std::exception const &e)
+	{
+		std::fprintf(stderr, "Failed to read the processor topology: %s\n", e.what());
+	}
+#endif
+
+	std::uint32_t const count =
+		std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<LogicalProcessor> processors;
+	processors.reserve(count);
+
+	for(std::uint32_t i = 0; i < count; ++i)
+		processors.push_back({i, 0, i, 0, 0});
+
+	return Topology(std::move(processors), false);
+}
+
+Topology::Topology(std::vector<LogicalProcessor> &&processors, bool known)
+: processors(std::move(processors))
+, known(known)
+{
+}
+
+bool Topology::IsKnown() const
+{
+	return known;
+}
+
+std::vector<LogicalProcessor> const &Topology::Processors() const
+{
+	return processors;
+}
+
+std::uint32_t Topology::NodeCount() const
+{
+	std::uint32_t count = 0;
+	for(LogicalProcessor const &processor: processors)
+		count = std::max(count, processor.node + 1);
+
+	return count;
+}
+
+std::vector<LogicalProcessor> Topology::PlacementOrder() const
+{
+	std::vector<LogicalProcessor> order = processors;
+
+	std::stable_sort(
+		order.begin(),
+		order.end(),
+		[](LogicalProcessor const &a, LogicalProcessor const &b)
+		{
+			return std::tie(a.sibling, a.node, a.package, a.core, a.id)
+				< std::tie(b.sibling, b.node, b.package, b.core, b.id);
+		});
+
+	return order;
+}
+
+bool Topology::PinCurrentThread([[maybe_unused]] std::uint32_t processor)
+{
+#ifdef __linux__
+	if(processor >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(processor, &set);
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+void Topology::DiscardPages(
+	[[maybe_unused]] void *data,
+	[[maybe_unused]] std::size_t size)
+{
+#ifdef __linux__
+	std::uintptr_t const pageSize = std::uintptr_t(sysconf(_SC_PAGESIZE));
+	std::uintptr_t const start = std::uintptr_t(data);
+
+	// Only whole pages, the partial ones at the ends are shared with other
+	// allocations.
+	std::uintptr_t const begin = (start + pageSize - 1) / pageSize * pageSize;
+	std::uintptr_t const end = (start + size) / pageSize * pageSize;
+
+	if(begin < end)
+		madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+#endif
+}
+} // namespace LibRay::Threading
@@ -0,0 +1,82 @@
+#ifndef dfdd7037_ef41_4bd1_97d0_5373e282e763
+#define dfdd7037_ef41_4bd1_97d0_5373e282e763
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "../API.hpp"
+
+namespace LibRay::Threading
+{
+enum class ThreadPlacement
+{
+	// Let the operating system schedule the workers.
+	Default,
+	// Pin every worker to its own processor, physical cores first. The pages
+	// of the framebuffer are first touched by the workers that render them.
+	// Checkpointed renders skip tiles and still clear it on one thread.
+	Topology
+};
+
+struct LIBRAY_API LogicalProcessor final
+{
+	std::uint32_t id;
+	std::uint32_t package;
+	std::uint32_t core;
+	std::uint32_t node;
+	// Index among the hardware threads of the same physical core.
+	std::uint32_t sibling;
+};
+
+static_assert(std::is_copy_constructible_v<LogicalProcessor>);
+static_assert(std::is_copy_assignable_v<LogicalProcessor>);
+static_assert(std::is_trivially_copyable_v<LogicalProcessor>);
+
+static_assert(std::is_move_constructible_v<LogicalProcessor>);
+static_assert(std::is_move_assignable_v<LogicalProcessor>);
+
+class LIBRAY_API Topology final
+{
+public:
+	// Reads the processors the process is allowed to run on from sysfs on
+	// Linux. Elsewhere every processor is treated as its own core on node 0.
+	static Topology Detect();
+
+	// Whether the layout was read from the system, rather than guessed.
+	bool IsKnown() const;
+
+	std::vector<LogicalProcessor> const &Processors() const;
+	std::uint32_t NodeCount() const;
+
+	// The order to hand processors to workers in: one hardware thread of every
+	// physical core first, grouped by node, then the remaining SMT siblings.
+	std::vector<LogicalProcessor> PlacementOrder() const;
+
+	// Restricts the calling thread to a single processor, returns false when
+	// the platform does not support it or the call failed.
+	static bool PinCurrentThread(std::uint32_t processor);
+
+	// Hands the whole pages in [data, data + size) back to the system on
+	// Linux, so they are placed on the node of the thread that writes them
+	// next. Their contents are lost. Does nothing elsewhere.
+	static void DiscardPages(void *data, std::size_t size);
+
+private:
+	Topology(std::vector<LogicalProcessor> &&processors, bool known);
+
+private:
+	std::vector<LogicalProcessor> processors;
+	bool known;
+};
+
+static_assert(std::is_copy_constructible_v<Topology>);
+static_assert(std::is_copy_assignable_v<Topology>);
+static_assert(!std::is_trivially_copyable_v<Topology>);
+
+static_assert(std::is_move_constructible_v<Topology>);
+static_assert(std::is_move_assignable_v<Topology>);
+} // namespace LibRay::Threading
+
+#endif // dfdd7037_ef41_4bd1_97d0_5373e282e763
@@ -0,0 +1,251 @@
+#include "Timeline.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Utilites.hpp"
+
+namespace LibRay::Timeline
+{
+struct Event final
+{
+	char const *name;
+	std::string detail;
+	std::int64_t start;
+	std::int64_t duration;
+};
+
+// Only the thread that owns a buffer writes to it. Buffers are linked into a
+// list when their thread first records, and are never freed, so the spans of
+// threads that have since ended are still written.
+struct ThreadBuffer final
+{
+	std::vector<Event> events;
+	std::string name;
+	std::uint32_t id = 0;
+
+	// The recording the events belong to, older ones are dropped lazily.
+	std::uint64_t session = 0;
+
+	Observer<ThreadBuffer> next = nullptr;
+};
+
+static std::atomic<Observer<ThreadBuffer>> firstBuffer(nullptr);
+static std::atomic<std::uint32_t> bufferCount(0);
+
+static std::atomic<bool> recording(false);
+static std::atomic<std::uint64_t> currentSession(0);
+
+// steady_clock nanoseconds at Start.
+static std::atomic<std::int64_t> epoch(0);
+
+static thread_local Observer<ThreadBuffer> threadBuffer = nullptr;
+
+// Kept until the thread first records, so naming threads costs nothing when
+// nothing is recorded. Longer names are cut short.
+static thread_local std::array<char, 64> threadName{};
+
+static std::int64_t Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count()
+		- epoch.load(std::memory_order_relaxed);
+}
+
+// The buffer of the calling thread, emptied when it still holds an older
+// recording.
+static ThreadBuffer &CurrentBuffer(std::uint64_t session)
+{
+	if(!threadBuffer)
+	{
+		Observer<ThreadBuffer> const buffer = new ThreadBuffer();
+		buffer->id = ++bufferCount;
+		buffer->name = threadName.data();
+
+		buffer->next = firstBuffer.load(std::memory_order_relaxed);
+		while(!firstBuffer.compare_exchange_weak(
+			buffer->next,
+			buffer,
+			std::memory_order_release,
+			std::memory_order_relaxed))
+		{
+		}
+
+		threadBuffer = buffer;
+	}
+
+	if(threadBuffer->session != session)
+	{
+		threadBuffer->events.clear();
+		threadBuffer->session = session;
+	}
+
+	return *threadBuffer;
+}
+
+static void WriteEscaped(std::FILE *file, std::string const &text)
+{
+	for(char const c: text)
+	{
+		if(c == '"' || c == '\\')
+			std::fprintf(file, "\\%c", c);
+		else if(std::uint8_t(c) < 0x20)
+			std::fprintf(file, "\\u%04x", unsigned(c));
+		else
+			std::fputc(c, file);
+	}
+}
+
+void Start()
+{
+	epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	++currentSession;
+	recording = true;
+}
+
+void Stop()
+{
+	recording = false;
+}
+
+bool IsRecording()
+{
+	return recording.load(std::memory_order_relaxed);
+}
+
+void NameThread(std::string const &name)
+{
+	std::size_t const length = std::min(name.size(), threadName.size() - 1);
+	std::copy_n(name.begin(), length, threadName.begin());
+	threadName[length] = '\0';
+
+	if(threadBuffer)
+		threadBuffer->name = name;
+}
+
+void Write(std::string const &fileName)
+{
+	std::unique_ptr<std::FILE, decltype(&std::fclose)> const file(
+		std::fopen(fileName.c_str(), "w"),
+		&std::fclose);
+
+	if(!file)
+		throw std::runtime_error("Unable to open <" + fileName + "> for writing");
+
+	std::uint64_t const session = currentSession;
+
+	std::fprintf(file.get(), "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	bool first = true;
+	auto const separate = [&]()
+	{
+		std::fprintf(file.get(), first ? "\t" : ",\n\t");
+		first = false;
+	};
+
+	for(Observer<ThreadBuffer const> buffer = firstBuffer.load(std::memory_order_acquire);
+		buffer;
+		buffer = buffer->next)
+	{
+		if(buffer->session != session)
+			continue;
+
+		separate();
+		std::fprintf(
+			file.get(),
+			"{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+			"\"args\": {\"name\": \"",
+			buffer->id);
+
+		if(buffer->name.empty())
+			std::fprintf(file.get(), "Thread %u", buffer->id);
+		else
+			WriteEscaped(file.get(), buffer->name);
+
+		std::fprintf(file.get(), "\"}}");
+
+		// Threads are sorted by their id, rather than by their name.
+		separate();
+		std::fprintf(
+			file.get(),
+			"{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, "
+			"\"tid\": %u, \"args\": {\"sort_index\": %u}}",
+			buffer->id,
+			buffer->id);
+
+		for(Event const &event: buffer->events)
+		{
+			separate();
+			std::fprintf(file.get(), "{\"name\": \"");
+			WriteEscaped(file.get(), event.name);
+			std::fprintf(
+				file.get(),
+				"\", \"cat\": \"libRay\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+				"\"ts\": %.3f, \"dur\": %.3f",
+				buffer->id,
+				double(event.start) * 1e-3,
+				double(event.duration) * 1e-3);
+
+			if(!event.detail.empty())
+			{
+				std::fprintf(file.get(), ", \"args\": {\"detail\": \"");
+				WriteEscaped(file.get(), event.detail);
+				std::fprintf(file.get(), "\"}");
+			}
+
+			std::fprintf(file.get(), "}");
+		}
+	}
+
+	std::fprintf(file.get(), "\n]}\n");
+
+	if(std::ferror(file.get()))
+		throw std::runtime_error("Failed to write <" + fileName + ">");
+}
+
+Span::Span(char const *name, std::string detail)
+: name(name)
+, detail()
+, start(-1)
+, session(0)
+{
+	if(!IsRecording())
+		return;
+
+	this->detail = std::move(detail);
+	session = currentSession.load(std::memory_order_relaxed);
+	start = Now();
+}
+
+Span::~Span() noexcept
+{
+	if(start < 0)
+		return;
+
+	std::int64_t const end = Now();
+
+	// Spans of a recording that was stopped, or started over, are dropped.
+	if(!IsRecording() || session != currentSession.load(std::memory_order_relaxed))
+		return;
+
+	try
+	{
+		CurrentBuffer(session).events.push_back(
+			{name, std::move(detail), start, end - start});
+	}
+	catch(std::bad_alloc const &)
+	{
+		// Losing a span beats losing the render.
+	}
+}
+} // namespace LibRay::Timeline
@@ -0,0 +1,72 @@
+#ifndef d8a9b53f_eee3_48e3_a9ed_24352603c7af
+#define d8a9b53f_eee3_48e3_a9ed_24352603c7af
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "API.hpp"
+
+namespace LibRay
+{
+// Records what every thread spends its time on, loading textures and models,
+// building hierarchies, and rendering tiles, as spans on a timeline that
+// chrome://tracing or Perfetto can show. Every thread records into its own
+// buffer, so recording takes no locks, and when not recording a span only
+// costs checking a flag.
+namespace Timeline
+{
+// Forgets everything recorded before, and starts recording.
+LIBRAY_API void Start();
+
+// Stops recording, spans that are still open are dropped.
+LIBRAY_API void Stop();
+
+LIBRAY_API bool IsRecording();
+
+// Names the calling thread on the timeline, threads without a name are
+// numbered in the order they first recorded something.
+LIBRAY_API void NameThread(std::string const &name);
+
+// Writes what was recorded as Chrome Trace Event JSON, throws a
+// runtime_error when the file can't be written. Must be called while no
+// other thread records, after the work being recorded is done.
+LIBRAY_API void Write(std::string const &fileName);
+
+// A span from its construction until its destruction on the calling thread.
+// name must outlive the recording, it's meant to be a string literal.
+class LIBRAY_API Span final
+{
+public:
+	explicit Span(char const *name, std::string detail = std::string());
+	~Span() noexcept;
+
+	Span(Span const &) = delete;
+	Span(Span &&) = delete;
+
+	Span &operator=(Span const &) = delete;
+	Span &operator=(Span &&) = delete;
+
+private:
+	char const *name;
+
+	// Shown with the span, like the file being loaded.
+	std::string detail;
+
+	// Nanoseconds since Start, negative when not recording.
+	std::int64_t start;
+
+	// Which recording the span belongs to.
+	std::uint64_t session;
+};
+
+static_assert(!std::is_copy_constructible_v<Span>);
+static_assert(!std::is_copy_assignable_v<Span>);
+static_assert(!std::is_trivially_copyable_v<Span>);
+
+static_assert(!std::is_move_constructible_v<Span>);
+static_assert(!std::is_move_assignable_v<Span>);
+} // namespace Timeline
+} // namespace LibRay
+
+#endif // d8a9b53f_eee3_48e3_a9ed_24352603c7af
@@ -1,5 +1,25 @@
 #include "Utilites.hpp"
 
+#include <cstring>
+
+std::vector<std::string> SplitList(std::string const &list)
+{
+	std::vector<std::string> items;
+
+	std::size_t start = 0;
+	while(start <= list.size())
+	{
+		std::size_t end = list.find(',', start);
+		if(end == std::string::npos)
+			end = list.size();
+
+		items.push_back(list.substr(start, end - start));
+		start = end + 1;
+	}
+
+	return items;
+}
+
 void Stopwatch::Start()
 {
 	end = Clock::time_point();
@@ -23,3 +43,46 @@ std::string Stopwatch::Value() const
 
 	return std::to_string(milli) + "ms";
 }
+
+double Stopwatch::Seconds() const
+{
+	return std::chrono::duration<double>(end - start).count();
+}
+
+Hasher &Hasher::Add(std::uint64_t value)
+{
+	for(int i = 0; i < 8; ++i)
+	{
+		hash ^= (value >> (8 * i)) & 0xff;
+		hash *= 0x100000001b3ull;
+	}
+
+	return *this;
+}
+
+Hasher &Hasher::Add(float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	return Add(std::uint64_t(bits));
+}
+
+Hasher &Hasher::Add(std::string const &value)
+{
+	// The length keeps "ab", "c" apart from "a", "bc".
+	Add(std::uint64_t(value.size()));
+
+	for(char const c: value)
+	{
+		hash ^= std::uint8_t(c);
+		hash *= 0x100000001b3ull;
+	}
+
+	return *this;
+}
+
+std::uint64_t Hasher::Value() const
+{
+	return hash;
+}
@@ -3,7 +3,10 @@
 
 #include <cfloat>
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "API.hpp"
 
@@ -15,6 +18,10 @@ inline bool AlmostEqual(float a, float b, float epsilon = FLT_EPSILON)
 	return difference <= epsilon && -difference <= epsilon;
 }
 
+// Splits a comma separated list, like the ones of command line options. An
+// empty list is one empty item.
+LIBRAY_API std::vector<std::string> SplitList(std::string const &list);
+
 class LIBRAY_API Stopwatch
 {
 public:
@@ -22,6 +29,7 @@ public:
 	void Stop();
 
 	std::string Value() const;
+	double Seconds() const;
 
 private:
 	using Clock = std::chrono::high_resolution_clock;
@@ -36,4 +44,26 @@ static_assert(std::is_trivially_copyable_v<Stopwatch>);
 static_assert(std::is_move_constructible_v<Stopwatch>);
 static_assert(std::is_move_assignable_v<Stopwatch>);
 
+// A 64 bit FNV-1a hash of a sequence of values, used to tell whether saved
+// render state belongs to the current scene and configuration.
+class LIBRAY_API Hasher
+{
+public:
+	Hasher &Add(std::uint64_t value);
+	Hasher &Add(float value);
+	Hasher &Add(std::string const &value);
+
+	std::uint64_t Value() const;
+
+private:
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+};
+
+static_assert(std::is_copy_constructible_v<Hasher>);
+static_assert(std::is_copy_assignable_v<Hasher>);
+static_assert(std::is_trivially_copyable_v<Hasher>);
+
+static_assert(std::is_move_constructible_v<Hasher>);
+static_assert(std::is_move_assignable_v<Hasher>);
+
 #endif // ef3e73f2_6802_a167_a402_e93a7c0ef6b2